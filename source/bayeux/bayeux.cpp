@@ -66,7 +66,7 @@ namespace bayeux
         {
             boost::shared_ptr< session > session_obj;
             const std::pair< bool, json::string > hook_result =
-                users_actions_->handshake( session_id, data_, current_config_, ext_value ? *ext_value : json::null(), session_obj );
+                users_actions_->handshake( session_id, data_, current_config_, ext_value ? ext_value->promote() : json::null(), session_obj );
 
             if ( !hook_result.first )
             {
@@ -138,7 +138,9 @@ namespace bayeux
     {
         if ( users_actions_.get() )
         {
-            return users_actions_->publish( channel, data, message, s, data_ );
+            // the request might have been parsed into an arena, that must not be kept alive by the application
+            return users_actions_->publish( channel.promote().upcast< json::string >(), data.promote(),
+                message.promote().upcast< json::object >(), s, data_ );
         }
         else
         {
@@ -1050,6 +1050,40 @@ BOOST_AUTO_TEST_CASE( single_valued_containing_a_single_bayeux_message )
             "]") );
 }
 
+/**
+ * @test encoded '&', '=' and '+' within a form/url encoded message are part of the message
+ */
+BOOST_AUTO_TEST_CASE( form_url_encoded_message_with_encoded_separators )
+{
+    bayeux::test::context context;
+
+    const std::string body = "message=" + http::url_encode( json::parse_single_quoted(
+        "{"
+        "   'clientId' : '192.168.210.1:9999/0',"
+        "   'channel'  : '/test/a',"
+        "   'data'     : 'a&b=c+d e'"
+        "}" ).to_json() );
+
+    bayeux::test::bayeux_messages( bayeux::test::bayeux_session(
+        server::test::read_plan()
+            << meta_handshake
+            << form_url_encoded_msg( body )
+            << server::test::disconnect_read(),
+        context ) );
+
+    BOOST_CHECK_EQUAL(
+        context.bayeux_adapter.publishs(),
+        json::parse_single_quoted(
+            "["
+            "   { "
+            "       'channel' : '/test/a', "
+            "       'data' : 'a&b=c+d e', "
+            "       'message' : { 'clientId' : '192.168.210.1:9999/0', 'channel' : '/test/a', 'data' : 'a&b=c+d e'}, "
+            "       'session_data' : '' "
+            "   }"
+            "]") );
+}
+
 BOOST_AUTO_TEST_CASE( single_valued_containing_an_array_of_bayeux_messages )
 {
     bayeux::test::context context;
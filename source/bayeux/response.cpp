@@ -27,15 +27,15 @@ namespace bayeux
 	        connector_.idle_session( session_ );
 	}
 
-    static const json::string id_token( "id" );
-    static const json::string client_id_token( "clientId" );
-	static const json::string channel_token( "channel" );
-	static const json::string subscription_token( "subscription" );
-	static const json::string connection_typen_token( "connectionType" );
-	static const json::string ext_field_token( "ext" );
-	static const json::string error_field_token( "error" );
-	static const json::string data_field_token( "data" );
-	static const json::string successful_field_token( "successful" );
+    static const json::string id_token = json::atom( "id" );
+    static const json::string client_id_token = json::atom( "clientId" );
+	static const json::string channel_token = json::atom( "channel" );
+	static const json::string subscription_token = json::atom( "subscription" );
+	static const json::string connection_typen_token = json::atom( "connectionType" );
+	static const json::string ext_field_token = json::atom( "ext" );
+	static const json::string error_field_token = json::atom( "error" );
+	static const json::string data_field_token = json::atom( "data" );
+	static const json::string successful_field_token = json::atom( "successful" );
 
 	static const json::string meta_handshake_channel( "/meta/handshake" );
 	static const json::string meta_connect_channel( "/meta/connect" );
@@ -181,8 +181,8 @@ namespace bayeux
 
     static bool zero_timeout_advice( const json::object& request )
     {
-        static const json::string advice_tag( "advice" );
-        static const json::string timeout_tag( "timeout" );
+        static const json::string advice_tag = json::atom( "advice" );
+        static const json::string timeout_tag = json::atom( "timeout" );
 
         const json::value* const advice_field = request.find( advice_tag );
 
@@ -230,7 +230,8 @@ namespace bayeux
 		    }
 		    else
 		    {
-                blocking_connect_ = request;
+                // the request might have been parsed into an arena, that must not be kept alive while blocking
+                blocking_connect_ = request.promote().upcast< json::object >();
 		    }
 		}
 	}
@@ -440,17 +441,15 @@ namespace bayeux
     template < class Timer >
     std::vector< boost::asio::const_buffer > response_base< Timer >::build_response( const json::array& bayeux_response )
 	{
-		static const char response_header[] =
-			"HTTP/1.1 200 OK\r\n"
-			"Content-Type: application/json\r\n"
-			"Content-Length: ";
-
-		response_buffer_ = tools::as_string( bayeux_response.size() ) + "\r\n\r\n";
+		response_head_.status( http::http_ok )
+			.date()
+			.header( http::content_type_header, "application/json" )
+			.content_length( bayeux_response.size() )
+			.finish();
 
 		std::vector< boost::asio::const_buffer > result;
 
-		result.push_back( boost::asio::buffer( response_header, sizeof response_header -1 ) );
-		result.push_back( boost::asio::buffer( response_buffer_ ) );
+		result.push_back( response_head_.buffer() );
 
 		bayeux_response.to_json( result );
 
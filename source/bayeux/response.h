@@ -14,6 +14,7 @@
 #include "http/request.h"
 #include "http/header_names.h"
 #include "http/parser.h"
+#include "http/response_head.h"
 #include "json/json.h"
 #include "server/response.h"
 #include "server/timeout.h"
@@ -66,8 +67,8 @@ namespace bayeux
 
 		// the response of the bayeux protocol layer
 		json::array							bayeux_response_;
-		// a buffer for free texts for the http response
-		std::string							response_buffer_;
+		// the head of the http response
+		http::response_head					response_head_;
 
 		// the connect request that broad this response to block on
         json::object                        blocking_connect_;
@@ -108,11 +109,11 @@ namespace bayeux
         virtual void start();
 		void body_read_handler(
 			const boost::system::error_code& error,
-			const char* buffer,
 			std::size_t bytes_read_and_decoded );
 
 		void handle_requests( const json::value& );
-		void handle_form_requests( const std::string& );
+		// decodes the messages of the form/url encoded body in place
+		void handle_form_requests( std::vector< char >& body, char* ( *decode )( const char*, const char*, char* ) );
 
         // response_interface implementation
         void second_connection_detected();
@@ -126,15 +127,21 @@ namespace bayeux
 
         void connection_time_out( const boost::system::error_code& error );
 
+        // releases the memory of the parsed messages, before the response blocks
+        void release_request_memory();
+
 		boost::shared_ptr< Connection >				            connection_;
 		const boost::shared_ptr< const http::request_header >   request_;
 
+        // request scoped memory for the parsed messages
+        json::arena                                             arena_;
+
 		// used when the message is application/json encoded
-		bool										            parsed_;
         json::parser								            message_parser_;
 
         // used when the message is application/x-www-form-urlencoded
         bool                                                    form_encoded_;
+        // the request body or the query of a GET request
         std::vector< char >                                     form_body_;
 
 		// a concatenated list of snippets that form the http response
@@ -209,8 +216,8 @@ namespace bayeux
 	  : response_base< typename Connection::trait_t::timeout_timer_type >( root )
 	  , connection_( connection )
 	  , request_( header )
-	  , parsed_( false )
-	  , message_parser_()
+	  , arena_()
+	  , message_parser_( arena_ )
 	  , form_encoded_( false )
 	  , form_body_()
 	  , response_()
@@ -235,27 +242,29 @@ namespace bayeux
         {
             form_encoded_ = request_->option_available( http::content_type_header, http::application_x_www_from_urlencded );
 
-            connection_->async_read_body( boost::bind( &response::body_read_handler, this->shared_from_this(), _1, _2, _3
-                    ) );
+            // the body is read directly into form_body_
+            connection_->async_read_body( form_body_,
+                boost::bind( &response::body_read_handler, this->shared_from_this(), _1, _2 ) );
         }
         else
         {
             tools::substring scheme, authority, path, query, fragment;
             // lets see, if the query contains a bayeux message
             http::split_url( request_->uri(), scheme, authority, path, query, fragment );
-            handle_form_requests( http::url_decode( query ) );
+
+            form_body_.assign( query.begin(), query.end() );
+            handle_form_requests( form_body_, &http::url_decode );
         }
 	}
 
 	template < class Connection >
 	void response< Connection >::body_read_handler(
 		const boost::system::error_code& error,
-		const char* buffer,
 		std::size_t bytes_read_and_decoded )
 	{
 	    server::close_connection_guard< Connection > guard( *connection_, *this );
 
-		if ( error && error != boost::asio::error::eof )
+		if ( error )
 		{
 		    connection_->trait().log_error( *connection_, "receiving bayeux request body", error, bytes_read_and_decoded );
 		    return;
@@ -263,33 +272,24 @@ namespace bayeux
 
 		if ( form_encoded_ )
 		{
-		    form_body_.insert( form_body_.end(), buffer, buffer + bytes_read_and_decoded );
-
-		    if ( bytes_read_and_decoded == 0 )
-		    {
-		        handle_form_requests(
-		            http::form_decode( tools::substring( &form_body_[ 0 ], &form_body_[ 0 ] + form_body_.size() ) ) );
-		    }
-
+	        handle_form_requests( form_body_, &http::form_decode );
 		    guard.dismiss();
 		}
 		else
 		{
-            if ( bytes_read_and_decoded == 0 && parsed_ )
+		    const char* const               begin  = form_body_.empty() ? 0 : &form_body_[ 0 ];
+		    const std::pair< bool, bool >   parsed = message_parser_.parse( begin, begin + form_body_.size() );
+
+            if ( parsed.second )
             {
                 message_parser_.flush();
                 handle_requests( message_parser_.result() );
                 guard.dismiss();
             }
-            else if ( bytes_read_and_decoded != 0 && !parsed_ )
-            {
-                parsed_ = message_parser_.parse( buffer, buffer + bytes_read_and_decoded ).second;
-                guard.dismiss();
-            }
             else
             {
                 connection_->trait().log_error( *connection_, "unexpected state while reading body:",
-                    bytes_read_and_decoded, parsed_ );
+                    bytes_read_and_decoded, parsed.first );
             }
 		}
 	}
@@ -349,24 +349,29 @@ namespace bayeux
             assert( this->session_ );
 
             log::bayeux_blocking_connect( *connection_, this->blocking_connect_, log::enabled< Connection >( connection_.get() ) );
+            release_request_memory();
+
             timer_.expires_from_now( this->session_->long_polling_timeout() );
             timer_.async_wait( boost::bind( &response::connection_time_out, this->shared_from_this(), _1 ) );
         }
 	}
 
     template < class Connection >
-    void response< Connection >::handle_form_requests( const std::string& body )
+    void response< Connection >::handle_form_requests(
+        std::vector< char >& body, char* ( *decode )( const char*, const char*, char* ) )
     {
-        const std::vector< std::pair< tools::substring, tools::substring > > messages =
-            http::split_query( tools::substring( body.c_str(), body.c_str() + body.size() ) );
+        char* const buffer = body.empty() ? 0 : &body[ 0 ];
 
         unsigned message_cnt = 0;
-        for ( std::vector< std::pair< tools::substring, tools::substring > >::const_iterator msg = messages.begin();
-            msg != messages.end(); ++msg )
+        for ( http::query_iterator msg( tools::substring( buffer, buffer + body.size() ) ), end; msg != end; ++msg )
         {
             if ( msg->first == "message" )
             {
-                handle_requests( json::parse( msg->second.begin(), msg->second.end() ) );
+                // decoding never makes the value longer, so the rest of the query stays untouched
+                char* const         value       = buffer + ( msg->second.begin() - buffer );
+                const char* const   value_end   = decode( value, msg->second.end(), value );
+
+                handle_requests( json::parse( static_cast< const char* >( value ), value_end, arena_ ) );
                 ++message_cnt;
             }
         }
@@ -417,6 +422,15 @@ namespace bayeux
         }
 	}
 
+    template < class Connection >
+    void response< Connection >::release_request_memory()
+    {
+        // the values of the parsed messages, that are still referenced by the caller, release the old arena, when
+        // they go out of scope
+        arena_          = json::arena();
+        message_parser_ = json::parser( arena_ );
+    }
+
     template < class Connection >
     void response< Connection >::connection_time_out( const boost::system::error_code& error )
     {
@@ -11,13 +11,13 @@
 
 namespace bayeux
 {
-	static const json::string channel_tag( "channel" );
-	static const json::string subscription_tag( "subscription" );
-	static const json::string client_id_tag( "clientId" );
-	static const json::string data_tag( "data" );
-	static const json::string id_tag( "id" );
-	static const json::string subscription_error_tag( "#error" );
-    static const json::string error_tag( "error" );
+	static const json::string channel_tag = json::atom( "channel" );
+	static const json::string subscription_tag = json::atom( "subscription" );
+	static const json::string client_id_tag = json::atom( "clientId" );
+	static const json::string data_tag = json::atom( "data" );
+	static const json::string id_tag = json::atom( "id" );
+	static const json::string subscription_error_tag = json::atom( "#error" );
+    static const json::string error_tag = json::atom( "error" );
 
 	session::session( const std::string& session_id, pubsub::root& data, const boost::shared_ptr< const configuration >& config )
 		: session_id_( session_id.c_str() )
@@ -84,7 +84,7 @@ namespace bayeux
         {
             boost::mutex::scoped_lock lock( subscription_mutex_ );
 
-            subscription_context  context = { id ? *id : json::null(), id != 0 };
+            subscription_context  context = { id ? id->promote() : json::null(), id != 0 };
             subscription_ids_.insert( std::make_pair( name, context ) );
         }
 
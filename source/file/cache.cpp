@@ -0,0 +1,484 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/cache.h"
+#include "file/gzip.h"
+#include "http/header.h"
+#include "http/header_names.h"
+#include "tools/asstring.h"
+#include "tools/split.h"
+#include "tools/iterators.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/date_time/posix_time/conversion.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace file
+{
+    namespace {
+        // returns true, if the list of entity tags contains the given tag or is "*"
+        bool etag_listed( tools::substring tag_list, const std::string& etag )
+        {
+            for ( bool last = false; !last; )
+            {
+                tools::substring tag, rest;
+                last = !tools::split_to_empty( tag_list, ',', tag, rest );
+
+                if ( last )
+                    tag = tag_list;
+
+                tag.trim( ' ' ).trim( '\t' );
+
+                if ( tag == "*" || tag == etag.c_str() )
+                    return true;
+
+                tag_list = rest;
+            }
+
+            return false;
+        }
+
+        void read_file( const boost::filesystem::path& file_name, std::vector< char >& content )
+        {
+            boost::filesystem::ifstream input( file_name, std::ios_base::in | std::ios_base::binary );
+
+            if ( !input.is_open() )
+                throw std::runtime_error( "unable to open: " + tools::as_string( file_name ) );
+
+            std::istreambuf_iterator< char > begin( input ), end;
+            content.insert( content.end(), begin, end );
+
+            if ( input.bad() )
+                throw std::runtime_error( "unable to read: " + tools::as_string( file_name ) );
+        }
+
+        // files smaller than this are not compressed on the fly
+        const std::size_t min_gzip_size = 256;
+
+        // URIs, that are remembered per cached file; further URIs of the file are resolved by the file system
+        const std::size_t max_uris_per_file = 8;
+
+        bool same_file( const boost::filesystem::path& file_name, std::time_t write_time, boost::uintmax_t size )
+        {
+            boost::system::error_code   ec;
+            const std::time_t           current_write_time = boost::filesystem::last_write_time( file_name, ec );
+
+            if ( ec || current_write_time != write_time )
+                return false;
+
+            const boost::uintmax_t      current_size = boost::filesystem::file_size( file_name, ec );
+
+            return !ec && current_size == size;
+        }
+    }
+
+    std::string entity_tag( boost::uintmax_t size, std::time_t write_time )
+    {
+        std::ostringstream out;
+        out << '"' << std::hex << size << '-' << static_cast< boost::uintmax_t >( write_time ) << '"';
+
+        return out.str();
+    }
+
+    std::string http_date( std::time_t time )
+    {
+        static const char* const week_days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+        static const char* const months[] = {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+        const boost::posix_time::ptime              stamp = boost::posix_time::from_time_t( time );
+        const boost::gregorian::date                date  = stamp.date();
+        const boost::posix_time::time_duration      day   = stamp.time_of_day();
+
+        char buffer[ 64 ];
+        std::sprintf( buffer, "%s, %02u %s %04u %02u:%02u:%02u GMT",
+            week_days[ date.day_of_week().as_number() ],
+            static_cast< unsigned >( date.day() ),
+            months[ date.month().as_number() - 1 ],
+            static_cast< unsigned >( date.year() ),
+            static_cast< unsigned >( day.hours() ),
+            static_cast< unsigned >( day.minutes() ),
+            static_cast< unsigned >( day.seconds() ) );
+
+        return buffer;
+    }
+
+    /////////////////
+    // class cached_file
+    cached_file::cached_file( const boost::filesystem::path& file_name )
+        : path_( file_name )
+        , write_time_( boost::filesystem::last_write_time( file_name ) )
+        , file_size_( boost::filesystem::file_size( file_name ) )
+        , last_modified_( http_date( write_time_ ) )
+        , gzipped_( false )
+        , precompressed_( false )
+        , sibling_write_time_( 0 )
+        , sibling_size_( 0 )
+    {
+        representation& identity = representations_[ identity_coding ];
+        representation& gzipped  = representations_[ gzip_coding ];
+
+        identity.body.reserve( static_cast< std::size_t >( file_size_ ) );
+        read_file( path_, identity.body );
+        identity.etag = entity_tag( file_size_, write_time_ );
+
+        const boost::filesystem::path sibling = gzip_sibling( path_ );
+
+        if ( !sibling.empty() )
+        {
+            sibling_write_time_ = boost::filesystem::last_write_time( sibling );
+            read_file( sibling, gzipped.body );
+            sibling_size_       = gzipped.body.size();
+            gzipped.etag        = entity_tag( sibling_size_, sibling_write_time_ );
+            gzipped_            = true;
+            precompressed_      = true;
+        }
+        else if ( identity.body.size() >= min_gzip_size )
+        {
+            gzip( &identity.body[ 0 ], &identity.body[ 0 ] + identity.body.size() ).swap( gzipped.body );
+
+            // keep the compressed version only, if it saves at least 10%
+            gzipped_ = gzipped.body.size() < identity.body.size() - identity.body.size() / 10;
+
+            if ( gzipped_ )
+            {
+                gzipped.etag = identity.etag;
+                gzipped.etag.insert( gzipped.etag.size() - 1, "-gz" );
+            }
+            else
+            {
+                std::vector< char >().swap( gzipped.body );
+            }
+        }
+
+        if ( gzipped_ )
+        {
+            const std::string vary = std::string( http::vary_header ) + ": " + http::accept_encoding_header + "\r\n";
+
+            render_headers( identity, vary );
+            render_headers( gzipped, vary + http::content_encoding_header + ": gzip\r\n" );
+        }
+        else
+        {
+            render_headers( identity, std::string() );
+        }
+    }
+
+    void cached_file::render_headers( representation& r, const std::string& additional_headers ) const
+    {
+        const std::string validators =
+            std::string( http::etag_header ) + ": " + r.etag + "\r\n"
+          + http::last_modified_header + ": " + last_modified_ + "\r\n";
+
+        r.header =
+            "HTTP/1.1 200 OK\r\n"
+          + std::string( http::content_length_header ) + ": " + tools::as_string( r.body.size() ) + "\r\n"
+          + validators
+          + additional_headers
+          + "Accept-Ranges: bytes\r\n"
+          + "\r\n";
+
+        r.not_modified_header =
+            "HTTP/1.1 304 Not Modified\r\n"
+          + validators
+          + additional_headers
+          + "\r\n";
+    }
+
+    const boost::filesystem::path& cached_file::path() const
+    {
+        return path_;
+    }
+
+    const std::string& cached_file::header( content_coding coding ) const
+    {
+        return representations_[ coding ].header;
+    }
+
+    const std::string& cached_file::not_modified_header( content_coding coding ) const
+    {
+        return representations_[ coding ].not_modified_header;
+    }
+
+    const std::vector< char >& cached_file::body( content_coding coding ) const
+    {
+        return representations_[ coding ].body;
+    }
+
+    const std::string& cached_file::etag( content_coding coding ) const
+    {
+        return representations_[ coding ].etag;
+    }
+
+    bool cached_file::gzipped() const
+    {
+        return gzipped_;
+    }
+
+    content_coding cached_file::select_coding( const http::request_header& request ) const
+    {
+        return gzipped_ && gzip_accepted( request ) ? gzip_coding : identity_coding;
+    }
+
+    const std::string& cached_file::last_modified() const
+    {
+        return last_modified_;
+    }
+
+    bool cached_file::not_modified( const http::request_header& request, content_coding coding ) const
+    {
+        if ( const http::header* const if_none_match = request.find_header( http::if_none_match_header ) )
+            return etag_listed( if_none_match->value(), representations_[ coding ].etag );
+
+        if ( const http::header* const if_modified_since = request.find_header( http::if_modified_since_header ) )
+            return if_modified_since->value() == last_modified_.c_str();
+
+        return false;
+    }
+
+    void cached_file::response_buffers( const http::request_header& request, char ( &date )[ http::date_header_size ],
+        std::vector< boost::asio::const_buffer >& buffers ) const
+    {
+        const content_coding        coding        = select_coding( request );
+        const bool                  not_modified  = this->not_modified( request, coding );
+        const representation&       r             = representations_[ coding ];
+        const std::string&          head          = not_modified ? r.not_modified_header : r.header;
+        const std::string::size_type status_line  = head.find( "\r\n" ) + 2;
+
+        const tools::substring      now           = http::date_header();
+        std::copy( now.begin(), now.end(), date );
+
+        buffers.push_back( boost::asio::buffer( head.data(), status_line ) );
+        buffers.push_back( boost::asio::buffer( static_cast< const char* >( date ), http::date_header_size ) );
+        buffers.push_back( boost::asio::buffer( head.data() + status_line, head.size() - status_line ) );
+
+        if ( !not_modified && !r.body.empty() )
+            buffers.push_back( boost::asio::buffer( r.body ) );
+    }
+
+    bool cached_file::up_to_date() const
+    {
+        if ( !same_file( path_, write_time_, file_size_ ) )
+            return false;
+
+        // a precompressed sibling, that was added, removed or modified, changes the gzipped representation
+        const boost::filesystem::path sibling = gzip_sibling( path_ );
+
+        if ( sibling.empty() == precompressed_ )
+            return false;
+
+        return !precompressed_ || same_file( sibling, sibling_write_time_, sibling_size_ );
+    }
+
+    std::size_t cached_file::memory_size() const
+    {
+        std::size_t result = sizeof( *this );
+
+        for ( const representation* r = tools::begin( representations_ ); r != tools::end( representations_ ); ++r )
+            result += r->body.size() + r->header.size() + r->not_modified_header.size();
+
+        return result;
+    }
+
+    /////////////////
+    // class cache
+    cache::cache(
+        std::size_t                                 max_size,
+        std::size_t                                 max_file_size,
+        const boost::posix_time::time_duration&     revalidate_interval )
+        : mutex_()
+        , max_size_( max_size )
+        , max_file_size_( max_file_size )
+        , revalidate_interval_( revalidate_interval )
+        , size_( 0 )
+        , lru_()
+        , index_()
+    {
+    }
+
+    boost::shared_ptr< const cached_file > cache::find( const std::string& uri )
+    {
+        bool revalidation_due = false;
+        const boost::shared_ptr< const cached_file > result = find( uri, revalidation_due );
+
+        if ( revalidation_due && !revalidate( uri ) )
+            return boost::shared_ptr< const cached_file >();
+
+        return result;
+    }
+
+    boost::shared_ptr< const cached_file > cache::find( const std::string& uri, bool& revalidation_due )
+    {
+        revalidation_due = false;
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        const index_t::iterator pos = uris_.find( uri );
+
+        if ( pos == uris_.end() )
+            return boost::shared_ptr< const cached_file >();
+
+        entry& found = *pos->second;
+        const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+
+        // only the first lookup in an interval triggers the check
+        if ( now - found.validated >= revalidate_interval_ )
+        {
+            found.validated  = now;
+            revalidation_due = true;
+        }
+
+        lru_.splice( lru_.begin(), lru_, pos->second );
+
+        return found.file;
+    }
+
+    bool cache::revalidate( const std::string& uri )
+    {
+        boost::shared_ptr< const cached_file > file;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            const index_t::iterator pos = uris_.find( uri );
+
+            if ( pos == uris_.end() )
+                return false;
+
+            file = pos->second->file;
+        }
+
+        if ( file->up_to_date() )
+            return true;
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        // the entry might have been replaced, while the lock was released
+        const index_t::iterator pos = uris_.find( uri );
+
+        if ( pos != uris_.end() && pos->second->file == file )
+            remove( pos->second );
+
+        return false;
+    }
+
+    boost::shared_ptr< const cached_file > cache::insert( const std::string& uri, const boost::filesystem::path& file_name )
+    {
+        const std::string key = file_name.string();
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            const index_t::iterator pos = index_.find( key );
+
+            if ( pos != index_.end() )
+            {
+                add_uri( pos->second, uri );
+                lru_.splice( lru_.begin(), lru_, pos->second );
+
+                return pos->second->file;
+            }
+        }
+
+        if ( boost::filesystem::file_size( file_name ) > max_file_size_ )
+            return boost::shared_ptr< const cached_file >();
+
+        // read the file without holding the lock
+        const boost::shared_ptr< const cached_file > file( new cached_file( file_name ) );
+        const std::size_t file_size = file->memory_size();
+
+        if ( file_size > max_size_ )
+            return file;
+
+        entry new_entry;
+        new_entry.file_name = key;
+        new_entry.file      = file;
+        new_entry.validated = boost::posix_time::microsec_clock::universal_time();
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        // an other thread might have read the same file in the meantime
+        const index_t::iterator pos = index_.find( key );
+        if ( pos != index_.end() )
+            remove( pos->second );
+
+        while ( size_ + file_size > max_size_ )
+            remove( --lru_.end() );
+
+        lru_.push_front( new_entry );
+        index_.insert( std::make_pair( key, lru_.begin() ) );
+        add_uri( lru_.begin(), uri );
+        size_ += file_size;
+
+        return file;
+    }
+
+    void cache::invalidate( const std::string& uri )
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        const index_t::iterator pos = uris_.find( uri );
+
+        if ( pos != uris_.end() )
+            remove( pos->second );
+    }
+
+    void cache::clear()
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        index_.clear();
+        uris_.clear();
+        lru_.clear();
+        size_ = 0;
+    }
+
+    std::size_t cache::size() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return size_;
+    }
+
+    std::size_t cache::entries() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return index_.size();
+    }
+
+    void cache::add_uri( lru_list_t::iterator pos, const std::string& uri )
+    {
+        const index_t::iterator alias = uris_.find( uri );
+
+        if ( alias != uris_.end() )
+        {
+            if ( alias->second == pos )
+                return;
+
+            // the URI refered to an other file
+            std::vector< std::string >& uris = alias->second->uris;
+            uris.erase( std::find( uris.begin(), uris.end(), uri ) );
+            uris_.erase( alias );
+        }
+
+        if ( pos->uris.size() < max_uris_per_file )
+        {
+            pos->uris.push_back( uri );
+            uris_.insert( std::make_pair( uri, pos ) );
+        }
+    }
+
+    void cache::remove( lru_list_t::iterator pos )
+    {
+        for ( std::vector< std::string >::const_iterator uri = pos->uris.begin(); uri != pos->uris.end(); ++uri )
+            uris_.erase( *uri );
+
+        size_ -= pos->file->memory_size();
+        index_.erase( pos->file_name );
+        lru_.erase( pos );
+    }
+}
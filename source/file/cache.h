@@ -0,0 +1,271 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_FILE_CACHE_H_
+#define SIOUX_FILE_CACHE_H_
+
+#include "http/request.h"
+#include "http/response_head.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+#include <ctime>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace file
+{
+    /**
+     * @brief the content codings, a cached file can be delivered with
+     */
+    enum content_coding
+    {
+        identity_coding,
+        gzip_coding
+    };
+
+    /**
+     * @brief a file, read into memory, with a pre-rendered response header and the validators of the file
+     *
+     * In addition to the file content, a gzip compressed version of the file is kept. This version is read from
+     * a precompressed sibling file (file name + ".gz") if there is one, otherwise the content is compressed, if
+     * that results in a noticeable reduction of size. If there is a compressed version, all response headers
+     * contain a "Vary: Accept-Encoding" header.
+     *
+     * The pre-rendered headers contain no Date header, response_buffers() inserts the current one.
+     */
+    class cached_file : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief reads the given file and renders the response headers
+         * @exception std::exception if the file can not be read
+         */
+        explicit cached_file( const boost::filesystem::path& file_name );
+
+        /**
+         * @brief the file name, the content was read from
+         */
+        const boost::filesystem::path& path() const;
+
+        /**
+         * @brief the complete "200 OK" response header, including the terminating empty line
+         */
+        const std::string& header( content_coding coding = identity_coding ) const;
+
+        /**
+         * @brief the complete "304 Not Modified" response header, including the terminating empty line
+         */
+        const std::string& not_modified_header( content_coding coding = identity_coding ) const;
+
+        /**
+         * @brief the content of the file
+         */
+        const std::vector< char >& body( content_coding coding = identity_coding ) const;
+
+        /**
+         * @brief the entity tag, including the quotes
+         */
+        const std::string& etag( content_coding coding = identity_coding ) const;
+
+        /**
+         * @brief the last modification time, formated as HTTP-date (RFC 1123)
+         */
+        const std::string& last_modified() const;
+
+        /**
+         * @brief returns true, if there is a gzip compressed version of the file
+         */
+        bool gzipped() const;
+
+        /**
+         * @brief selects the content coding, that should be used to answer the given request
+         */
+        content_coding select_coding( const http::request_header& request ) const;
+
+        /**
+         * @brief returns true, if the given request contains validators, that match this file.
+         *
+         * If the request contains an If-None-Match header, the result depends solely on the entity tags listed in
+         * that header. Otherwise an If-Modified-Since header has to contain the exact Last-Modified date.
+         */
+        bool not_modified( const http::request_header& request, content_coding coding = identity_coding ) const;
+
+        /**
+         * @brief adds the complete response to the given request to buffers
+         *
+         * The coding is selected for the request and, if the validators of the request match, the "304 Not
+         * Modified" header is used. The header is split behind the status line, to insert the current Date header,
+         * that is copied to date. All buffers refer to this file and to date, so both have to outlive the write.
+         */
+        void response_buffers( const http::request_header& request, char ( &date )[ http::date_header_size ],
+            std::vector< boost::asio::const_buffer >& buffers ) const;
+
+        /**
+         * @brief returns false, if the file or its precompressed sibling in the file system was modified since
+         *        it was read
+         */
+        bool up_to_date() const;
+
+        /**
+         * @brief the number of bytes used to store this file
+         */
+        std::size_t memory_size() const;
+
+    private:
+        struct representation
+        {
+            std::vector< char >         body;
+            std::string                 etag;
+            std::string                 header;
+            std::string                 not_modified_header;
+        };
+
+        void render_headers( representation&, const std::string& additional_headers ) const;
+
+        const boost::filesystem::path   path_;
+        std::time_t                     write_time_;
+        boost::uintmax_t                file_size_;
+        std::string                     last_modified_;
+        bool                            gzipped_;
+        // true, if the gzipped body was read from the precompressed sibling
+        bool                            precompressed_;
+        std::time_t                     sibling_write_time_;
+        boost::uintmax_t                sibling_size_;
+        representation                  representations_[ 2 ];
+    };
+
+    /**
+     * @brief builds a strong entity tag, including the quotes, from the size and the modification time of a file
+     */
+    std::string entity_tag( boost::uintmax_t size, std::time_t write_time );
+
+    /**
+     * @brief formats the given time as HTTP-date (RFC 1123), for example "Sun, 06 Nov 1994 08:49:37 GMT"
+     */
+    std::string http_date( std::time_t time );
+
+    /**
+     * @brief bounded, least recently used cache of static files
+     *
+     * The cache holds files, that are read into memory, keyed by their file name, which should be canonical. The
+     * request URIs, that were resolved to a file, refer to its entry, so that a lookup by URI needs no file system
+     * access and different URIs of the same file (like "/x", "//x" and "/a/../x") share one copy of it. The number
+     * of URIs remembered per file is limited. The total size of all cached files is limited by a byte budget; if a
+     * new file would exceed the budget, the least recently used files are removed. Files bigger than a
+     * configurable limit are not cached at all.
+     *
+     * Modifications of the cached files are detected by comparing the modification time and size of the file
+     * and of its precompressed sibling with the time and size, when the files were read. To keep the number of
+     * file system accesses low, this check is performed at most once per configurable interval and per entry. The
+     * check is never performed, while the cache is locked, and can be moved to a thread, that may block on the file
+     * system, by using find( uri, revalidation_due ) and revalidate().
+     *
+     * All functions are thread safe.
+     */
+    class cache : boost::noncopyable
+    {
+    public:
+        /**
+         * @param max_size the maximum number of bytes, all cached files will occupy
+         * @param max_file_size the maximum size of a single file to be cached
+         * @param revalidate_interval the interval after which a file in the file system is checked for modifications
+         */
+        explicit cache(
+            std::size_t                                 max_size,
+            std::size_t                                 max_file_size = 1024 * 1024,
+            const boost::posix_time::time_duration&     revalidate_interval = boost::posix_time::seconds( 1 ) );
+
+        /**
+         * @brief looks up the file that was cached for the given URI.
+         *
+         * If the file was modified since it was read, the entry will be removed from the cache and an empty
+         * pointer is returned.
+         */
+        boost::shared_ptr< const cached_file > find( const std::string& uri );
+
+        /**
+         * @brief looks up the file that was cached for the given URI, without accessing the file system
+         *
+         * If the entry is due to be checked for modifications, revalidation_due is set to true and the caller is
+         * responsible to call revalidate( uri ). Until then, the cached file is delivered, even if it was modified.
+         * Otherwise, revalidation_due is set to false.
+         */
+        boost::shared_ptr< const cached_file > find( const std::string& uri, bool& revalidation_due );
+
+        /**
+         * @brief checks the file cached for the given URI for modifications and removes the entry, if the file was
+         *        modified
+         *
+         * The file system is accessed without holding the lock of the cache. Returns false, if the entry was removed.
+         */
+        bool revalidate( const std::string& uri );
+
+        /**
+         * @brief reads the given file, adds it to the cache and lets the given URI refer to it
+         *
+         * If the file is already cached, because it was requested by an other URI, the cached file is returned
+         * without reading it again. Returns an empty pointer, if the file is to big to be cached.
+         * @exception std::exception if the file can not be read
+         */
+        boost::shared_ptr< const cached_file > insert( const std::string& uri, const boost::filesystem::path& file_name );
+
+        /**
+         * @brief removes the file, the given URI refers to, if there is one
+         */
+        void invalidate( const std::string& uri );
+
+        /**
+         * @brief removes all entries
+         */
+        void clear();
+
+        /**
+         * @brief the number of bytes currently occupied by cached files
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief the number of cached files
+         */
+        std::size_t entries() const;
+
+    private:
+        struct entry
+        {
+            std::string                             file_name;
+            std::vector< std::string >              uris;
+            boost::shared_ptr< const cached_file >  file;
+            boost::posix_time::ptime                validated;
+        };
+
+        typedef std::list< entry >                                  lru_list_t;
+        typedef std::map< std::string, lru_list_t::iterator >       index_t;
+
+        // lets the uri refer to the given entry, if the entry has not too many URIs already
+        void add_uri( lru_list_t::iterator, const std::string& uri );
+        void remove( lru_list_t::iterator );
+
+        mutable boost::mutex                        mutex_;
+        const std::size_t                           max_size_;
+        const std::size_t                           max_file_size_;
+        const boost::posix_time::time_duration      revalidate_interval_;
+
+        std::size_t                                 size_;
+        // most recently used entries at the front
+        lru_list_t                                  lru_;
+        // entries by file name
+        index_t                                     index_;
+        // entries by request URI
+        index_t                                     uris_;
+    };
+}
+
+#endif /* SIOUX_FILE_CACHE_H_ */
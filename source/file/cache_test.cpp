@@ -0,0 +1,321 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/cache.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+namespace
+{
+    boost::filesystem::path test_root()
+    {
+        return boost::filesystem::canonical( __FILE__ ).parent_path() / "root";
+    }
+
+    // a temporary file, that is removed, when the object is destroyed
+    class temporary_file
+    {
+    public:
+        explicit temporary_file( const std::string& content )
+            : path_( boost::filesystem::temp_directory_path() / boost::filesystem::unique_path() )
+        {
+            write( content );
+        }
+
+        temporary_file( const boost::filesystem::path& file_name, const std::string& content )
+            : path_( file_name )
+        {
+            write( content );
+        }
+
+        ~temporary_file()
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove( path_, ec );
+        }
+
+        void write( const std::string& content )
+        {
+            boost::filesystem::ofstream output( path_, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+            output << content;
+        }
+
+        const boost::filesystem::path& path() const
+        {
+            return path_;
+        }
+
+    private:
+        const boost::filesystem::path path_;
+    };
+}
+
+BOOST_AUTO_TEST_CASE( format_http_date )
+{
+    BOOST_CHECK_EQUAL( file::http_date( 0 ), "Thu, 01 Jan 1970 00:00:00 GMT" );
+    BOOST_CHECK_EQUAL( file::http_date( 784111777 ), "Sun, 06 Nov 1994 08:49:37 GMT" );
+}
+
+BOOST_AUTO_TEST_CASE( cached_file_renders_headers )
+{
+    const file::cached_file file( test_root() / "root.txt" );
+
+    BOOST_CHECK_EQUAL( std::string( file.body().begin(), file.body().end() ), "root_text" );
+    BOOST_CHECK_EQUAL( file.header(),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 9\r\n"
+        "ETag: " + file.etag() + "\r\n"
+        "Last-Modified: " + file.last_modified() + "\r\n"
+        "Accept-Ranges: bytes\r\n"
+        "\r\n" );
+    BOOST_CHECK_EQUAL( file.not_modified_header(),
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: " + file.etag() + "\r\n"
+        "Last-Modified: " + file.last_modified() + "\r\n"
+        "\r\n" );
+}
+
+BOOST_AUTO_TEST_CASE( cache_lookup )
+{
+    file::cache cache( 1024 * 1024 );
+
+    BOOST_CHECK( !cache.find( "/root.txt" ) );
+
+    const boost::shared_ptr< const file::cached_file > inserted = cache.insert( "/root.txt", test_root() / "root.txt" );
+    BOOST_REQUIRE( inserted );
+    BOOST_CHECK_EQUAL( cache.find( "/root.txt" ), inserted );
+    BOOST_CHECK_EQUAL( cache.entries(), 1u );
+    BOOST_CHECK_EQUAL( cache.size(), inserted->memory_size() );
+
+    cache.invalidate( "/root.txt" );
+    BOOST_CHECK( !cache.find( "/root.txt" ) );
+    BOOST_CHECK_EQUAL( cache.entries(), 0u );
+    BOOST_CHECK_EQUAL( cache.size(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( least_recently_used_files_are_removed_first )
+{
+    const temporary_file first( "content" ), second( "content" ), third( "content" );
+    const std::size_t entry_size = file::cached_file( first.path() ).memory_size();
+    file::cache cache( 2 * entry_size + entry_size / 2 );
+
+    cache.insert( "/1", first.path() );
+    cache.insert( "/2", second.path() );
+    BOOST_CHECK_EQUAL( cache.entries(), 2u );
+
+    // make "/1" the most recently used entry
+    BOOST_CHECK( cache.find( "/1" ) );
+
+    cache.insert( "/3", third.path() );
+    BOOST_CHECK_EQUAL( cache.entries(), 2u );
+    BOOST_CHECK( cache.find( "/1" ) );
+    BOOST_CHECK( !cache.find( "/2" ) );
+    BOOST_CHECK( cache.find( "/3" ) );
+    BOOST_CHECK_LE( cache.size(), 2 * entry_size + entry_size / 2 );
+}
+
+/**
+ * @test different URIs of the same file share one entry
+ */
+BOOST_AUTO_TEST_CASE( files_are_cached_once_per_file_name )
+{
+    file::cache cache( 1024 * 1024 );
+
+    const boost::shared_ptr< const file::cached_file > inserted = cache.insert( "/x", test_root() / "root.txt" );
+    BOOST_REQUIRE( inserted );
+    BOOST_CHECK_EQUAL( cache.insert( "//x", test_root() / "root.txt" ), inserted );
+    BOOST_CHECK_EQUAL( cache.insert( "/a/../x", test_root() / "root.txt" ), inserted );
+
+    BOOST_CHECK_EQUAL( cache.entries(), 1u );
+    BOOST_CHECK_EQUAL( cache.size(), inserted->memory_size() );
+    BOOST_CHECK_EQUAL( cache.find( "/x" ), inserted );
+    BOOST_CHECK_EQUAL( cache.find( "//x" ), inserted );
+    BOOST_CHECK_EQUAL( cache.find( "/a/../x" ), inserted );
+
+    // a URI, that refers to an other file now
+    BOOST_REQUIRE( cache.insert( "//x", test_root() / "a" / "1.txt" ) );
+    BOOST_CHECK_EQUAL( cache.entries(), 2u );
+    BOOST_CHECK_NE( cache.find( "//x" ), inserted );
+    BOOST_CHECK_EQUAL( cache.find( "/x" ), inserted );
+
+    // invalidating by one URI, removes the file for all URIs
+    cache.invalidate( "/a/../x" );
+    BOOST_CHECK( !cache.find( "/x" ) );
+    BOOST_CHECK( cache.find( "//x" ) );
+    BOOST_CHECK_EQUAL( cache.entries(), 1u );
+}
+
+/**
+ * @test the number of URIs, remembered per file, is limited
+ */
+BOOST_AUTO_TEST_CASE( uris_per_file_are_limited )
+{
+    file::cache cache( 1024 * 1024 );
+    std::string uri = "/x";
+
+    for ( int i = 0; i != 100; ++i, uri.insert( 0, "/" ) )
+        BOOST_CHECK( cache.insert( uri, test_root() / "root.txt" ) );
+
+    BOOST_CHECK_EQUAL( cache.entries(), 1u );
+    BOOST_CHECK( cache.find( "/x" ) );
+    BOOST_CHECK( !cache.find( uri.substr( 1 ) ) );
+}
+
+BOOST_AUTO_TEST_CASE( big_files_are_not_cached )
+{
+    file::cache cache( 1024 * 1024, 5 );
+
+    BOOST_CHECK( !cache.insert( "/root.txt", test_root() / "root.txt" ) );
+    BOOST_CHECK( cache.insert( "/a/1.txt", test_root() / "a" / "1.txt" ) );
+    BOOST_CHECK_EQUAL( cache.entries(), 1u );
+}
+
+BOOST_AUTO_TEST_CASE( modified_files_are_removed_from_the_cache )
+{
+    temporary_file  temp( "content" );
+    file::cache     cache( 1024 * 1024, 1024, boost::posix_time::seconds( 0 ) );
+
+    BOOST_REQUIRE( cache.insert( "/temp", temp.path() ) );
+    BOOST_CHECK( cache.find( "/temp" ) );
+
+    temp.write( "modified content" );
+
+    BOOST_CHECK( !cache.find( "/temp" ) );
+    BOOST_CHECK_EQUAL( cache.entries(), 0u );
+}
+
+/**
+ * @test find( uri, revalidation_due ) delivers a modified file, until revalidate() is called
+ */
+BOOST_AUTO_TEST_CASE( revalidation_can_be_deferred )
+{
+    temporary_file  temp( "content" );
+    file::cache     cache( 1024 * 1024, 1024, boost::posix_time::hours( 1 ) );
+    bool            revalidation_due = true;
+
+    const boost::shared_ptr< const file::cached_file > inserted = cache.insert( "/temp", temp.path() );
+    BOOST_REQUIRE( inserted );
+    BOOST_CHECK_EQUAL( cache.find( "/temp", revalidation_due ), inserted );
+    BOOST_CHECK( !revalidation_due );
+    BOOST_CHECK( cache.revalidate( "/temp" ) );
+
+    file::cache due_cache( 1024 * 1024, 1024, boost::posix_time::seconds( 0 ) );
+    BOOST_REQUIRE( due_cache.insert( "/temp", temp.path() ) );
+
+    temp.write( "modified content" );
+
+    BOOST_CHECK( due_cache.find( "/temp", revalidation_due ) );
+    BOOST_CHECK( revalidation_due );
+
+    BOOST_CHECK( !due_cache.revalidate( "/temp" ) );
+    BOOST_CHECK_EQUAL( due_cache.entries(), 0u );
+    BOOST_CHECK( !due_cache.find( "/temp", revalidation_due ) );
+    BOOST_CHECK( !revalidation_due );
+    BOOST_CHECK( !due_cache.revalidate( "/temp" ) );
+}
+
+BOOST_AUTO_TEST_CASE( compressible_files_are_cached_gzipped )
+{
+    temporary_file          temp( std::string( 1000, 'a' ) );
+    const file::cached_file file( temp.path() );
+
+    BOOST_REQUIRE( file.gzipped() );
+    BOOST_CHECK_LT( file.body( file::gzip_coding ).size(), file.body().size() );
+    BOOST_CHECK_NE( file.etag( file::gzip_coding ), file.etag() );
+    BOOST_CHECK_NE( file.header().find( "Vary: Accept-Encoding\r\n" ), std::string::npos );
+    BOOST_CHECK_EQUAL( file.header().find( "Content-Encoding" ), std::string::npos );
+    BOOST_CHECK_NE( file.header( file::gzip_coding ).find( "Vary: Accept-Encoding\r\n" ), std::string::npos );
+    BOOST_CHECK_NE( file.header( file::gzip_coding ).find( "Content-Encoding: gzip\r\n" ), std::string::npos );
+
+    const http::request_header gzip_request(
+        "GET / HTTP/1.1\r\nHost: google.de\r\nAccept-Encoding: gzip\r\n\r\n" );
+    const http::request_header identity_request(
+        "GET / HTTP/1.1\r\nHost: google.de\r\n\r\n" );
+
+    BOOST_CHECK_EQUAL( file.select_coding( gzip_request ), file::gzip_coding );
+    BOOST_CHECK_EQUAL( file.select_coding( identity_request ), file::identity_coding );
+}
+
+BOOST_AUTO_TEST_CASE( small_files_are_not_compressed )
+{
+    const file::cached_file file( test_root() / "root.txt" );
+
+    BOOST_CHECK( !file.gzipped() );
+    BOOST_CHECK_EQUAL( file.header().find( "Vary" ), std::string::npos );
+}
+
+BOOST_AUTO_TEST_CASE( modified_gzip_siblings_are_removed_from_the_cache )
+{
+    temporary_file  temp( "content" );
+    file::cache     cache( 1024 * 1024, 1024, boost::posix_time::seconds( 0 ) );
+
+    {
+        temporary_file sibling( temp.path().string() + ".gz", "compressed" );
+
+        BOOST_REQUIRE( cache.insert( "/temp", temp.path() ) );
+        BOOST_REQUIRE( cache.find( "/temp" )->gzipped() );
+
+        sibling.write( "compressed again" );
+        BOOST_CHECK( !cache.find( "/temp" ) );
+
+        BOOST_REQUIRE( cache.insert( "/temp", temp.path() ) );
+        BOOST_CHECK( cache.find( "/temp" ) );
+    }
+
+    // the sibling was removed
+    BOOST_CHECK( !cache.find( "/temp" ) );
+
+    BOOST_REQUIRE( cache.insert( "/temp", temp.path() ) );
+    BOOST_CHECK( cache.find( "/temp" ) );
+
+    // a sibling was added
+    temporary_file sibling( temp.path().string() + ".gz", "compressed" );
+    BOOST_CHECK( !cache.find( "/temp" ) );
+}
+
+namespace
+{
+    std::string as_text( const std::vector< boost::asio::const_buffer >& buffers )
+    {
+        std::string result;
+
+        for ( std::vector< boost::asio::const_buffer >::const_iterator b = buffers.begin(); b != buffers.end(); ++b )
+            result.append( boost::asio::buffer_cast< const char* >( *b ), boost::asio::buffer_size( *b ) );
+
+        return result;
+    }
+}
+
+/**
+ * @test the response buffers contain the current Date header behind the status line
+ */
+BOOST_AUTO_TEST_CASE( cached_responses_contain_a_date_header )
+{
+    const file::cached_file file( test_root() / "root.txt" );
+    char                    date[ http::date_header_size ];
+
+    const http::request_header request( "GET / HTTP/1.1\r\nHost: google.de\r\n\r\n" );
+    std::vector< boost::asio::const_buffer > buffers;
+    file.response_buffers( request, date, buffers );
+
+    const std::string ok = as_text( buffers );
+
+    BOOST_CHECK_EQUAL( ok.substr( 0, 17 ), "HTTP/1.1 200 OK\r\n" );
+    BOOST_CHECK_EQUAL( ok.substr( 17, 6 ), "Date: " );
+    BOOST_CHECK_EQUAL( ok.substr( 17 + http::date_header_size ), file.header().substr( 17 ) + "root_text" );
+
+    const std::string conditional_text =
+        "GET / HTTP/1.1\r\nHost: google.de\r\nIf-None-Match: " + file.etag() + "\r\n\r\n";
+    const http::request_header conditional( conditional_text.c_str() );
+    buffers.clear();
+    file.response_buffers( conditional, date, buffers );
+
+    const std::string not_modified = as_text( buffers );
+
+    BOOST_CHECK_EQUAL( not_modified.substr( 0, 27 ), "HTTP/1.1 304 Not Modified\r\n" );
+    BOOST_CHECK_EQUAL( not_modified.substr( 27, 6 ), "Date: " );
+    BOOST_CHECK_EQUAL( not_modified.substr( 27 + http::date_header_size ), file.not_modified_header().substr( 27 ) );
+}
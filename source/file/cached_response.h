@@ -0,0 +1,89 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_FILE_CACHED_RESPONSE_H_
+#define SIOUX_FILE_CACHED_RESPONSE_H_
+
+#include "file/cache.h"
+#include "server/response.h"
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/bind.hpp>
+
+namespace file
+{
+    /**
+     * @brief delivers a file from the file cache
+     *
+     * The response header and the body are written directly from the cached file, without any copying, only the
+     * Date header is stored in the response. If the request contains validators that match the cached file, a
+     * "304 Not Modified" response is sent. If the client accepts it, the gzip compressed version of the file is
+     * delivered.
+     */
+    template < class Connection >
+    class cached_response :
+        public boost::enable_shared_from_this< cached_response< Connection > >,
+        public server::async_response
+    {
+    public:
+        cached_response(
+            const boost::shared_ptr< Connection >&                  connection,
+            const boost::shared_ptr< const http::request_header >&  request,
+            const boost::shared_ptr< const cached_file >&           file );
+
+        void data_written(
+            const boost::system::error_code&    error,
+            std::size_t                         bytes_transferred);
+
+    private:
+        virtual void start();
+
+        const boost::shared_ptr< Connection >                   connection_;
+        const boost::shared_ptr< const http::request_header >   request_;
+        const boost::shared_ptr< const cached_file >            file_;
+        char                                                    date_[ http::date_header_size ];
+        std::vector< boost::asio::const_buffer >                result_;
+    };
+
+    // implementation
+    template < class Connection >
+    cached_response< Connection >::cached_response(
+        const boost::shared_ptr< Connection >&                  connection,
+        const boost::shared_ptr< const http::request_header >&  request,
+        const boost::shared_ptr< const cached_file >&           file )
+        : connection_( connection )
+        , request_( request )
+        , file_( file )
+        , result_()
+    {
+    }
+
+    template < class Connection >
+    void cached_response< Connection >::data_written(
+        const boost::system::error_code&    error,
+        std::size_t                         /* bytes_transferred */)
+    {
+        if ( !error )
+        {
+            connection_->response_completed( *this );
+        }
+        else
+        {
+            connection_->response_not_possible( *this );
+        }
+    }
+
+    template < class Connection >
+    void cached_response< Connection >::start()
+    {
+        file_->response_buffers( *request_, date_, result_ );
+
+        connection_->async_write(
+            result_,
+            boost::bind( &cached_response::data_written, this->shared_from_this(), _1, _2 ),
+            *this );
+    }
+}
+
+#endif /* SIOUX_FILE_CACHED_RESPONSE_H_ */
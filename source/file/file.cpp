@@ -3,12 +3,17 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "file/file.h"
+#include "file/gzip.h"
 #include "tools/asstring.h"
+#include "tools/iterators.h"
 
 namespace file
 {
-    file_root::file_root( const boost::filesystem::path& root_file_name )
+    file_root::file_root( const boost::filesystem::path& root_file_name, const boost::shared_ptr< cache >& file_cache,
+        const boost::shared_ptr< io_pool >& pool )
         : root_( boost::filesystem::canonical( root_file_name ) )
+        , cache_( file_cache )
+        , pool_( pool )
     {
         if ( !exists( root_ ) )
             throw std::runtime_error( "file_root: " + tools::as_string( root_ ) + " doesn't exists!" );
@@ -28,4 +33,71 @@ namespace file
         return boost::filesystem::path();
     }
 
+    boost::filesystem::path file_root::resolve( const http::request_header& header, http::http_error_code& error ) const
+    {
+        const boost::filesystem::path file_name = check_canonical( header );
+
+        if ( file_name.empty() )
+        {
+            error = http::http_forbidden;
+            return file_name;
+        }
+
+        if ( !is_directory( file_name ) )
+            return file_name;
+
+        static const char* const index_files[] = { "index.html", "index.htm" };
+
+        for ( const char* const* index = tools::begin( index_files ); index != tools::end( index_files ); ++index )
+        {
+            const boost::filesystem::path changed_file_name = file_name / *index;
+
+            if ( exists( changed_file_name ) && !is_directory( changed_file_name ) )
+                return changed_file_name;
+        }
+
+        error = http::http_not_found;
+        return boost::filesystem::path();
+    }
+
+    boost::filesystem::path file_root::select_coding( const http::request_header& header,
+        const boost::filesystem::path& file_name, std::string& additional_headers )
+    {
+        const boost::filesystem::path sibling = gzip_sibling( file_name );
+
+        if ( sibling.empty() )
+            return file_name;
+
+        additional_headers = std::string( http::vary_header ) + ": " + http::accept_encoding_header + "\r\n";
+
+        if ( !gzip_accepted( header ) )
+            return file_name;
+
+        additional_headers += std::string( http::content_encoding_header ) + ": gzip\r\n";
+
+        return sibling;
+    }
+
+    bool file_root::resolve_in_pool( const http::request_header& header, boost::filesystem::path& file_name,
+        std::string& additional_headers, boost::shared_ptr< const cached_file >& cached,
+        http::http_error_code& error ) const
+    {
+        const boost::filesystem::path resolved = resolve( header, error );
+
+        if ( resolved.empty() )
+            return false;
+
+        if ( cache_ && !header.find_header( http::range_header ) )
+        {
+            cached = cache_->insert( tools::as_string( header.uri() ), resolved );
+
+            if ( cached )
+                return true;
+        }
+
+        file_name = select_coding( header, resolved, additional_headers );
+
+        return true;
+    }
+
 }
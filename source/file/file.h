@@ -6,26 +6,47 @@
 #define SIOUX_FILE_FILE_H_
 
 #include "file/response.h"
+#include "file/cache.h"
+#include "file/cached_response.h"
+#include "file/io_pool.h"
 #include "http/request.h"
+#include "http/header_names.h"
 #include "server/error.h"
 #include "server/connection.h"
+#include "tools/asstring.h"
 
 #include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace file
 {
     /**
      * @brief defines a root for static file delivery
      *
-     * If the requested file is a directory, a file named 'index.html' or 'index.htm' will be delivered
+     * If the requested file is a directory, a file named 'index.html' or 'index.htm' will be delivered. Range
+     * requests are supported. If the client accepts gzip and there is a file with the same name plus ".gz",
+     * this precompressed file is delivered.
+     *
+     * Optionally, a file_root can use a cache to deliver frequently requested files from memory. Copies
+     * of a file_root share the same cache.
+     *
+     * If an io_pool is given, all requests, that can not be answered from the cache, are resolved and read by
+     * the pool and cached files are checked for modifications by the pool, so that the io_service threads are
+     * never blocked by the file system.
      */
     class file_root
     {
     public:
         /**
          * @brief constructs a file_root with the base directory
+         *
+         * @param root_file_name the base directory
+         * @param file_cache optional cache, used to deliver files from memory
+         * @param pool optional pool, used to perform blocking file system operations
          */
-        explicit file_root( const boost::filesystem::path& root_file_name );
+        explicit file_root( const boost::filesystem::path& root_file_name,
+            const boost::shared_ptr< cache >& file_cache = boost::shared_ptr< cache >(),
+            const boost::shared_ptr< io_pool >& pool = boost::shared_ptr< io_pool >() );
 
         /**
          * @brief creates a response object that will deliver the requested static content
@@ -39,7 +60,25 @@ namespace file
     private:
         boost::filesystem::path check_canonical( const http::request_header& header ) const;
 
+        // maps the request to a file name. If that is not possible, an empty path is returned and
+        // error is set accordingly
+        boost::filesystem::path resolve( const http::request_header& header, http::http_error_code& error ) const;
+
+        // selects a precompressed sibling of the file, if there is one and the client accepts gzip and
+        // fills additional_headers with the required Vary and Content-Encoding headers
+        static boost::filesystem::path select_coding( const http::request_header& header,
+            const boost::filesystem::path& file_name, std::string& additional_headers );
+
+        // file_resolver used for responses, that are performed by the io pool. Adds the file to the cache, if the
+        // file is cacheable, so that this and following requests can be answered from memory. The cache is keyed
+        // by the resolved, canonical file name, the request URI only refers to the cached file.
+        bool resolve_in_pool( const http::request_header& header, boost::filesystem::path& file_name,
+            std::string& additional_headers, boost::shared_ptr< const cached_file >& cached,
+            http::http_error_code& error ) const;
+
         const boost::filesystem::path   root_;
+        boost::shared_ptr< cache >      cache_;
+        boost::shared_ptr< io_pool >    pool_;
     };
 
     /**
@@ -53,6 +92,18 @@ namespace file
     template < class Server >
     void add_file_handler( Server& server, const char* filter, const boost::filesystem::path& root_file_name );
 
+    /**
+     * @brief adds a static file handler to the given server, that delivers files through the given cache
+     *        and performs blocking file system operations in the given pool.
+     * @relates file_root
+     *
+     * Both, file_cache and pool are optional and can be empty.
+     */
+    template < class Server >
+    void add_file_handler( Server& server, const char* filter, const boost::filesystem::path& root_file_name,
+        const boost::shared_ptr< cache >& file_cache,
+        const boost::shared_ptr< io_pool >& pool = boost::shared_ptr< io_pool >() );
+
     // implementation
     template < class Connection >
     boost::shared_ptr< server::async_response > file_root::create_response(
@@ -61,38 +112,59 @@ namespace file
     {
         try
         {
-            boost::filesystem::path file_name = check_canonical( *header );
+            std::string uri;
 
-            if ( file_name.empty() )
-                return boost::shared_ptr< server::async_response >(
-                    new server::defered_error_response< Connection >( connection, http::http_forbidden ) );
+            // range requests are served by the streaming response
+            const bool cacheable = cache_ && !header->find_header( http::range_header );
 
-            if ( is_directory( file_name ) )
+            if ( cacheable )
             {
-                boost::filesystem::path changed_file_name = file_name / "index.html";
+                uri = tools::as_string( header->uri() );
 
-                if ( exists( changed_file_name ) && !is_directory( changed_file_name ) )
-                {
-                    file_name = changed_file_name;
-                }
-                else
+                bool revalidation_due = false;
+                boost::shared_ptr< const cached_file > file = cache_->find( uri, revalidation_due );
+
+                // with a pool, the cached file is delivered, while the pool checks it for modifications. If the pool
+                // is overloaded, the check is skipped until the next interval.
+                if ( revalidation_due )
                 {
-                    boost::filesystem::path changed_file_name = file_name / "index.htm";
-
-                    if ( exists( changed_file_name ) && !is_directory( changed_file_name ) )
-                    {
-                        file_name = changed_file_name;
-                    }
-                    else
-                    {
-                        return boost::shared_ptr< server::async_response >(
-                            new server::defered_error_response< Connection >( connection, http::http_not_found ) );
-                    }
+                    if ( pool_ )
+                        pool_->post( boost::bind( &cache::revalidate, cache_, uri ) );
+                    else if ( !cache_->revalidate( uri ) )
+                        file.reset();
                 }
+
+                if ( file )
+                    return boost::shared_ptr< server::async_response >(
+                        new cached_response< Connection >( connection, header, file ) );
             }
-        
+
+            if ( pool_ )
+                return boost::shared_ptr< server::async_response >(
+                    new response< Connection >( connection, header,
+                        boost::bind( &file_root::resolve_in_pool, *this, _1, _2, _3, _4, _5 ), pool_ ) );
+
+            http::http_error_code           error     = http::http_ok;
+            const boost::filesystem::path   file_name = resolve( *header, error );
+
+            if ( file_name.empty() )
+                return boost::shared_ptr< server::async_response >(
+                    new server::defered_error_response< Connection >( connection, error ) );
+
+            if ( cacheable )
+            {
+                const boost::shared_ptr< const cached_file > file = cache_->insert( uri, file_name );
+
+                if ( file )
+                    return boost::shared_ptr< server::async_response >(
+                        new cached_response< Connection >( connection, header, file ) );
+            }
+
+            std::string                     additional_headers;
+            const boost::filesystem::path   selected_file = select_coding( *header, file_name, additional_headers );
+
             return boost::shared_ptr< server::async_response >(
-                new response< Connection >( connection, file_name ) );
+                new response< Connection >( connection, header, selected_file, additional_headers ) );
         }
         catch ( ... )
         {
@@ -108,6 +180,15 @@ namespace file
         server.add_action( filter, boost::bind( &file_root::create_response< connection_t >, file_root( root_file_name ), _1, _2 ) );
     }
 
+    template < class Server >
+    void add_file_handler( Server& server, const char* filter, const boost::filesystem::path& root_file_name,
+        const boost::shared_ptr< cache >& file_cache, const boost::shared_ptr< io_pool >& pool )
+    {
+        typedef server::connection< typename Server::trait_t > connection_t;
+        server.add_action( filter, boost::bind( &file_root::create_response< connection_t >,
+            file_root( root_file_name, file_cache, pool ), _1, _2 ) );
+    }
+
 }
 
 #endif /* SIOUX_FILE_FILE_H_ */
@@ -3,6 +3,7 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "file/file.h"
+#include "tools/asstring.h"
 #include "server/error.h"
 #include "server/test_socket.h"
 #include "server/test_timer.h"
@@ -14,6 +15,8 @@
 #include "http/response.h"
 
 #include <boost/test/unit_test.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/thread/thread.hpp>
 
 BOOST_AUTO_TEST_CASE( file_root_in_not_existing_directory )
 {
@@ -29,19 +32,19 @@ BOOST_AUTO_TEST_CASE( file_root_is_no_a_directory )
 
 namespace
 {
-    std::string construct_request( const char* uri )
+    std::string construct_request( const char* uri, const std::string& additional_headers = std::string() )
     {
         const std::string result =
             std::string( "GET " ) + uri
                 +   " HTTP/1.1\r\n"
                     "Host: google.de\r\n"
                     "User-Agent: Web-sniffer/1.0.31 (+http://web-sniffer.net/)\r\n"
-                    "Accept-Encoding: gzip\r\n"
                     "Accept-Charset: ISO-8859-1,UTF-8;q=0.7,*;q=0.7\r\n"
                     "Cache-Control: no\r\n"
                     "Accept-Language: de,en;q=0.7,en-us;q=0.3\r\n"
                     "Referer: http://web-sniffer.net/\r\n"
-                    "\r\n";
+                + additional_headers
+                +   "\r\n";
 
         return result;
     }
@@ -50,7 +53,7 @@ namespace
     {
         template < class T >
         explicit response_factory( const T& root )
-            : root_( root.root )
+            : root_( root.root, root.cache, root.pool )
         {
         }
 
@@ -86,30 +89,52 @@ namespace
 
     struct context
     {
-        boost::filesystem::path root;
+        boost::filesystem::path             root;
+        boost::shared_ptr< file::cache >    cache;
+        boost::shared_ptr< file::io_pool >  pool;
 
         std::ostream& logstream() const { return std::cout; }
     };
 
-    std::pair< http::http_error_code, std::string > get_file( const boost::filesystem::path& root, const char* uri )
+    std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > get_response(
+        const boost::filesystem::path& root, const char* uri,
+        const boost::shared_ptr< file::cache >& cache = boost::shared_ptr< file::cache >(),
+        const std::string& additional_headers = std::string(),
+        const boost::shared_ptr< file::io_pool >& pool = boost::shared_ptr< file::io_pool >() )
     {
         boost::asio::io_service queue;
-        const std::string       request = construct_request( uri );
+        const std::string       request = construct_request( uri, additional_headers );
         socket_t                socket( queue, request.c_str(), request.c_str() + request.size() );
 
-        context                 trait_params = { root };
+        context                 trait_params = { root, cache, pool };
         trait_t                 trait( trait_params );
 
         boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
         connection->start();
 
-        tools::run( queue );
+        // run the queue, until neither the queue, nor the pool have pending work
+        for ( bool done = false; !done; boost::this_thread::yield() )
+        {
+            const bool pool_idle = !pool || ( pool->queue_depth() == 0 && pool->active_jobs() == 0 );
+
+            queue.reset();
+            done = tools::run( queue ) == 0 && pool_idle;
+        }
 
         http::decoded_response_stream_t result = http::decode_stream< http::response_header >( socket.bin_output() );
 
         BOOST_REQUIRE_EQUAL( result.size(), 1u );
 
-        const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > >& element = result.front();
+        return result.front();
+    }
+
+    std::pair< http::http_error_code, std::string > get_file( const boost::filesystem::path& root, const char* uri,
+        const boost::shared_ptr< file::cache >& cache = boost::shared_ptr< file::cache >(),
+        const std::string& additional_headers = std::string(),
+        const boost::shared_ptr< file::io_pool >& pool = boost::shared_ptr< file::io_pool >() )
+    {
+        const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > element =
+            get_response( root, uri, cache, additional_headers, pool );
 
         return std::make_pair( element.first->code(), std::string( element.second.begin(), element.second.end() ) );
     }
@@ -118,6 +143,26 @@ namespace
     {
         return boost::filesystem::canonical( __FILE__ ).parent_path() / "root";
     }
+
+    bool delivered( const std::pair< http::http_error_code, std::string >& result, const char* expected_body )
+    {
+        return result.first == http::http_ok && result.second == expected_body;
+    }
+
+    std::vector< char > file_content( const boost::filesystem::path& file_name )
+    {
+        boost::filesystem::ifstream input( file_name, std::ios_base::in | std::ios_base::binary );
+        std::istreambuf_iterator< char > begin( input ), end;
+
+        return std::vector< char >( begin, end );
+    }
+
+    std::string header_value( const http::response_header& header, const char* name )
+    {
+        const http::header* const h = header.find_header( name );
+
+        return h ? tools::as_string( h->value() ) : std::string();
+    }
 }
 
 BOOST_AUTO_TEST_CASE( accessing_file_from_sub_root )
@@ -178,3 +223,189 @@ BOOST_AUTO_TEST_CASE( try_read_from_directory_without_index_html )
     BOOST_CHECK_EQUAL( result.second, "" );
 }
 
+BOOST_AUTO_TEST_CASE( reading_files_through_a_cache )
+{
+    const boost::shared_ptr< file::cache > cache( new file::cache( 1024 * 1024 ) );
+
+    BOOST_CHECK( delivered( get_file( test_root(), "/root.txt", cache ), "root_text" ) );
+    BOOST_CHECK( delivered( get_file( test_root(), "/b", cache ), "bhtm" ) );
+    BOOST_CHECK_EQUAL( cache->entries(), 2u );
+
+    // now served from the cache
+    BOOST_CHECK( delivered( get_file( test_root(), "/root.txt", cache ), "root_text" ) );
+    BOOST_CHECK( delivered( get_file( test_root(), "/b", cache ), "bhtm" ) );
+    BOOST_CHECK_EQUAL( cache->entries(), 2u );
+
+    // other URIs of the same files share the cached copies
+    BOOST_CHECK( delivered( get_file( test_root(), "//root.txt", cache ), "root_text" ) );
+    BOOST_CHECK( delivered( get_file( test_root(), "/a/../b/index.htm", cache ), "bhtm" ) );
+    BOOST_CHECK_EQUAL( cache->entries(), 2u );
+
+    // errors are not cached
+    BOOST_CHECK_EQUAL( get_file( test_root(), "/empty", cache ).first, http::http_not_found );
+    BOOST_CHECK_EQUAL( get_file( test_root(), "../file_test.cpp", cache ).first, http::http_forbidden );
+    BOOST_CHECK_EQUAL( cache->entries(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE( cached_files_are_conditionally_delivered )
+{
+    const boost::shared_ptr< file::cache > cache( new file::cache( 1024 * 1024 ) );
+    const boost::shared_ptr< const file::cached_file > file = cache->insert( "/root.txt", test_root() / "root.txt" );
+
+    BOOST_REQUIRE( file );
+
+    const std::pair< http::http_error_code, std::string > matching_etag =
+        get_file( test_root(), "/root.txt", cache, "If-None-Match: \"xyz\", " + file->etag() + "\r\n" );
+    BOOST_CHECK_EQUAL( matching_etag.first, http::http_not_modified );
+    BOOST_CHECK( matching_etag.second.empty() );
+
+    const std::pair< http::http_error_code, std::string > other_etag =
+        get_file( test_root(), "/root.txt", cache, "If-None-Match: \"xyz\"\r\n" );
+    BOOST_CHECK( delivered( other_etag, "root_text" ) );
+
+    const std::pair< http::http_error_code, std::string > matching_date =
+        get_file( test_root(), "/root.txt", cache, "If-Modified-Since: " + file->last_modified() + "\r\n" );
+    BOOST_CHECK_EQUAL( matching_date.first, http::http_not_modified );
+
+    const std::pair< http::http_error_code, std::string > other_date =
+        get_file( test_root(), "/root.txt", cache, "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n" );
+    BOOST_CHECK( delivered( other_date, "root_text" ) );
+}
+
+BOOST_AUTO_TEST_CASE( reading_a_single_byte_range )
+{
+    const std::pair< http::http_error_code, std::string > result =
+        get_file( test_root(), "/root.txt", boost::shared_ptr< file::cache >(), "Range: bytes=2-5\r\n" );
+
+    BOOST_CHECK_EQUAL( result.first, http::http_partial_content );
+    BOOST_CHECK_EQUAL( result.second, "ot_t" );
+
+    const std::pair< http::http_error_code, std::string > suffix =
+        get_file( test_root(), "/root.txt", boost::shared_ptr< file::cache >(), "Range: bytes=-4\r\n" );
+
+    BOOST_CHECK_EQUAL( suffix.first, http::http_partial_content );
+    BOOST_CHECK_EQUAL( suffix.second, "text" );
+}
+
+BOOST_AUTO_TEST_CASE( reading_multiple_byte_ranges )
+{
+    const std::pair< http::http_error_code, std::string > result =
+        get_file( test_root(), "/root.txt", boost::shared_ptr< file::cache >(), "Range: bytes=0-1,5-\r\n" );
+
+    BOOST_CHECK_EQUAL( result.first, http::http_partial_content );
+
+    const std::string::size_type boundary_end = result.second.find( "\r\n", 2 );
+    BOOST_REQUIRE_NE( boundary_end, std::string::npos );
+
+    const std::string boundary = result.second.substr( 2, boundary_end - 2 );
+
+    BOOST_CHECK_EQUAL( result.second,
+        "\r\n" + boundary + "\r\n"
+        "Content-Range: bytes 0-1/9\r\n"
+        "\r\n"
+        "ro"
+        "\r\n" + boundary + "\r\n"
+        "Content-Range: bytes 5-8/9\r\n"
+        "\r\n"
+        "text"
+        "\r\n" + boundary + "--\r\n" );
+}
+
+BOOST_AUTO_TEST_CASE( unsatisfiable_byte_range )
+{
+    const std::pair< http::http_error_code, std::string > result =
+        get_file( test_root(), "/root.txt", boost::shared_ptr< file::cache >(), "Range: bytes=9-\r\n" );
+
+    BOOST_CHECK_EQUAL( result.first, http::http_request_range_not_satisfiable );
+    BOOST_CHECK( result.second.empty() );
+
+    // a syntactical invalid range has to be ignored
+    BOOST_CHECK( delivered(
+        get_file( test_root(), "/root.txt", boost::shared_ptr< file::cache >(), "Range: bytes=9-5\r\n" ), "root_text" ) );
+}
+
+BOOST_AUTO_TEST_CASE( byte_range_with_if_range )
+{
+    const boost::shared_ptr< file::cache > cache( new file::cache( 1024 * 1024 ) );
+    const boost::shared_ptr< const file::cached_file > file = cache->insert( "/root.txt", test_root() / "root.txt" );
+
+    BOOST_REQUIRE( file );
+
+    const std::pair< http::http_error_code, std::string > matching_etag =
+        get_file( test_root(), "/root.txt", cache, "Range: bytes=0-3\r\nIf-Range: " + file->etag() + "\r\n" );
+    BOOST_CHECK_EQUAL( matching_etag.first, http::http_partial_content );
+    BOOST_CHECK_EQUAL( matching_etag.second, "root" );
+
+    const std::pair< http::http_error_code, std::string > matching_date =
+        get_file( test_root(), "/root.txt", cache, "Range: bytes=0-3\r\nIf-Range: " + file->last_modified() + "\r\n" );
+    BOOST_CHECK_EQUAL( matching_date.first, http::http_partial_content );
+    BOOST_CHECK_EQUAL( matching_date.second, "root" );
+
+    // changed entity: deliver the whole file
+    BOOST_CHECK( delivered(
+        get_file( test_root(), "/root.txt", cache, "Range: bytes=0-3\r\nIf-Range: \"xyz\"\r\n" ), "root_text" ) );
+}
+
+BOOST_AUTO_TEST_CASE( precompressed_file_is_delivered_if_gzip_is_accepted )
+{
+    const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > result =
+        get_response( test_root(), "/c/text.txt", boost::shared_ptr< file::cache >(), "Accept-Encoding: gzip\r\n" );
+
+    BOOST_CHECK_EQUAL( result.first->code(), http::http_ok );
+    BOOST_CHECK( result.second == file_content( test_root() / "c" / "text.txt.gz" ) );
+    BOOST_CHECK_EQUAL( header_value( *result.first, "Content-Encoding" ), "gzip" );
+    BOOST_CHECK_EQUAL( header_value( *result.first, "Vary" ), "Accept-Encoding" );
+
+    const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > not_accepted =
+        get_response( test_root(), "/c/text.txt" );
+
+    BOOST_CHECK_EQUAL( not_accepted.first->code(), http::http_ok );
+    BOOST_CHECK( not_accepted.second == file_content( test_root() / "c" / "text.txt" ) );
+    BOOST_CHECK_EQUAL( header_value( *not_accepted.first, "Content-Encoding" ), "" );
+    BOOST_CHECK_EQUAL( header_value( *not_accepted.first, "Vary" ), "Accept-Encoding" );
+}
+
+BOOST_AUTO_TEST_CASE( precompressed_file_is_delivered_from_the_cache )
+{
+    const boost::shared_ptr< file::cache > cache( new file::cache( 1024 * 1024 ) );
+
+    const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > identity =
+        get_response( test_root(), "/c/text.txt", cache );
+
+    BOOST_CHECK( identity.second == file_content( test_root() / "c" / "text.txt" ) );
+    BOOST_CHECK_EQUAL( header_value( *identity.first, "Content-Encoding" ), "" );
+    BOOST_CHECK_EQUAL( header_value( *identity.first, "Vary" ), "Accept-Encoding" );
+
+    for ( int i = 0; i != 2; ++i )
+    {
+        const std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > result =
+            get_response( test_root(), "/c/text.txt", cache, "Accept-Encoding: gzip\r\n" );
+
+        BOOST_CHECK_EQUAL( result.first->code(), http::http_ok );
+        BOOST_CHECK( result.second == file_content( test_root() / "c" / "text.txt.gz" ) );
+        BOOST_CHECK_EQUAL( header_value( *result.first, "Content-Encoding" ), "gzip" );
+        BOOST_CHECK_EQUAL( header_value( *result.first, "Vary" ), "Accept-Encoding" );
+        BOOST_CHECK_EQUAL( cache->entries(), 1u );
+    }
+}
+
+/**
+ * @test with an io_pool, files are resolved and read by the pool and added to the cache
+ */
+BOOST_AUTO_TEST_CASE( files_are_delivered_through_an_io_pool )
+{
+    const boost::shared_ptr< file::io_pool >    pool( new file::io_pool( 1, 10 ) );
+    const boost::shared_ptr< file::cache >      cache( new file::cache( 1024 * 1024 ) );
+
+    BOOST_CHECK( delivered( get_file( test_root(), "/root.txt", cache, std::string(), pool ), "root_text" ) );
+    BOOST_CHECK( delivered( get_file( test_root(), "/a", cache, std::string(), pool ), "ahtml" ) );
+    BOOST_CHECK_EQUAL( get_file( test_root(), "/nix.txt", cache, std::string(), pool ).first, http::http_not_found );
+    BOOST_CHECK_EQUAL( get_file( test_root(), "../file_test.cpp", cache, std::string(), pool ).first, http::http_forbidden );
+
+    BOOST_CHECK_EQUAL( cache->entries(), 2u );
+
+    // served from the cache, without any further job in the pool
+    const unsigned long executed = pool->jobs_executed();
+    BOOST_CHECK( delivered( get_file( test_root(), "/root.txt", cache, std::string(), pool ), "root_text" ) );
+    BOOST_CHECK_EQUAL( pool->jobs_executed(), executed );
+}
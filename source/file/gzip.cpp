@@ -0,0 +1,114 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/gzip.h"
+#include "http/request.h"
+#include "http/header.h"
+#include "http/header_names.h"
+#include "http/parser.h"
+#include "tools/split.h"
+#include <boost/filesystem/operations.hpp>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace file
+{
+    namespace {
+        // splits "coding;q=value" into the coding name and returns false, if the quality value is 0
+        bool acceptable( const tools::substring& element, tools::substring& coding )
+        {
+            tools::substring parameter;
+            if ( !tools::split_to_empty( element, ';', coding, parameter ) )
+                coding = element;
+
+            coding.trim( ' ' ).trim( '\t' );
+
+            tools::substring name, value;
+            if ( !tools::split_to_empty( parameter, '=', name, value ) )
+                return true;
+
+            name.trim( ' ' ).trim( '\t' );
+            value.trim( ' ' ).trim( '\t' );
+
+            // "0", "0.0", "0.000" and so on: nothing left, after removing zeros and the dot
+            value.trim( '0' ).trim( '.' );
+
+            return !( name == "q" && value.empty() );
+        }
+    }
+
+    bool gzip_accepted( const http::request_header& request )
+    {
+        const http::header* const accept_encoding = request.find_header( http::accept_encoding_header );
+
+        if ( !accept_encoding )
+            return false;
+
+        bool                gzip_found = false;
+        bool                accepted   = false;
+        tools::substring    list       = accept_encoding->value();
+
+        for ( bool last = false; !last; )
+        {
+            tools::substring element, rest;
+            last = !tools::split_to_empty( list, ',', element, rest );
+
+            if ( last )
+                element = list;
+
+            tools::substring coding;
+            const bool       acceptable_coding = acceptable( element, coding );
+
+            if ( http::strcasecmp( coding.begin(), coding.end(), "gzip" ) == 0
+              || http::strcasecmp( coding.begin(), coding.end(), "x-gzip" ) == 0 )
+            {
+                gzip_found = true;
+                accepted   = acceptable_coding;
+            }
+            else if ( coding == "*" && !gzip_found )
+            {
+                accepted   = acceptable_coding;
+            }
+
+            list = rest;
+        }
+
+        return accepted;
+    }
+
+    std::vector< char > gzip( const char* begin, const char* end )
+    {
+        z_stream stream = z_stream();
+
+        // window bits + 16 selects the gzip format
+        if ( deflateInit2( &stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+            throw std::runtime_error( "gzip: unable to initialize zlib" );
+
+        std::vector< char > result( deflateBound( &stream, static_cast< uLong >( end - begin ) ) );
+
+        stream.next_in   = reinterpret_cast< Bytef* >( const_cast< char* >( begin ) );
+        stream.avail_in  = static_cast< uInt >( end - begin );
+        stream.next_out  = reinterpret_cast< Bytef* >( &result[ 0 ] );
+        stream.avail_out = static_cast< uInt >( result.size() );
+
+        const int rc = deflate( &stream, Z_FINISH );
+        result.resize( stream.total_out );
+        deflateEnd( &stream );
+
+        if ( rc != Z_STREAM_END )
+            throw std::runtime_error( "gzip: unable to compress" );
+
+        return result;
+    }
+
+    boost::filesystem::path gzip_sibling( const boost::filesystem::path& file_name )
+    {
+        boost::filesystem::path sibling = file_name;
+        sibling += ".gz";
+
+        boost::system::error_code ec;
+
+        return is_regular_file( sibling, ec ) ? sibling : boost::filesystem::path();
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_FILE_GZIP_H_
+#define SIOUX_FILE_GZIP_H_
+
+#include <boost/filesystem/path.hpp>
+#include <vector>
+
+namespace http {
+    class request_header;
+}
+
+namespace file
+{
+    /**
+     * @brief returns true, if the Accept-Encoding header of the given request accepts the gzip content coding
+     *
+     * A missing Accept-Encoding header is treated as "identity only". Codings with a quality value of 0 are
+     * treated as not acceptable.
+     */
+    bool gzip_accepted( const http::request_header& request );
+
+    /**
+     * @brief compresses the given data into the gzip format
+     * @exception std::runtime_error on failure of the underlying zlib
+     */
+    std::vector< char > gzip( const char* begin, const char* end );
+
+    /**
+     * @brief returns the name of a precompressed version of the given file (file name + ".gz"), if such a file
+     *        exists. Otherwise an empty path is returned.
+     */
+    boost::filesystem::path gzip_sibling( const boost::filesystem::path& file_name );
+}
+
+#endif /* SIOUX_FILE_GZIP_H_ */
@@ -0,0 +1,84 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/gzip.h"
+#include "http/request.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <zlib.h>
+
+namespace
+{
+    bool accepted( const std::string& accept_encoding )
+    {
+        const std::string request_text =
+            "GET / HTTP/1.1\r\n"
+            "Host: google.de\r\n"
+          + accept_encoding
+          + "\r\n";
+
+        const http::request_header request( request_text.c_str() );
+        BOOST_REQUIRE_EQUAL( request.state(), http::request_header::ok );
+
+        return file::gzip_accepted( request );
+    }
+
+    std::vector< char > gunzip( const std::vector< char >& input )
+    {
+        z_stream stream = z_stream();
+        BOOST_REQUIRE_EQUAL( inflateInit2( &stream, 15 + 16 ), Z_OK );
+
+        std::vector< char > result( 64 * 1024 );
+
+        stream.next_in   = reinterpret_cast< Bytef* >( const_cast< char* >( &input[ 0 ] ) );
+        stream.avail_in  = static_cast< uInt >( input.size() );
+        stream.next_out  = reinterpret_cast< Bytef* >( &result[ 0 ] );
+        stream.avail_out = static_cast< uInt >( result.size() );
+
+        BOOST_CHECK_EQUAL( inflate( &stream, Z_FINISH ), Z_STREAM_END );
+        result.resize( stream.total_out );
+        inflateEnd( &stream );
+
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( gzip_accepted_by_accept_encoding )
+{
+    BOOST_CHECK( !accepted( "" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: gzip\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: GZIP\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: x-gzip\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: gzip, deflate\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: deflate, gzip;q=0.5\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: deflate ,gzip ; q=1.0\r\n" ) );
+    BOOST_CHECK( accepted( "Accept-Encoding: *\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: identity\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: deflate\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: gzip;q=0\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: gzip;q=0.000\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: *, gzip;q=0\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: gzip;q=0, *\r\n" ) );
+    BOOST_CHECK( !accepted( "Accept-Encoding: *;q=0\r\n" ) );
+}
+
+BOOST_AUTO_TEST_CASE( gzip_compression )
+{
+    const std::string           text( 1000, 'a' );
+    const std::vector< char >   compressed = file::gzip( text.data(), text.data() + text.size() );
+
+    BOOST_CHECK_LT( compressed.size(), text.size() );
+
+    const std::vector< char >   decompressed = gunzip( compressed );
+    BOOST_CHECK_EQUAL( std::string( decompressed.begin(), decompressed.end() ), text );
+}
+
+BOOST_AUTO_TEST_CASE( find_precompressed_sibling )
+{
+    const boost::filesystem::path root = boost::filesystem::canonical( __FILE__ ).parent_path() / "root";
+
+    BOOST_CHECK_EQUAL( file::gzip_sibling( root / "c" / "text.txt" ), root / "c" / "text.txt.gz" );
+    BOOST_CHECK( file::gzip_sibling( root / "root.txt" ).empty() );
+}
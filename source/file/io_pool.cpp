@@ -0,0 +1,130 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/io_pool.h"
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace file
+{
+    io_pool::io_pool( unsigned number_of_threads, std::size_t max_queue_depth )
+        : mutex_()
+        , condition_()
+        , shutdown_( false )
+        , max_queue_depth_( max_queue_depth )
+        , jobs_()
+        , peak_queue_depth_( 0 )
+        , active_jobs_( 0 )
+        , jobs_executed_( 0 )
+        , jobs_rejected_( 0 )
+        , threads_()
+    {
+        for ( ; number_of_threads; --number_of_threads )
+            threads_.create_thread( boost::bind( &io_pool::execute_jobs, this ) );
+    }
+
+    io_pool::~io_pool()
+    {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            shutdown_ = true;
+        }
+
+        condition_.notify_all();
+        threads_.join_all();
+    }
+
+    bool io_pool::post( const boost::function< void() >& job )
+    {
+        return post( job, true );
+    }
+
+    bool io_pool::post_continuation( const boost::function< void() >& job )
+    {
+        return post( job, false );
+    }
+
+    bool io_pool::post( const boost::function< void() >& job, bool limited )
+    {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            if ( shutdown_ || threads_.size() == 0 || ( limited && jobs_.size() >= max_queue_depth_ ) )
+            {
+                ++jobs_rejected_;
+                return false;
+            }
+
+            jobs_.push_back( job );
+            peak_queue_depth_ = std::max( peak_queue_depth_, jobs_.size() );
+        }
+
+        condition_.notify_one();
+
+        return true;
+    }
+
+    std::size_t io_pool::queue_depth() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return jobs_.size();
+    }
+
+    std::size_t io_pool::peak_queue_depth() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return peak_queue_depth_;
+    }
+
+    std::size_t io_pool::active_jobs() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return active_jobs_;
+    }
+
+    unsigned long io_pool::jobs_executed() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return jobs_executed_;
+    }
+
+    unsigned long io_pool::jobs_rejected() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return jobs_rejected_;
+    }
+
+    void io_pool::execute_jobs()
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        for ( ;; )
+        {
+            while ( !shutdown_ && jobs_.empty() )
+                condition_.wait( lock );
+
+            if ( jobs_.empty() )
+                return;
+
+            boost::function< void() > job;
+            job.swap( jobs_.front() );
+            jobs_.pop_front();
+            ++active_jobs_;
+
+            lock.unlock();
+
+            try
+            {
+                job();
+            }
+            catch ( ... )
+            {
+            }
+
+            lock.lock();
+            --active_jobs_;
+            ++jobs_executed_;
+        }
+    }
+}
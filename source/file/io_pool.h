@@ -0,0 +1,107 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_FILE_IO_POOL_H_
+#define SIOUX_FILE_IO_POOL_H_
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+
+namespace file
+{
+    /**
+     * @brief bounded pool of threads, that executes blocking file system operations
+     *
+     * Blocking file system operations (open, stat, read) executed on an io_service thread stall every other
+     * connection served by that thread. Posting them into an io_pool keeps the io_service threads free. The
+     * posted jobs are responsible to deliver their results back to the io_service.
+     *
+     * The number of queued jobs is limited. If the limit is reached, post() refuses to take new jobs, so the
+     * caller can decide how to handle this overload condition. Jobs, that continue work, that was already accepted,
+     * are queued with post_continuation(), which ignores the limit.
+     *
+     * All functions are thread safe.
+     */
+    class io_pool : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief starts the given number of threads
+         *
+         * @param number_of_threads the number of threads executing jobs
+         * @param max_queue_depth the maximum number of jobs, that are queued and not jet executed
+         */
+        io_pool( unsigned number_of_threads, std::size_t max_queue_depth );
+
+        /**
+         * @brief executes the remaining queued jobs and joins all threads
+         */
+        ~io_pool();
+
+        /**
+         * @brief queues the job for execution by one of the pools threads
+         *
+         * @return false, if the maximum queue depth is reached and the job was not queued
+         */
+        bool post( const boost::function< void() >& job );
+
+        /**
+         * @brief queues the job for execution by one of the pools threads, even if the maximum queue depth is reached
+         *
+         * Intended for the next step of a job, that was accepted by post() before, like reading the next chunk of a
+         * file, that is being delivered. Refusing such a job would break off work, that was already started.
+         *
+         * @return false, if the pool has no threads or is being destroyed and the job was not queued
+         */
+        bool post_continuation( const boost::function< void() >& job );
+
+        /**
+         * @brief the number of jobs currently queued, but not jet started
+         */
+        std::size_t queue_depth() const;
+
+        /**
+         * @brief the largest number of jobs that where queued at the same time
+         */
+        std::size_t peak_queue_depth() const;
+
+        /**
+         * @brief the number of jobs, that are currently executed
+         */
+        std::size_t active_jobs() const;
+
+        /**
+         * @brief the number of jobs executed so far
+         */
+        unsigned long jobs_executed() const;
+
+        /**
+         * @brief the number of jobs, that where refused, because the maximum queue depth was reached
+         */
+        unsigned long jobs_rejected() const;
+
+    private:
+        void execute_jobs();
+        bool post( const boost::function< void() >& job, bool limited );
+
+        mutable boost::mutex                        mutex_;
+        boost::condition_variable                   condition_;
+        bool                                        shutdown_;
+
+        const std::size_t                           max_queue_depth_;
+        std::deque< boost::function< void() > >     jobs_;
+        std::size_t                                 peak_queue_depth_;
+        std::size_t                                 active_jobs_;
+        unsigned long                               jobs_executed_;
+        unsigned long                               jobs_rejected_;
+
+        boost::thread_group                         threads_;
+    };
+}
+
+#endif /* SIOUX_FILE_IO_POOL_H_ */
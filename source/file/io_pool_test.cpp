@@ -0,0 +1,142 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/io_pool.h"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace
+{
+    // counts calls and blocks all calls until release() is called
+    class blocking_job
+    {
+    public:
+        blocking_job() : released_( false ), calls_( 0 ) {}
+
+        void operator()()
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            ++calls_;
+            condition_.notify_all();
+
+            while ( !released_ )
+                condition_.wait( lock );
+        }
+
+        void release()
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            released_ = true;
+            condition_.notify_all();
+        }
+
+        void wait_for_calls( unsigned calls )
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            while ( calls_ < calls )
+                condition_.wait( lock );
+        }
+
+        unsigned calls() const
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            return calls_;
+        }
+
+    private:
+        mutable boost::mutex        mutex_;
+        boost::condition_variable   condition_;
+        bool                        released_;
+        unsigned                    calls_;
+    };
+
+    void increment( boost::mutex& mutex, int& counter )
+    {
+        boost::mutex::scoped_lock lock( mutex );
+        ++counter;
+    }
+}
+
+/**
+ * @test all posted jobs are executed, at the latest when the pool is destroyed
+ */
+BOOST_AUTO_TEST_CASE( all_jobs_are_executed )
+{
+    boost::mutex    mutex;
+    int             counter = 0;
+
+    {
+        file::io_pool pool( 3, 1000 );
+
+        for ( int i = 0; i != 100; ++i )
+            BOOST_CHECK( pool.post( boost::bind( &increment, boost::ref( mutex ), boost::ref( counter ) ) ) );
+    }
+
+    BOOST_CHECK_EQUAL( counter, 100 );
+}
+
+/**
+ * @test jobs are refused, when the maximum queue depth is reached
+ */
+BOOST_AUTO_TEST_CASE( queue_depth_is_limited )
+{
+    blocking_job    job;
+    file::io_pool   pool( 1, 2 );
+
+    BOOST_CHECK( pool.post( boost::ref( job ) ) );
+    job.wait_for_calls( 1 );
+    BOOST_CHECK_EQUAL( pool.active_jobs(), 1u );
+
+    BOOST_CHECK( pool.post( boost::ref( job ) ) );
+    BOOST_CHECK( pool.post( boost::ref( job ) ) );
+    BOOST_CHECK( !pool.post( boost::ref( job ) ) );
+
+    BOOST_CHECK_EQUAL( pool.queue_depth(), 2u );
+    BOOST_CHECK_EQUAL( pool.peak_queue_depth(), 2u );
+    BOOST_CHECK_EQUAL( pool.jobs_rejected(), 1u );
+    BOOST_CHECK_EQUAL( pool.jobs_executed(), 0u );
+
+    job.release();
+    job.wait_for_calls( 3 );
+}
+
+/**
+ * @test continuations of accepted jobs are queued, even if the maximum queue depth is reached
+ */
+BOOST_AUTO_TEST_CASE( continuations_are_not_limited )
+{
+    blocking_job    job;
+    file::io_pool   pool( 1, 1 );
+
+    BOOST_CHECK( pool.post( boost::ref( job ) ) );
+    job.wait_for_calls( 1 );
+
+    BOOST_CHECK( pool.post( boost::ref( job ) ) );
+    BOOST_CHECK( !pool.post( boost::ref( job ) ) );
+    BOOST_CHECK( pool.post_continuation( boost::ref( job ) ) );
+
+    BOOST_CHECK_EQUAL( pool.queue_depth(), 2u );
+    BOOST_CHECK_EQUAL( pool.jobs_rejected(), 1u );
+
+    job.release();
+    job.wait_for_calls( 3 );
+}
+
+/**
+ * @test a pool without threads, refuses all jobs
+ */
+BOOST_AUTO_TEST_CASE( pool_without_threads_refuses_jobs )
+{
+    blocking_job    job;
+    file::io_pool   pool( 0, 10 );
+
+    BOOST_CHECK( !pool.post( boost::ref( job ) ) );
+    BOOST_CHECK( !pool.post_continuation( boost::ref( job ) ) );
+    BOOST_CHECK_EQUAL( pool.jobs_rejected(), 2u );
+    BOOST_CHECK_EQUAL( job.calls(), 0u );
+}
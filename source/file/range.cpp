@@ -0,0 +1,139 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/range.h"
+#include "http/parser.h"
+#include "tools/split.h"
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+namespace file
+{
+    const std::size_t max_byte_ranges = 16;
+
+    boost::uintmax_t byte_range::size() const
+    {
+        return last - first + 1;
+    }
+
+    bool byte_range::operator==( const byte_range& rhs ) const
+    {
+        return first == rhs.first && last == rhs.last;
+    }
+
+    std::ostream& operator<<( std::ostream& out, const byte_range& range )
+    {
+        return out << range.first << '-' << range.last;
+    }
+
+    namespace {
+        bool first_less( const byte_range& lhs, const byte_range& rhs )
+        {
+            return lhs.first < rhs.first;
+        }
+
+        // parses a single byte-range-spec or suffix-byte-range-spec. Returns false on a syntax error.
+        bool parse_range( tools::substring spec, boost::uintmax_t entity_size, std::vector< byte_range >& ranges )
+        {
+            spec.trim( ' ' ).trim( '\t' );
+
+            tools::substring first, last;
+            if ( !tools::split_to_empty( spec, '-', first, last ) )
+                return false;
+
+            boost::uintmax_t first_pos = 0, last_pos = 0;
+
+            if ( first.empty() )
+            {
+                // suffix range: the last n bytes
+                boost::uintmax_t suffix_length = 0;
+                if ( !http::parse_number( last.begin(), last.end(), suffix_length ) )
+                    return false;
+
+                if ( suffix_length == 0 || entity_size == 0 )
+                    return true;
+
+                first_pos = entity_size - std::min( suffix_length, entity_size );
+                last_pos  = entity_size - 1;
+            }
+            else
+            {
+                if ( !http::parse_number( first.begin(), first.end(), first_pos ) )
+                    return false;
+
+                if ( last.empty() )
+                {
+                    last_pos = entity_size - 1;
+                }
+                else
+                {
+                    if ( !http::parse_number( last.begin(), last.end(), last_pos ) || last_pos < first_pos )
+                        return false;
+
+                    last_pos = std::min( last_pos, entity_size - 1 );
+                }
+
+                if ( first_pos >= entity_size )
+                    return true;
+            }
+
+            const byte_range range = { first_pos, last_pos };
+            ranges.push_back( range );
+
+            return true;
+        }
+    }
+
+    bool parse_byte_ranges( const tools::substring& header_value, boost::uintmax_t entity_size,
+        std::vector< byte_range >& ranges )
+    {
+        static const char bytes_unit[] = "bytes=";
+
+        ranges.clear();
+
+        if ( header_value.size() < std::strlen( bytes_unit )
+          || http::strcasecmp( header_value.begin(), header_value.begin() + std::strlen( bytes_unit ), bytes_unit ) != 0 )
+            return false;
+
+        tools::substring    specs( header_value.begin() + std::strlen( bytes_unit ), header_value.end() );
+        std::size_t         count = 0;
+
+        for ( bool last = false; !last; ++count )
+        {
+            tools::substring spec, rest;
+            last = !tools::split_to_empty( specs, ',', spec, rest );
+
+            if ( last )
+                spec = specs;
+
+            if ( count == max_byte_ranges || !parse_range( spec, entity_size, ranges ) )
+            {
+                ranges.clear();
+                return false;
+            }
+
+            specs = rest;
+        }
+
+        std::sort( ranges.begin(), ranges.end(), first_less );
+
+        std::vector< byte_range > merged;
+        for ( std::vector< byte_range >::const_iterator range = ranges.begin(); range != ranges.end(); ++range )
+        {
+            if ( !merged.empty() && range->first <= merged.back().last + 1 )
+            {
+                merged.back().last = std::max( merged.back().last, range->last );
+            }
+            else
+            {
+                merged.push_back( *range );
+            }
+        }
+
+        ranges.swap( merged );
+
+        return true;
+    }
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_FILE_RANGE_H_
+#define SIOUX_FILE_RANGE_H_
+
+#include "tools/substring.h"
+#include <boost/cstdint.hpp>
+#include <iosfwd>
+#include <vector>
+
+namespace file
+{
+    /**
+     * @brief a range of bytes in an entity, with both, first and last being inclusive
+     */
+    struct byte_range
+    {
+        boost::uintmax_t    first;
+        boost::uintmax_t    last;
+
+        boost::uintmax_t size() const;
+
+        bool operator==( const byte_range& rhs ) const;
+    };
+
+    std::ostream& operator<<( std::ostream& out, const byte_range& range );
+
+    /**
+     * @brief parses the value of a Range header
+     *
+     * Ranges that start behind the end of the entity are dropped, ranges that end behind the end of the entity are
+     * shortened, suffix ranges are converted to absolute ranges. The remaining ranges are sorted and overlapping or
+     * adjacent ranges are merged.
+     *
+     * @param header_value the value of the Range header, for example "bytes=0-499,-500"
+     * @param entity_size the size of the entity, the ranges are applied to
+     * @param ranges the satisfiable ranges. If the function returns true and ranges is empty, none of the ranges
+     *        is satisfiable.
+     *
+     * @return false, if the header is syntactical invalid or contains more than max_byte_ranges ranges. In this case,
+     *         the header has to be ignored.
+     */
+    bool parse_byte_ranges( const tools::substring& header_value, boost::uintmax_t entity_size,
+        std::vector< byte_range >& ranges );
+
+    /**
+     * @brief the maximum number of ranges accepted by parse_byte_ranges()
+     */
+    extern const std::size_t max_byte_ranges;
+}
+
+#endif /* SIOUX_FILE_RANGE_H_ */
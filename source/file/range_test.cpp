@@ -0,0 +1,91 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "file/range.h"
+#include "tools/substring.h"
+
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+
+namespace
+{
+    std::vector< file::byte_range > parse( const char* header, boost::uintmax_t size, bool expected_result = true )
+    {
+        std::vector< file::byte_range > result;
+        BOOST_CHECK_EQUAL( file::parse_byte_ranges( tools::substring( header, header + std::strlen( header ) ),
+            size, result ), expected_result );
+
+        return result;
+    }
+
+    std::vector< file::byte_range > ranges( boost::uintmax_t first, boost::uintmax_t last )
+    {
+        const file::byte_range range = { first, last };
+        return std::vector< file::byte_range >( 1u, range );
+    }
+
+    std::vector< file::byte_range > ranges( boost::uintmax_t first1, boost::uintmax_t last1,
+        boost::uintmax_t first2, boost::uintmax_t last2 )
+    {
+        std::vector< file::byte_range > result = ranges( first1, last1 );
+        const file::byte_range range = { first2, last2 };
+        result.push_back( range );
+
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( parse_single_byte_ranges )
+{
+    BOOST_CHECK( parse( "bytes=0-499", 10000 ) == ranges( 0, 499 ) );
+    BOOST_CHECK( parse( "bytes=500-999", 10000 ) == ranges( 500, 999 ) );
+    BOOST_CHECK( parse( "bytes=-500", 10000 ) == ranges( 9500, 9999 ) );
+    BOOST_CHECK( parse( "bytes=9500-", 10000 ) == ranges( 9500, 9999 ) );
+    BOOST_CHECK( parse( "bytes=0-0", 10000 ) == ranges( 0, 0 ) );
+    BOOST_CHECK( parse( "Bytes = 1-2", 10000, false ).empty() );
+    BOOST_CHECK( parse( "BYTES=1-2", 10000 ) == ranges( 1, 2 ) );
+}
+
+BOOST_AUTO_TEST_CASE( byte_ranges_are_limited_to_the_entity )
+{
+    BOOST_CHECK( parse( "bytes=500-20000", 1000 ) == ranges( 500, 999 ) );
+    BOOST_CHECK( parse( "bytes=-20000", 1000 ) == ranges( 0, 999 ) );
+
+    // not satisfiable
+    BOOST_CHECK( parse( "bytes=1000-", 1000 ).empty() );
+    BOOST_CHECK( parse( "bytes=1000-2000", 1000 ).empty() );
+    BOOST_CHECK( parse( "bytes=-0", 1000 ).empty() );
+    BOOST_CHECK( parse( "bytes=0-10", 0 ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( parse_multiple_byte_ranges )
+{
+    BOOST_CHECK( parse( "bytes=0-99, 200-299", 10000 ) == ranges( 0, 99, 200, 299 ) );
+    BOOST_CHECK( parse( "bytes=200-299,0-99", 10000 ) == ranges( 0, 99, 200, 299 ) );
+    BOOST_CHECK( parse( "bytes=0-99,-100", 1000 ) == ranges( 0, 99, 900, 999 ) );
+
+    // unsatisfiable ranges are dropped
+    BOOST_CHECK( parse( "bytes=0-99,5000-6000", 1000 ) == ranges( 0, 99 ) );
+}
+
+BOOST_AUTO_TEST_CASE( overlapping_byte_ranges_are_merged )
+{
+    BOOST_CHECK( parse( "bytes=0-99,50-199", 10000 ) == ranges( 0, 199 ) );
+    BOOST_CHECK( parse( "bytes=100-199,0-99", 10000 ) == ranges( 0, 199 ) );
+    BOOST_CHECK( parse( "bytes=0-99,10-20,200-", 1000 ) == ranges( 0, 99, 200, 999 ) );
+}
+
+BOOST_AUTO_TEST_CASE( invalid_byte_ranges )
+{
+    parse( "", 1000, false );
+    parse( "bytes", 1000, false );
+    parse( "bytes=", 1000, false );
+    parse( "bytes=-", 1000, false );
+    parse( "bytes=a-b", 1000, false );
+    parse( "bytes=10-5", 1000, false );
+    parse( "bytes=1-2,", 1000, false );
+    parse( "items=1-2", 1000, false );
+    parse( "bytes=1-2,3-4,5-6,7-8,9-10,11-12,13-14,15-16,17-18,19-20,21-22,23-24,25-26,27-28,29-30,31-32,33-34",
+        1000, false );
+}
@@ -5,19 +5,54 @@
 #ifndef SIOUX_FILE_RESPONSE_H_
 #define SIOUX_FILE_RESPONSE_H_
 
+#include "file/cache.h"
+#include "file/range.h"
+#include "file/io_pool.h"
 #include "server/response.h"
+#include "http/header_names.h"
+#include "http/http.h"
+#include "http/response_head.h"
 #include "tools/asstring.h"
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/asio/buffer.hpp>
 #include <boost/bind.hpp>
-#include <iterator>
+#include <boost/function.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <stdexcept>
 
 namespace file
 {
     /**
-     * @brief very simple implementation of delivering a local file
+     * @brief function, that maps a request to the file to be delivered
+     *
+     * If the file can be determined, the function returns true, sets file_name and adds header lines to
+     * additional_headers, that have to be part of the response. If the file was read into a cache, the function
+     * can set cached instead, then the response is delivered from memory. Otherwise, the function returns false
+     * and sets error to the error code, that should be reported.
+     */
+    typedef boost::function< bool ( const http::request_header& request, boost::filesystem::path& file_name,
+        std::string& additional_headers, boost::shared_ptr< const cached_file >& cached,
+        http::http_error_code& error ) > file_resolver;
+
+    /**
+     * @brief delivers a local file
+     *
+     * The file is not read into memory as a whole, but streamed to the connection in chunks of a fixed size.
+     * A new chunk is read, when the previous chunk was written. So the memory used per download is bounded by
+     * the chunk size, independent from the size of the delivered file.
+     *
+     * If the response is constructed with the request, a Range header is honored (with respect to an If-Range
+     * header) and only the requested ranges of the file are delivered. Multiple ranges are delivered as
+     * multipart/byteranges.
+     *
+     * If an io_pool is given, all blocking file system operations (resolving the file name, opening and reading
+     * the file) are performed by the pool and the results are passed back to the connections io_service. If the
+     * pools queue is full, when the response is started, the request is answered with "503 Service Unavailable".
+     * Reading the following chunks is queued regardless of the queue depth, so that a started delivery is not
+     * broken off. The io_service threads never block on the file system.
      */
     template < class Connection >
     class response :
@@ -25,7 +60,33 @@ namespace file
         public server::async_response
     {
     public:
-        response( const boost::shared_ptr< Connection >&, const boost::filesystem::path& file_to_deliver );
+        /**
+         * @brief default size of the buffer used to read the file chunk by chunk
+         */
+        static const std::size_t default_chunk_size = 64 * 1024;
+
+        response( const boost::shared_ptr< Connection >& connection, const boost::filesystem::path& file_to_deliver,
+            std::size_t chunk_size = default_chunk_size );
+
+        /**
+         * @param additional_headers header lines, including the trailing CRLF, that are added to the response header
+         * @param pool optional pool to perform blocking file system operations
+         */
+        response( const boost::shared_ptr< Connection >& connection,
+            const boost::shared_ptr< const http::request_header >& request,
+            const boost::filesystem::path& file_to_deliver, const std::string& additional_headers = std::string(),
+            const boost::shared_ptr< io_pool >& pool = boost::shared_ptr< io_pool >(),
+            std::size_t chunk_size = default_chunk_size );
+
+        /**
+         * @brief constructs a response, that determines the file to deliver by calling the given resolver, once
+         *        the response is started.
+         */
+        response( const boost::shared_ptr< Connection >& connection,
+            const boost::shared_ptr< const http::request_header >& request,
+            const file_resolver& resolver,
+            const boost::shared_ptr< io_pool >& pool = boost::shared_ptr< io_pool >(),
+            std::size_t chunk_size = default_chunk_size );
 
         void data_written(
             const boost::system::error_code&    error,
@@ -34,81 +95,431 @@ namespace file
     private:
         virtual void start();
 
-        const boost::shared_ptr< Connection >       connection_;
-        const boost::filesystem::path               path_;
-        std::vector< char >                         buffer_;
-        std::string                                 header_;
-        std::vector< boost::asio::const_buffer >    result_;
+        typedef void ( response::*operation_t )();
+
+        // performs the operation in the pool, if there is one and calls completion on the connections io_service,
+        // once the operation is done. If the pool refuses the operation, completion is called with failed_ set.
+        void execute( operation_t operation, operation_t completion );
+        void execute_in_pool( operation_t operation, operation_t completion );
+
+        // blocking operations and their completion handlers
+        void open_file();
+        void file_opened();
+        void read_next();
+        void write_next();
+
+        // fills ranges_ and partial_. Returns false, if the requested ranges are not satisfiable.
+        bool select_ranges( boost::uintmax_t size, const std::string& etag, const std::string& last_modified );
+
+        std::string part_header( const byte_range& range ) const;
 
-        typedef server::report_error_guard< Connection > response_guard;
+        // adds the next buffers to be written to result_. If there is nothing left to write, result_ is unchanged.
+        void add_next_buffers();
+
+        // reads the next chunk from input_ into buffer_ and returns the number of bytes read
+        std::size_t read_chunk();
+
+        const boost::shared_ptr< Connection >                   connection_;
+        const boost::shared_ptr< const http::request_header >   request_;
+        const file_resolver                                     resolver_;
+        const boost::shared_ptr< io_pool >                      pool_;
+        boost::filesystem::path                                 path_;
+        std::string                                             additional_headers_;
+        boost::shared_ptr< const cached_file >                  cached_;
+        char                                                    date_[ http::date_header_size ];
+        bool                                                    failed_;
+        http::http_error_code                                   error_;
+        boost::filesystem::ifstream                             input_;
+        boost::uintmax_t                                        file_size_;
+        std::vector< byte_range >                               ranges_;
+        bool                                                    partial_;
+        std::size_t                                             next_range_;
+        boost::uintmax_t                                        remaining_;
+        bool                                                    multipart_;
+        std::string                                             boundary_;
+        bool                                                    trailer_written_;
+        std::vector< char >                                     buffer_;
+        http::response_head                                     header_;
+        std::string                                             part_header_;
+        std::vector< boost::asio::const_buffer >                result_;
+
+        typedef server::report_error_guard< Connection >        response_guard;
+        typedef server::close_connection_guard< Connection >    close_guard;
     };
 
     // implementation
     template < class Connection >
     response< Connection >::response( const boost::shared_ptr< Connection >& connection,
-                                      const boost::filesystem::path&         file_to_deliver )
+                                      const boost::filesystem::path&         file_to_deliver,
+                                      std::size_t                            chunk_size )
         : connection_( connection )
+        , request_()
+        , resolver_()
+        , pool_()
         , path_( file_to_deliver )
-        , buffer_()
+        , additional_headers_()
+        , cached_()
+        , failed_( true )
+        , error_( http::http_not_found )
+        , input_()
+        , file_size_( 0 )
+        , ranges_()
+        , partial_( false )
+        , next_range_( 0 )
+        , remaining_( 0 )
+        , multipart_( false )
+        , boundary_()
+        , trailer_written_( false )
+        , buffer_( std::max< std::size_t >( chunk_size, 1u ) )
         , header_()
+        , part_header_()
         , result_()
     {
     }
 
     template < class Connection >
-    void response< Connection >::data_written(
-        const boost::system::error_code&    error,
-        std::size_t                         bytes_transferred)
+    response< Connection >::response( const boost::shared_ptr< Connection >&                  connection,
+                                      const boost::shared_ptr< const http::request_header >&  request,
+                                      const boost::filesystem::path&                          file_to_deliver,
+                                      const std::string&                                      additional_headers,
+                                      const boost::shared_ptr< io_pool >&                     pool,
+                                      std::size_t                                             chunk_size )
+        : connection_( connection )
+        , request_( request )
+        , resolver_()
+        , pool_( pool )
+        , path_( file_to_deliver )
+        , additional_headers_( additional_headers )
+        , cached_()
+        , failed_( true )
+        , error_( http::http_not_found )
+        , input_()
+        , file_size_( 0 )
+        , ranges_()
+        , partial_( false )
+        , next_range_( 0 )
+        , remaining_( 0 )
+        , multipart_( false )
+        , boundary_()
+        , trailer_written_( false )
+        , buffer_( std::max< std::size_t >( chunk_size, 1u ) )
+        , header_()
+        , part_header_()
+        , result_()
     {
-        if ( !error )
+    }
+
+    template < class Connection >
+    response< Connection >::response( const boost::shared_ptr< Connection >&                  connection,
+                                      const boost::shared_ptr< const http::request_header >&  request,
+                                      const file_resolver&                                    resolver,
+                                      const boost::shared_ptr< io_pool >&                     pool,
+                                      std::size_t                                             chunk_size )
+        : connection_( connection )
+        , request_( request )
+        , resolver_( resolver )
+        , pool_( pool )
+        , path_()
+        , additional_headers_()
+        , cached_()
+        , failed_( true )
+        , error_( http::http_not_found )
+        , input_()
+        , file_size_( 0 )
+        , ranges_()
+        , partial_( false )
+        , next_range_( 0 )
+        , remaining_( 0 )
+        , multipart_( false )
+        , boundary_()
+        , trailer_written_( false )
+        , buffer_( std::max< std::size_t >( chunk_size, 1u ) )
+        , header_()
+        , part_header_()
+        , result_()
+    {
+    }
+
+    template < class Connection >
+    void response< Connection >::execute( operation_t operation, operation_t completion )
+    {
+        if ( !pool_ )
         {
-            connection_->response_completed( *this );
+            ( this->*operation )();
+            ( this->*completion )();
+
+            return;
         }
-        else
+
+        const boost::function< void() > job =
+            boost::bind( &response::execute_in_pool, this->shared_from_this(), operation, completion );
+
+        // new responses are refused, if the pool is overloaded, but started deliveries are continued
+        const bool queued = operation == &response::open_file
+            ? pool_->post( job )
+            : pool_->post_continuation( job );
+
+        if ( !queued )
+        {
+            failed_ = true;
+            error_  = http::http_service_unavailable;
+            ( this->*completion )();
+        }
+    }
+
+    template < class Connection >
+    void response< Connection >::execute_in_pool( operation_t operation, operation_t completion )
+    {
+        ( this->*operation )();
+        connection_->socket().get_io_service().post( boost::bind( completion, this->shared_from_this() ) );
+    }
+
+    template < class Connection >
+    bool response< Connection >::select_ranges( boost::uintmax_t size, const std::string& etag,
+        const std::string& last_modified )
+    {
+        ranges_.clear();
+
+        const http::header* const range = request_ ? request_->find_header( http::range_header ) : 0;
+
+        if ( range )
+        {
+            // the ranges apply only, if the entity is still the one, the client has a part of
+            const http::header* const if_range = request_->find_header( http::if_range_header );
+
+            if ( !if_range || if_range->value() == etag.c_str() || if_range->value() == last_modified.c_str() )
+            {
+                if ( parse_byte_ranges( range->value(), size, ranges_ ) )
+                {
+                    partial_ = true;
+                    return !ranges_.empty();
+                }
+            }
+        }
+
+        if ( size != 0 )
+        {
+            const byte_range all = { 0, size - 1 };
+            ranges_.push_back( all );
+        }
+
+        return true;
+    }
+
+    template < class Connection >
+    std::string response< Connection >::part_header( const byte_range& range ) const
+    {
+        return "\r\n--" + boundary_ + "\r\n"
+            + http::content_range_header + ": bytes " + tools::as_string( range ) + "/" + tools::as_string( file_size_ )
+            + "\r\n\r\n";
+    }
+
+    template < class Connection >
+    void response< Connection >::add_next_buffers()
+    {
+        if ( remaining_ == 0 && next_range_ != ranges_.size() )
+        {
+            const byte_range& range = ranges_[ next_range_ ];
+            ++next_range_;
+
+            input_.clear();
+            input_.seekg( static_cast< std::streamoff >( range.first ) );
+            remaining_ = range.size();
+
+            if ( multipart_ )
+            {
+                part_header_ = part_header( range );
+                result_.push_back( boost::asio::buffer( part_header_ ) );
+            }
+        }
+
+        if ( remaining_ != 0 )
+        {
+            const std::size_t size = read_chunk();
+
+            // the file shrunk since the Content-Length header was rendered
+            if ( size == 0 )
+                throw std::runtime_error( "unable to read: " + tools::as_string( path_ ) );
+
+            result_.push_back( boost::asio::buffer( &buffer_[ 0 ], size ) );
+        }
+        else if ( multipart_ && !trailer_written_ )
+        {
+            part_header_ = "\r\n--" + boundary_ + "--\r\n";
+            result_.push_back( boost::asio::buffer( part_header_ ) );
+            trailer_written_ = true;
+        }
+    }
+
+    template < class Connection >
+    std::size_t response< Connection >::read_chunk()
+    {
+        const std::size_t size = static_cast< std::size_t >(
+            std::min< boost::uintmax_t >( remaining_, buffer_.size() ) );
+
+        input_.read( &buffer_[ 0 ], size );
+        const std::size_t read = static_cast< std::size_t >( input_.gcount() );
+        remaining_ -= read;
+
+        return read;
+    }
+
+    template < class Connection >
+    void response< Connection >::data_written(
+        const boost::system::error_code&    error,
+        std::size_t                         /* bytes_transferred */)
+    {
+        if ( error )
         {
             connection_->response_not_possible( *this );
+            return;
         }
+
+        execute( &response::read_next, &response::write_next );
     }
 
     template < class Connection >
     void response< Connection >::start()
     {
-        static std::string response_header =
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Length: ";
-
-        response_guard guard( *connection_, *this, http::http_not_found );
+        execute( &response::open_file, &response::file_opened );
+    }
 
-        try 
+    template < class Connection >
+    void response< Connection >::open_file()
+    {
+        try
         {
-            boost::filesystem::ifstream input( path_ );
+            if ( resolver_ && !resolver_( *request_, path_, additional_headers_, cached_, error_ ) )
+                return;
 
-            if ( input.is_open() )
+            // the file was just read into the cache, so there is no need to read it again
+            if ( cached_ )
             {
-                std::istreambuf_iterator< char > begin( input ), end;
-                buffer_.insert( buffer_.begin(), begin, end );
+                cached_->response_buffers( *request_, date_, result_ );
+                failed_ = false;
 
-                if ( !input.bad() )
-                {
-                    header_ = response_header + tools::as_string( buffer_.size() ) + "\r\n\r\n";
+                return;
+            }
 
-                    result_.push_back( boost::asio::buffer( header_ ) );
-                    result_.push_back( boost::asio::buffer( buffer_ ) );
+            input_.open( path_, std::ios_base::in | std::ios_base::binary );
 
-                    connection_->async_write(
-                        result_,
-                        boost::bind( &response::data_written, this->shared_from_this(), _1, _2 ),
-                        *this );
+            if ( !input_.is_open() )
+                return;
 
-                    guard.dismiss();
-                }
+            file_size_ = boost::filesystem::file_size( path_ );
+
+            const std::string etag          = entity_tag( file_size_, boost::filesystem::last_write_time( path_ ) );
+            const std::string last_modified = http_date( boost::filesystem::last_write_time( path_ ) );
+            const std::string validators    =
+                std::string( http::etag_header ) + ": " + etag + "\r\n"
+              + http::last_modified_header + ": " + last_modified + "\r\n"
+              + additional_headers_
+              + "Accept-Ranges: bytes\r\n";
+
+            if ( !select_ranges( file_size_, etag, last_modified ) )
+            {
+                header_.status( http::http_request_range_not_satisfiable )
+                    .append( http::content_range_header ).append( ": bytes */" ).append_decimal( file_size_ )
+                    .append( "\r\n" )
+                    .content_length( 0 );
+            }
+            else if ( partial_ && ranges_.size() == 1 )
+            {
+                header_.status( http::http_partial_content )
+                    .content_length( ranges_.front().size() )
+                    .append( http::content_range_header ).append( ": bytes " )
+                    .append_decimal( ranges_.front().first ).append( "-" ).append_decimal( ranges_.front().last )
+                    .append( "/" ).append_decimal( file_size_ ).append( "\r\n" );
+            }
+            else if ( partial_ )
+            {
+                multipart_ = true;
+                boundary_  = "SIOUX_BYTERANGES_" + etag.substr( 1, etag.size() - 2 );
+
+                boost::uintmax_t length = boundary_.size() + 8; // trailer
+
+                for ( std::vector< byte_range >::const_iterator range = ranges_.begin(); range != ranges_.end(); ++range )
+                    length += part_header( *range ).size() + range->size();
+
+                header_.status( http::http_partial_content )
+                    .content_length( length )
+                    .append( http::content_type_header ).append( ": multipart/byteranges; boundary=" )
+                    .append( boundary_ ).append( "\r\n" );
+            }
+            else
+            {
+                header_.status( http::http_ok )
+                    .content_length( file_size_ );
             }
+
+            header_.date().append( validators ).finish();
+
+            result_.push_back( header_.buffer() );
+            add_next_buffers();
+
+            failed_ = input_.bad();
         }
         catch ( ... ) // error reported by http error code
         {
             /// @todo add loging
         }
     }
+
+    template < class Connection >
+    void response< Connection >::file_opened()
+    {
+        response_guard guard( *connection_, *this, error_ );
+
+        if ( !failed_ )
+        {
+            connection_->async_write(
+                result_,
+                boost::bind( &response::data_written, this->shared_from_this(), _1, _2 ),
+                *this );
+
+            guard.dismiss();
+        }
+    }
+
+    template < class Connection >
+    void response< Connection >::read_next()
+    {
+        try
+        {
+            result_.clear();
+            add_next_buffers();
+        }
+        catch ( ... )
+        {
+            failed_ = true;
+        }
+    }
+
+    template < class Connection >
+    void response< Connection >::write_next()
+    {
+        close_guard guard( *connection_, *this );
+
+        if ( failed_ )
+            return;
+
+        if ( result_.empty() )
+        {
+            input_.close();
+            guard.dismiss();
+
+            connection_->response_completed( *this );
+        }
+        else
+        {
+            connection_->async_write(
+                result_,
+                boost::bind( &response::data_written, this->shared_from_this(), _1, _2 ),
+                *this );
+
+            guard.dismiss();
+        }
+    }
 }
 
 #endif /* SIOUX_FILE_RESPONSE_H_ */
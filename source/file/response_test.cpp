@@ -14,6 +14,7 @@
 #include "http/response.h"
 
 #include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
 #include <iterator>
 #include <fstream>
 #include <iostream>
@@ -47,6 +48,92 @@ namespace
         }
     };
 
+    // delivers the requested file in very small chunks
+    struct small_chunks_response_factory : response_factory
+    {
+        small_chunks_response_factory() {}
+
+        template < class T >
+        explicit small_chunks_response_factory( const T& ) {}
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    header )
+        {
+            const tools::substring  uri = header->uri();
+            const boost::shared_ptr< server::async_response > new_response(
+                new file::response< Connection >( connection, boost::filesystem::path( uri.begin(), uri.end() ), 7u ) );
+            return new_response;
+        }
+    };
+
+    // delivers the requested file in small chunks and performs all file system operations in a pool
+    struct pooled_response_factory : response_factory
+    {
+        pooled_response_factory() {}
+
+        template < class T >
+        explicit pooled_response_factory( const T& ) {}
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    header )
+        {
+            const tools::substring  uri = header->uri();
+            const boost::shared_ptr< server::async_response > new_response(
+                new file::response< Connection >( connection, header, boost::filesystem::path( uri.begin(), uri.end() ),
+                    std::string(), pool(), 64u ) );
+            return new_response;
+        }
+
+        static const boost::shared_ptr< file::io_pool >& pool()
+        {
+            static const boost::shared_ptr< file::io_pool > pool( new file::io_pool( 2, 100 ) );
+            return pool;
+        }
+    };
+
+    // performs all file system operations in a pool, that refuses all jobs, like an overloaded pool does
+    struct refusing_pool_response_factory : response_factory
+    {
+        refusing_pool_response_factory() {}
+
+        template < class T >
+        explicit refusing_pool_response_factory( const T& ) {}
+
+        template < class Connection >
+        boost::shared_ptr< server::async_response > create_response(
+            const boost::shared_ptr< Connection >&                    connection,
+            const boost::shared_ptr< const http::request_header >&    header )
+        {
+            static const boost::shared_ptr< file::io_pool > pool( new file::io_pool( 0, 100 ) );
+
+            const tools::substring  uri = header->uri();
+            const boost::shared_ptr< server::async_response > new_response(
+                new file::response< Connection >( connection, header, boost::filesystem::path( uri.begin(), uri.end() ),
+                    std::string(), pool ) );
+            return new_response;
+        }
+    };
+
+    // runs the queue, until neither the queue, nor the pool have pending work
+    void run( boost::asio::io_service& queue, const file::io_pool& pool )
+    {
+        for ( ;; )
+        {
+            const bool pool_idle = pool.queue_depth() == 0 && pool.active_jobs() == 0;
+
+            queue.reset();
+
+            if ( tools::run( queue ) == 0 && pool_idle )
+                return;
+
+            boost::this_thread::yield();
+        }
+    }
+
     typedef server::test::socket< const char* > socket_t;
 
     typedef server::connection_traits<
@@ -57,6 +144,33 @@ namespace
         server::stream_error_log > trait_t;
 
     typedef server::connection< trait_t > connection_t;
+
+    typedef server::connection_traits<
+        socket_t,
+        server::test::timer,
+        small_chunks_response_factory,
+        server::null_event_logger,
+        server::stream_error_log > small_chunks_trait_t;
+
+    typedef server::connection< small_chunks_trait_t > small_chunks_connection_t;
+
+    typedef server::connection_traits<
+        socket_t,
+        server::test::timer,
+        pooled_response_factory,
+        server::null_event_logger,
+        server::stream_error_log > pooled_trait_t;
+
+    typedef server::connection< pooled_trait_t > pooled_connection_t;
+
+    typedef server::connection_traits<
+        socket_t,
+        server::test::timer,
+        refusing_pool_response_factory,
+        server::null_event_logger,
+        server::stream_error_log > refusing_pool_trait_t;
+
+    typedef server::connection< refusing_pool_trait_t > refusing_pool_connection_t;
 }
 
 static const char get_this_file[] =
@@ -99,6 +213,76 @@ BOOST_AUTO_TEST_CASE( retrieve_an_existing_file )
     BOOST_CHECK( equal_to_this_file( response.front().second ) );
 }
 
+/**
+ * @test a file, bigger than the chunk size, must be delivered completely and in order
+ */
+BOOST_AUTO_TEST_CASE( retrieve_an_existing_file_in_chunks )
+{
+    boost::asio::io_service queue;
+    socket_t                socket( queue, tools::begin( get_this_file ), tools::end( get_this_file ) -1 );
+    small_chunks_trait_t    trait;
+
+    boost::shared_ptr< small_chunks_connection_t > connection( new small_chunks_connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+
+    std::vector< std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > > response =
+        http::decode_stream< http::response_header >( socket.bin_output() );
+
+    BOOST_REQUIRE_EQUAL( response.size(), 1u );
+
+    BOOST_CHECK_EQUAL( response.front().first->code(), http::http_ok );
+    BOOST_CHECK( equal_to_this_file( response.front().second ) );
+}
+
+/**
+ * @test opening and reading the file is performed by an io_pool, the file must be delivered completely
+ */
+BOOST_AUTO_TEST_CASE( retrieve_an_existing_file_through_an_io_pool )
+{
+    boost::asio::io_service queue;
+    socket_t                socket( queue, tools::begin( get_this_file ), tools::end( get_this_file ) -1 );
+    pooled_trait_t          trait;
+
+    const unsigned long executed = pooled_response_factory::pool()->jobs_executed();
+
+    boost::shared_ptr< pooled_connection_t > connection( new pooled_connection_t( socket, trait ) );
+    connection->start();
+
+    run( queue, *pooled_response_factory::pool() );
+
+    std::vector< std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > > response =
+        http::decode_stream< http::response_header >( socket.bin_output() );
+
+    BOOST_REQUIRE_EQUAL( response.size(), 1u );
+
+    BOOST_CHECK_EQUAL( response.front().first->code(), http::http_ok );
+    BOOST_CHECK( equal_to_this_file( response.front().second ) );
+    BOOST_CHECK_GT( pooled_response_factory::pool()->jobs_executed(), executed + 1 );
+}
+
+/**
+ * @test if the io_pool refuses to open the file, the request is answered with 503, without touching the file system
+ */
+BOOST_AUTO_TEST_CASE( overloaded_io_pool_results_in_service_unavailable )
+{
+    boost::asio::io_service     queue;
+    socket_t                    socket( queue, tools::begin( get_this_file ), tools::end( get_this_file ) -1 );
+    refusing_pool_trait_t       trait;
+
+    boost::shared_ptr< refusing_pool_connection_t > connection( new refusing_pool_connection_t( socket, trait ) );
+    connection->start();
+
+    tools::run( queue );
+
+    std::vector< std::pair< boost::shared_ptr< http::response_header >, std::vector< char > > > response =
+        http::decode_stream< http::response_header >( socket.bin_output() );
+
+    BOOST_REQUIRE_EQUAL( response.size(), 1u );
+    BOOST_CHECK_EQUAL( response.front().first->code(), http::http_service_unavailable );
+}
+
 BOOST_AUTO_TEST_CASE( retrieve_a_not_existing_file )
 {
     static const char get_fantasy_file[] =
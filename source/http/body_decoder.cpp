@@ -8,22 +8,69 @@
 
 namespace http
 {
+    namespace {
+        int hex_digit( char c )
+        {
+            if ( c >= '0' && c <= '9' )
+                return c - '0';
+
+            if ( c >= 'a' && c <= 'f' )
+                return c - 'a' + 10;
+
+            if ( c >= 'A' && c <= 'F' )
+                return c - 'A' + 10;
+
+            return -1;
+        }
+    }
+
+    body_decoder::body_decoder( std::size_t max_body_size, std::size_t max_trailer_size )
+        : max_body_size_( max_body_size )
+        , max_trailer_size_( max_trailer_size )
+        , state_( body_done )
+        , error_( http::http_ok )
+        , total_size_( 0 )
+        , body_size_( 0 )
+        , line_size_( 0 )
+        , current_size_( 0 )
+        , current_( 0 )
+        , trailers_()
+    {
+    }
+
 	std::size_t body_decoder::feed_buffer( const char* buffer, std::size_t size )
 	{
 		assert( buffer );
 		assert( size );
 		assert( current_size_ == 0 ); // undecoded bytes
 
-		current_size_ = std::min( size, total_size_ );
-		current_      = buffer;
-		total_size_  -= current_size_;
+		if ( state_ == content_length_body || state_ == body_done )
+		    return feed_content_length_encoded( buffer, size );
+
+		if ( state_ == decoding_error )
+		    return 0;
 
-		return current_size_;
+		return feed_chunked_encoded( buffer, size );
 	}
 
     bool body_decoder::done() const
     {
-    	return total_size_ == 0 && current_size_ == 0;
+    	return state_ == body_done && current_size_ == 0;
+    }
+
+    std::size_t body_decoder::remaining_length() const
+    {
+        return state_ == content_length_body ? total_size_ : 0;
+    }
+
+    http::http_error_code body_decoder::error() const
+    {
+        return error_;
+    }
+
+    const std::string& body_decoder::trailers() const
+    {
+        return trailers_;
     }
 
     std::pair< std::size_t, const char* > body_decoder::decode()
@@ -36,9 +83,177 @@ namespace http
 
     void body_decoder::start_content_length_encoded( std::size_t size )
     {
+        state_        = size == 0 ? body_done : content_length_body;
+        error_        = http::http_ok;
         total_size_   = size;
+        body_size_    = size;
+        current_size_ = 0;
+        current_      = 0;
+        trailers_.clear();
+    }
+
+    void body_decoder::start_chunked_encoded()
+    {
+        state_        = chunk_size_first_digit;
+        error_        = http::http_ok;
+        total_size_   = 0;
+        body_size_    = 0;
+        line_size_    = 0;
         current_size_ = 0;
         current_      = 0;
+        trailers_.clear();
+    }
+
+    std::size_t body_decoder::feed_content_length_encoded( const char* buffer, std::size_t size )
+    {
+        current_size_ = std::min( size, total_size_ );
+        current_      = buffer;
+        total_size_  -= current_size_;
+
+        if ( total_size_ == 0 )
+            state_ = body_done;
+
+        return current_size_;
+    }
+
+    std::size_t body_decoder::feed_chunked_encoded( const char* const buffer, std::size_t size )
+    {
+        const char* const end = buffer + size;
+        const char*       pos = buffer;
+
+        for ( ; pos != end && state_ != body_done && state_ != decoding_error; ++pos )
+        {
+            const char c = *pos;
+
+            switch ( state_ )
+            {
+            case chunk_size_first_digit:
+            case chunk_size:
+                if ( hex_digit( c ) >= 0 )
+                {
+                    const std::size_t digit = hex_digit( c );
+
+                    if ( total_size_ > ( std::numeric_limits< std::size_t >::max() - digit ) / 16 )
+                    {
+                        failed( http::http_request_entity_too_large );
+                        break;
+                    }
+
+                    total_size_ = total_size_ * 16 + digit;
+                    state_      = chunk_size;
+                }
+                else if ( state_ == chunk_size && ( c == ';' || c == ' ' || c == '\t' ) )
+                {
+                    state_     = chunk_extension;
+                    line_size_ = 0;
+                }
+                else if ( state_ == chunk_size && c == '\r' )
+                {
+                    state_ = chunk_size_LF;
+                }
+                else
+                {
+                    failed( http::http_bad_request );
+                }
+                break;
+            case chunk_extension:
+                if ( c == '\r' )
+                    state_ = chunk_size_LF;
+                else if ( c == '\n' )
+                    failed( http::http_bad_request );
+                else if ( ++line_size_ > max_trailer_size_ )
+                    failed( http::http_request_entity_too_large );
+                break;
+            case chunk_size_LF:
+                if ( c != '\n' )
+                {
+                    failed( http::http_bad_request );
+                }
+                else if ( total_size_ == 0 )
+                {
+                    state_     = trailer_line;
+                    line_size_ = 0;
+                }
+                else if ( total_size_ > max_body_size_ - body_size_ )
+                {
+                    failed( http::http_request_entity_too_large );
+                }
+                else
+                {
+                    body_size_ += total_size_;
+                    state_      = chunk_data;
+                }
+                break;
+            case chunk_data:
+                // return the data of the current chunk, that is available in the buffer
+                current_      = pos;
+                current_size_ = std::min( total_size_, static_cast< std::size_t >( end - pos ) );
+                total_size_  -= current_size_;
+
+                if ( total_size_ == 0 )
+                    state_ = chunk_data_CR;
+
+                return pos - buffer + current_size_;
+            case chunk_data_CR:
+                if ( c == '\r' )
+                    state_ = chunk_data_LF;
+                else
+                    failed( http::http_bad_request );
+                break;
+            case chunk_data_LF:
+                if ( c == '\n' )
+                    state_ = chunk_size_first_digit;
+                else
+                    failed( http::http_bad_request );
+                break;
+            case trailer_line:
+                if ( c == '\r' )
+                {
+                    state_ = trailer_LF;
+                }
+                else if ( c == '\n' )
+                {
+                    failed( http::http_bad_request );
+                }
+                else if ( trailers_.size() >= max_trailer_size_ )
+                {
+                    failed( http::http_request_entity_too_large );
+                }
+                else
+                {
+                    trailers_ += c;
+                    ++line_size_;
+                }
+                break;
+            case trailer_LF:
+                if ( c != '\n' )
+                {
+                    failed( http::http_bad_request );
+                }
+                else if ( line_size_ == 0 )
+                {
+                    state_ = body_done;
+                }
+                else
+                {
+                    trailers_ += "\r\n";
+                    state_     = trailer_line;
+                    line_size_ = 0;
+                }
+                break;
+            default:
+                assert( !"unexpected state" );
+            }
+        }
+
+        return pos - buffer;
+    }
+
+    void body_decoder::failed( http::http_error_code error )
+    {
+        state_        = decoding_error;
+        error_        = error;
+        current_size_ = 0;
     }
 
 }
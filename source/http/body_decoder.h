@@ -6,33 +6,54 @@
 #define HTTP_BODY_DECODER_H_
 
 #include "http/message.h"
+#include "http/header_names.h"
 #include "http/http.h"
 #include "http/parser.h"
 
+#include <limits>
+#include <string>
+
 namespace http
 {
 	/**
 	 * @brief decodes a message body
 	 *
-	 * @todo add chunked bodies
+	 * Content-Length and chunked encoded bodies are decoded incrementally, without copying the body. A chunked
+	 * body can be feed in arbitrary pieces, the chunk framing is consumed by feed_buffer() and only the chunk data
+	 * is returned by decode(). Trailer fields of a chunked body are collected and are available by trailers(),
+	 * once the body is done().
+	 *
 	 * @todo add compression
 	 */
 	class body_decoder
 	{
 	public:
+        /**
+         * @brief constructs a decoder, that will accept bodies of up to max_body_size bytes
+         *
+         * For chunked bodies, the size of the trailer fields is limited to max_trailer_size.
+         */
+        explicit body_decoder(
+            std::size_t max_body_size    = std::numeric_limits< std::size_t >::max(),
+            std::size_t max_trailer_size = 8 * 1024u );
+
         /**
          * @brief initialized this buffer for decoding a new message body
-         * @return http::http_ok, if the decoder can decode the given message
+         * @return http::http_ok, if the decoder can decode the given message,
+         *         http::http_request_entity_too_large, if the Content-Length exceeds the limit and
+         *         http::http_not_implemented, if the message uses an other transfer coding than chunked.
          */
         template < class Base >
         http::http_error_code start( const http::message_base< Base >& request );
-
         /**
          * @brief feeds a new part of the body to the decoder.
          *
          * It's assumed, that the passed buffer stays valid until the whole
          * buffer is consumed by call to decode(). The function returns the
-         * number of bytes taken from the input stream.
+         * number of bytes taken from the input stream. For a chunked body, less
+         * than the available bytes might be taken, even if the body is not done();
+         * in this case, the rest of the buffer has to be feed again, after
+         * the taken part was decode()'d.
          */
         std::size_t feed_buffer( const char* buffer, std::size_t size );
 
@@ -41,6 +62,28 @@ namespace http
          */
         bool done() const;
 
+        /**
+         * @brief the number of body bytes, that are still expected for a Content-Length encoded body
+         *
+         * For a chunked body, the size of the remaining body is not known in advance and 0 is returned.
+         */
+        std::size_t remaining_length() const;
+
+        /**
+         * @brief returns http::http_ok, as long as no error was detected in the body or in the message header
+         *
+         * If an error is detected, the decoder will not take any more input and the
+         * error code to be send to the client is returned.
+         */
+        http::http_error_code error() const;
+
+        /**
+         * @brief the trailer fields of a chunked body, each terminated by \\r\\n
+         *
+         * The trailer is only complete, when the body is done().
+         */
+        const std::string& trailers() const;
+
         /**
          * @brief returns a part of the decoded body. If the first member of
          * the returned pair is 0, the part, that was feed to the decode by feed_buffer()
@@ -49,11 +92,44 @@ namespace http
         std::pair< std::size_t, const char* > decode();
 
 	private:
+        enum state_t {
+            content_length_body,
+            chunk_size_first_digit,
+            chunk_size,
+            chunk_extension,
+            chunk_size_LF,
+            chunk_data,
+            chunk_data_CR,
+            chunk_data_LF,
+            trailer_line,
+            trailer_LF,
+            body_done,
+            decoding_error
+        };
+
         void start_content_length_encoded( std::size_t size );
+        void start_chunked_encoded();
+
+        std::size_t feed_content_length_encoded( const char* buffer, std::size_t size );
+        std::size_t feed_chunked_encoded( const char* buffer, std::size_t size );
+
+        void failed( http::http_error_code error );
 
-        std::size_t	total_size_;
-        std::size_t	current_size_;
-        const char*	current_;
+        const std::size_t       max_body_size_;
+        const std::size_t       max_trailer_size_;
+
+        state_t                 state_;
+        http::http_error_code   error_;
+
+        // remaining bytes of the body or of the current chunk
+        std::size_t             total_size_;
+        // the sum of all chunk sizes so far
+        std::size_t             body_size_;
+        // the length of the current chunk extension or trailer line
+        std::size_t             line_size_;
+        std::size_t             current_size_;
+        const char*             current_;
+        std::string             trailers_;
 	};
 
 	///////////////////
@@ -61,13 +137,43 @@ namespace http
     template < class Base >
     http::http_error_code body_decoder::start( const http::message_base< Base >& request )
     {
-    	const http::header* length_header = request.find_header( "Content-Length" );
+        // a transfer coding overrides the Content-Length (RFC 2616, 4.4)
+        if ( const http::header* encoding_header = request.find_header( http::transfer_encoding_header ) )
+        {
+            const tools::substring coding = encoding_header->value();
+
+            if ( http::strcasecmp(
+                    http::eat_spaces_and_CRLS( coding.begin(), coding.end() ),
+                    http::reverse_eat_spaces_and_CRLS( coding.begin(), coding.end() ), "chunked" ) != 0 )
+            {
+                failed( http::http_not_implemented );
+                return error_;
+            }
+
+            start_chunked_encoded();
+
+            return http::http_ok;
+        }
+
+    	const http::header* length_header = request.find_header( http::content_length_header );
     	if ( !length_header )
-    		return http::http_length_required;
+    	{
+            failed( http::http_length_required );
+    		return error_;
+    	}
 
     	std::size_t length = 0;
     	if ( !http::parse_number( length_header->value().begin(), length_header->value().end(), length ) )
-    		return http::http_bad_request;
+    	{
+            failed( http::http_bad_request );
+    		return error_;
+    	}
+
+    	if ( length > max_body_size_ )
+    	{
+            failed( http::http_request_entity_too_large );
+            return error_;
+    	}
 
     	start_content_length_encoded( length );
 
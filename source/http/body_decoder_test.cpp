@@ -6,6 +6,9 @@
 #include "http/body_decoder.h"
 #include "http/request.h"
 #include "http/test_request_texts.h"
+#include "tools/iterators.h"
+#include <algorithm>
+#include <string>
 
 static const http::request_header header_with_body(
 		"POST / HTTP/1.1\r\n"
@@ -121,3 +124,178 @@ BOOST_AUTO_TEST_CASE( test_header_with_empty_body )
     BOOST_REQUIRE( decoded.second != 0 );
 }
 
+
+namespace {
+    const http::request_header chunked_header(
+            "POST / HTTP/1.1\r\n"
+            "Host: google.de\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n" );
+
+    /*
+     * feeds the text in pieces of piece_size to the decoder and collects the decoded body
+     */
+    std::string decode_chunked( http::body_decoder& decoder, const std::string& text, std::size_t piece_size )
+    {
+        std::string result;
+
+        for ( std::string::size_type pos = 0; pos != text.size() && !decoder.done()
+            && decoder.error() == http::http_ok; )
+        {
+            const std::size_t size = std::min( piece_size, text.size() - pos );
+            std::size_t consumed = 0;
+
+            while ( consumed != size && !decoder.done() && decoder.error() == http::http_ok )
+            {
+                consumed += decoder.feed_buffer( text.data() + pos + consumed, size - consumed );
+
+                for ( std::pair< std::size_t, const char* > part = decoder.decode(); part.first; part = decoder.decode() )
+                    result.append( part.second, part.first );
+            }
+
+            pos += consumed;
+        }
+
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( decode_chunked_encoded )
+{
+    const std::string body =
+        "5\r\n"
+        "12345\r\n"
+        "1A;name=value\r\n"
+        "abcdefghijklmnopqrstuvwxyz\r\n"
+        "0\r\n"
+        "\r\n"
+        "POST / HTTP/1.1\r\n";
+
+    http::body_decoder decoder;
+    BOOST_CHECK_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+    // the chunk size line of the first chunk is consumed along with the chunk data
+    BOOST_CHECK_EQUAL( 8u, decoder.feed_buffer( body.data(), body.size() ) );
+
+    const std::pair< std::size_t, const char* > decoded = decoder.decode();
+    BOOST_CHECK_EQUAL( 5u, decoded.first );
+    BOOST_CHECK_EQUAL( "12345", tools::substring( decoded.second, decoded.second + decoded.first ) );
+    BOOST_CHECK_EQUAL( 0, decoder.decode().first );
+    BOOST_CHECK( !decoder.done() );
+
+    http::body_decoder other;
+    BOOST_CHECK_EQUAL( http::http_ok, other.start( chunked_header ) );
+    BOOST_CHECK_EQUAL( "12345abcdefghijklmnopqrstuvwxyz", decode_chunked( other, body, body.size() ) );
+    BOOST_CHECK( other.done() );
+    BOOST_CHECK( other.trailers().empty() );
+}
+
+/**
+ * @test the decoded body must not depend on how the encoded body is split
+ */
+BOOST_AUTO_TEST_CASE( decode_chunked_encoded_step_by_step )
+{
+    const std::string body =
+        "3\r\n"
+        "123\r\n"
+        "10 ; ext\r\n"
+        "0123456789abcdef\r\n"
+        "0\r\n"
+        "\r\n";
+
+    for ( std::size_t piece_size = 1; piece_size != body.size() + 1; ++piece_size )
+    {
+        http::body_decoder decoder;
+        BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+        BOOST_CHECK_EQUAL( "1230123456789abcdef", decode_chunked( decoder, body, piece_size ) );
+        BOOST_CHECK( decoder.done() );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( decode_chunked_encoded_with_trailers )
+{
+    const std::string body =
+        "3\r\n"
+        "123\r\n"
+        "0\r\n"
+        "Expires: never\r\n"
+        "X-Checksum: 42\r\n"
+        "\r\n";
+
+    http::body_decoder decoder;
+    BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+    BOOST_CHECK_EQUAL( "123", decode_chunked( decoder, body, 4u ) );
+    BOOST_CHECK( decoder.done() );
+    BOOST_CHECK_EQUAL( "Expires: never\r\nX-Checksum: 42\r\n", decoder.trailers() );
+}
+
+BOOST_AUTO_TEST_CASE( decode_chunked_encoded_with_bad_framing )
+{
+    const char* const bad_bodies[] = {
+        "\r\n",
+        "x\r\n",
+        "3\r\n1234\r\n0\r\n\r\n",
+        "3\n123\r\n0\r\n\r\n",
+        "3\r\n123\r\n0\r\nExpires: never\n\r\n"
+    };
+
+    for ( const char* const * body = tools::begin( bad_bodies ); body != tools::end( bad_bodies ); ++body )
+    {
+        http::body_decoder decoder;
+        BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+        decode_chunked( decoder, *body, 100u );
+        BOOST_CHECK( !decoder.done() );
+        BOOST_CHECK_EQUAL( http::http_bad_request, decoder.error() );
+        BOOST_CHECK_EQUAL( 0, decoder.feed_buffer( *body, 1u ) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( body_decoder_limits )
+{
+    // chunks, that sum up to more than the limit
+    {
+        http::body_decoder decoder( 10u );
+        BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+        BOOST_CHECK_EQUAL( "12345", decode_chunked( decoder, "5\r\n12345\r\n6\r\n123456\r\n0\r\n\r\n", 100u ) );
+        BOOST_CHECK_EQUAL( http::http_request_entity_too_large, decoder.error() );
+    }
+
+    // a chunk size, that overflows
+    {
+        http::body_decoder decoder;
+        BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+        decode_chunked( decoder, "1" + std::string( 2 * sizeof( std::size_t ), '0' ) + "\r\n", 100u );
+        BOOST_CHECK_EQUAL( http::http_request_entity_too_large, decoder.error() );
+    }
+
+    // to much trailer fields
+    {
+        http::body_decoder decoder( 10u, 20u );
+        BOOST_REQUIRE_EQUAL( http::http_ok, decoder.start( chunked_header ) );
+
+        decode_chunked( decoder, "0\r\nExpires: never\r\nX-Checksum: 42\r\n\r\n", 100u );
+        BOOST_CHECK_EQUAL( http::http_request_entity_too_large, decoder.error() );
+    }
+
+    // Content-Length exceeding the limit
+    {
+        http::body_decoder decoder( 4u );
+        BOOST_CHECK_EQUAL( http::http_request_entity_too_large, decoder.start( header_with_body ) );
+        BOOST_CHECK_EQUAL( http::http_request_entity_too_large, decoder.error() );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( body_decoder_with_unsupported_transfer_coding )
+{
+    const http::request_header header(
+            "POST / HTTP/1.1\r\n"
+            "Host: google.de\r\n"
+            "Transfer-Encoding: gzip, chunked\r\n"
+            "\r\n" );
+
+    http::body_decoder decoder;
+    BOOST_CHECK_EQUAL( http::http_not_implemented, decoder.start( header ) );
+}
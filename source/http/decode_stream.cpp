@@ -29,6 +29,9 @@ namespace http
 
 				pos += decoder.feed_buffer( &stream[ pos ], stream.size() - pos );
 
+				if ( decoder.error() != http::http_ok )
+					throw std::runtime_error( "error while decoding message body." );
+
 				for ( std::pair< std::size_t, const char* > part = decoder.decode();
 						part.first; part = decoder.decode() )
 				{
@@ -135,7 +138,8 @@ namespace http
         std::copy( data, data + write_size, write_pos.first );
         const bool done = header.parse( write_size );
 
-        std::size_t remaining_size = size - ( write_size - header.unparsed_buffer().second );
+        // if the header is not complete, all data was consumed
+        std::size_t remaining_size = size - write_size + ( done ? header.unparsed_buffer().second : 0 );
 
         if ( done )
         {
@@ -168,13 +172,24 @@ namespace http
         }
 
         std::vector< char >& out_buffer = current_.second;
-        size -= decoder_.feed_buffer( data, size );
 
-        for ( std::pair< std::size_t, const char* > decoded = decoder_.decode(); decoded.first;
-            decoded = decoder_.decode() )
+        // a chunked body is consumed in parts
+        do
         {
-            out_buffer.insert( out_buffer.end(), decoded.second, decoded.second + decoded.first );
+            const std::size_t consumed = decoder_.feed_buffer( data, size );
+            data += consumed;
+            size -= consumed;
+
+            for ( std::pair< std::size_t, const char* > decoded = decoder_.decode(); decoded.first;
+                decoded = decoder_.decode() )
+            {
+                out_buffer.insert( out_buffer.end(), decoded.second, decoded.second + decoded.first );
+            }
+
+            if ( decoder_.error() != http::http_ok )
+                throw std::runtime_error( "error while decoding message body." );
         }
+        while ( size != 0 && !decoder_.done() );
 
         if ( decoder_.done() )
             state_ = idle_state;
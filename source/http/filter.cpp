@@ -4,18 +4,83 @@
 
 #include "http/filter.h"
 #include "http/parser.h"
-#include "tools/split.h"
-#include <functional>
+#include <algorithm>
 #include <cstring>
 
 namespace http {
     namespace {
-        struct sort_caseless : std::binary_function<tools::substring, tools::substring, bool>
+        // number of seeds tried, before the table size is doubled
+        const unsigned max_seeds = 16;
+
+        // largest table size, for which a seed without collisions is searched
+        const std::size_t max_perfect_table_size = 4096;
+
+        unsigned to_lower(char c)
+        {
+            return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : static_cast<unsigned char>(c);
+        }
+
+        // FNV-1a over the lower case characters
+        std::size_t hash(const char* begin, const char* end, unsigned seed)
+        {
+            unsigned result = 2166136261u ^ seed;
+
+            for ( ; begin != end; ++begin )
+                result = (result ^ to_lower(*begin)) * 16777619u;
+
+            return result ^ (result >> 15);
+        }
+
+        bool equal_caseless(const tools::substring& lhs, const tools::substring& rhs)
+        {
+            return lhs.size() == rhs.size()
+                && http::strcasecmp(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()) == 0;
+        }
+
+        // calls f with every non empty element of the comma separated list, until f returns true
+        template <class F>
+        bool find_element(const char* begin, const char* end, F f)
         {
-            bool operator()(const tools::substring& lhs, const tools::substring& rhs) const
+            while ( begin != end )
             {
-                return http::strcasecmp(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()) == -1;
+                const char* const comma = std::find(begin, end, ',');
+                const char* const first = http::eat_spaces_and_CRLS(begin, comma);
+                const char* const last  = http::reverse_eat_spaces_and_CRLS(first, comma);
+
+                if ( first != last && f(tools::substring(first, last)) )
+                    return true;
+
+                begin = comma == end ? end : comma + 1;
             }
+
+            return false;
+        }
+
+        struct equal_to
+        {
+            explicit equal_to(const tools::substring& name) : name_(name) {}
+
+            bool operator()(const tools::substring& element) const
+            {
+                return equal_caseless(element, name_);
+            }
+
+            const tools::substring& name_;
+        };
+
+        struct add_to
+        {
+            explicit add_to(std::vector<tools::substring>& index) : index_(index) {}
+
+            bool operator()(const tools::substring& element) const
+            {
+                if ( std::find_if(index_.begin(), index_.end(), equal_to(element)) == index_.end() )
+                    index_.push_back(element);
+
+                return false;
+            }
+
+            std::vector<tools::substring>& index_;
         };
     }
 
@@ -24,6 +89,10 @@ namespace http {
     filter::filter(const char* k)
         : values_(k, k + std::strlen(k))
         , index_()
+        , table_()
+        , seed_(0)
+        , min_length_(1)
+        , max_length_(0)
     {
         build_index();
     }
@@ -31,6 +100,10 @@ namespace http {
     filter::filter(const tools::substring& k)
         : values_(k.begin(), k.end())
         , index_()
+        , table_()
+        , seed_(0)
+        , min_length_(1)
+        , max_length_(0)
     {
         build_index();
     }
@@ -38,12 +111,20 @@ namespace http {
     filter::filter()
         : values_()
         , index_()
+        , table_()
+        , seed_(0)
+        , min_length_(1)
+        , max_length_(0)
     {
     }
 
     filter::filter(const filter& org)
         : values_(org.values_)
         , index_()
+        , table_()
+        , seed_(0)
+        , min_length_(1)
+        , max_length_(0)
     {
         build_index();
     }
@@ -66,7 +147,18 @@ namespace http {
 
     bool filter::operator()(const tools::substring& key) const
     {
-        return std::binary_search(index_.begin(), index_.end(), key, sort_caseless());
+        if ( key.size() < min_length_ || key.size() > max_length_ )
+            return false;
+
+        const std::size_t mask = table_.size() - 1;
+
+        for ( std::size_t slot = hash(key.begin(), key.end(), seed_) & mask; table_[slot] != 0; slot = (slot + 1) & mask )
+        {
+            if ( equal_caseless(index_[table_[slot] - 1], key) )
+                return true;
+        }
+
+        return false;
     }
 
     filter& filter::operator+=(const filter& rhs)
@@ -78,30 +170,69 @@ namespace http {
 
         return *this;
     }
-        void add_element(const char* begin, const char* end);
-
-    void filter::add_element(const char* begin, const char* end)
-    {
-        index_.push_back(
-            tools::substring(
-                http::eat_spaces_and_CRLS(begin, end),
-                http::reverse_eat_spaces_and_CRLS(begin, end)
-            ));
-    }
 
     void filter::build_index()
     {
         index_.clear();
-        tools::substring all(&values_[0], &values_[0] + values_.size());
+        table_.clear();
+        min_length_ = 1;
+        max_length_ = 0;
+
+        if ( values_.empty() )
+            return;
+
+        find_element(&values_[0], &values_[0] + values_.size(), add_to(index_));
+
+        if ( index_.empty() )
+            return;
+
+        min_length_ = index_.front().size();
+        max_length_ = index_.front().size();
+
+        for ( std::vector<tools::substring>::const_iterator name = index_.begin(); name != index_.end(); ++name )
+        {
+            min_length_ = std::min(min_length_, name->size());
+            max_length_ = std::max(max_length_, name->size());
+        }
 
-        for ( tools::substring sub; tools::split(all, ',', sub, all); )
+        // at most half of the slots are used, so that a search for an unknown name hits an empty slot soon
+        std::size_t table_size = 8;
+        for ( ; table_size < 2 * index_.size(); table_size *= 2 )
+            ;
+
+        // search for a seed, that places every name at the slot it hashes to. For very large filters, collisions
+        // are tolerated and resolved by linear probing.
+        for ( ; table_size <= max_perfect_table_size; table_size *= 2 )
         {
-            add_element(sub.begin(), sub.end());
+            for ( unsigned seed = 0; seed != max_seeds; ++seed )
+            {
+                if ( build_table(table_size, seed) )
+                    return;
+            }
         }
 
-        add_element(all.begin(), all.end());
+        build_table(table_size, 0);
+    }
+
+    bool filter::build_table(std::size_t table_size, unsigned seed)
+    {
+        table_.assign(table_size, 0);
+        seed_ = seed;
+
+        const std::size_t mask = table_size - 1;
+        bool              perfect = true;
 
-        std::sort(index_.begin(), index_.end(), sort_caseless());
+        for ( std::size_t index = 0; index != index_.size(); ++index )
+        {
+            std::size_t slot = hash(index_[index].begin(), index_[index].end(), seed) & mask;
+
+            for ( ; table_[slot] != 0; slot = (slot + 1) & mask )
+                perfect = false;
+
+            table_[slot] = index + 1;
+        }
+
+        return perfect;
     }
 
     filter operator+(const filter& lhs, const filter& rhs)
@@ -111,4 +242,9 @@ namespace http {
 
         return result;
     }
+
+    bool listed(const tools::substring& list, const tools::substring& name)
+    {
+        return find_element(list.begin(), list.end(), equal_to(name));
+    }
 } // namespace http
@@ -2,21 +2,27 @@
 // Please note that the content of this file is confidential or protected by law.
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
+#ifndef SIOUX_SOURCE_HTTP_FILTER_H
+#define SIOUX_SOURCE_HTTP_FILTER_H
+
 #include "tools/substring.h"
+#include <vector>
 
 namespace http {
 
     /**
      * @brief class that contains a list of header names, that can be used to filter a headers
      *
-     * Comparison is done with ASCII in mind and by ignoring cases
+     * Comparison is done with ASCII in mind and by ignoring cases. The names are compiled into a hash table, where
+     * every name is found at the first probed slot, so that testing a header name costs one pass over the name
+     * plus a single caseless comparison.
      */
     class filter
     {
     public:
         /**
          * @brief constucts a filter from a comma seperated list of header names
-         * 
+         *
          * Example header_filter f("Connect, Via, Vary,\r\nFooBar")
          */
         explicit filter(const char*);
@@ -52,10 +58,16 @@ namespace http {
 
     private:
         void build_index();
-        void add_element(const char* begin, const char* end);
+        bool build_table(std::size_t table_size, unsigned seed);
 
         std::vector<char>               values_;
         std::vector<tools::substring>   index_;
+
+        // slots of the hash table, containing an index into index_ + 1 or 0 for an empty slot
+        std::vector<std::size_t>        table_;
+        unsigned                        seed_;
+        std::size_t                     min_length_;
+        std::size_t                     max_length_;
     };
 
     /**
@@ -64,4 +76,15 @@ namespace http {
      */
     filter operator+(const filter& lhs, const filter& rhs);
 
-} // namespace http
\ No newline at end of file
+    /**
+     * @brief returns true, if name is an element of the comma separated list of names
+     *
+     * The comparison is case insensitive and spaces and line breaks around the elements are ignored. This is the
+     * cheaper alternative to constructing a filter, when a list, like the value of a Connection header, is searched
+     * only a few times.
+     */
+    bool listed(const tools::substring& list, const tools::substring& name);
+
+} // namespace http
+
+#endif // include guard
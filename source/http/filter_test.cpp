@@ -7,6 +7,7 @@
 #include <boost/test/unit_test.hpp>
 #include "http/filter.h"
 #include <cstring>
+#include <string>
 
 namespace {
     // used to convert string literals to tools::substring, just for test purpose
@@ -94,3 +95,68 @@ BOOST_AUTO_TEST_CASE(add_filters_test)
     BOOST_CHECK(f8(_("a")));
     BOOST_CHECK(f8(_("b")));
 }
+
+/**
+ * @test a filter with many names finds every name, independent of the case, and nothing else
+ */
+BOOST_AUTO_TEST_CASE(large_filter_test)
+{
+    std::string names;
+    for ( int i = 0; i != 500; ++i )
+        names += "X-Header-" + std::string(1, static_cast<char>('a' + i % 26)) + std::string(i / 26 + 1, 'q') + ",";
+
+    const http::filter f(_(names.c_str()));
+
+    for ( int i = 0; i != 500; ++i )
+    {
+        const std::string lower = "x-header-" + std::string(1, static_cast<char>('a' + i % 26)) + std::string(i / 26 + 1, 'q');
+        const std::string upper = "X-HEADER-" + std::string(1, static_cast<char>('A' + i % 26)) + std::string(i / 26 + 1, 'Q');
+        const std::string other = "X-Header-" + std::string(1, static_cast<char>('a' + i % 26)) + std::string(i / 26 + 1, 'p');
+
+        BOOST_CHECK(f(_(lower.c_str())));
+        BOOST_CHECK(f(_(upper.c_str())));
+        BOOST_CHECK(!f(_(other.c_str())));
+    }
+}
+
+/**
+ * @test empty elements, duplicates and empty filters
+ */
+BOOST_AUTO_TEST_CASE(degenerated_filter_test)
+{
+    const http::filter empty;
+    BOOST_CHECK(!empty(_("")));
+    BOOST_CHECK(!empty(_("a")));
+
+    const http::filter only_commas(" , ,,");
+    BOOST_CHECK(!only_commas(_("")));
+    BOOST_CHECK(!only_commas(_(",")));
+
+    const http::filter duplicates(",Connection, connection ,,CONNECTION");
+    BOOST_CHECK(duplicates(_("connection")));
+    BOOST_CHECK(!duplicates(_("connections")));
+    BOOST_CHECK(!duplicates(_("")));
+
+    // only letters are compared caseless
+    const http::filter special("a[b, c@d");
+    BOOST_CHECK(special(_("A[B")));
+    BOOST_CHECK(!special(_("a{b")));
+    BOOST_CHECK(special(_("C@D")));
+    BOOST_CHECK(!special(_("c`d")));
+}
+
+/**
+ * @test searching a comma separated list without constructing a filter
+ */
+BOOST_AUTO_TEST_CASE(listed_test)
+{
+    BOOST_CHECK(http::listed(_("close"), _("Close")));
+    BOOST_CHECK(http::listed(_("Keep-Alive, X-Foo,\r\n\tx-bar"), _("x-foo")));
+    BOOST_CHECK(http::listed(_("Keep-Alive, X-Foo,\r\n\tx-bar"), _("X-BAR")));
+    BOOST_CHECK(http::listed(_(",,keep-alive,"), _("keep-alive")));
+
+    BOOST_CHECK(!http::listed(_(""), _("close")));
+    BOOST_CHECK(!http::listed(_("close"), _("")));
+    BOOST_CHECK(!http::listed(_(", ,"), _("")));
+    BOOST_CHECK(!http::listed(_("keep-alive, close"), _("keep")));
+}
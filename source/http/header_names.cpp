@@ -3,12 +3,110 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "http/header_names.h"
+#include "http/parser.h"
+#include <cstring>
 
 namespace http
 {
     const char * const content_type_header = "Content-Type";
     const char * const content_length_header = "Content-Length";
     const char * const transfer_encoding_header = "Transfer-Encoding";
+    const char * const etag_header = "ETag";
+    const char * const last_modified_header = "Last-Modified";
+    const char * const if_none_match_header = "If-None-Match";
+    const char * const if_modified_since_header = "If-Modified-Since";
+    const char * const range_header = "Range";
+    const char * const if_range_header = "If-Range";
+    const char * const content_range_header = "Content-Range";
+    const char * const accept_encoding_header = "Accept-Encoding";
+    const char * const content_encoding_header = "Content-Encoding";
+    const char * const vary_header = "Vary";
+    const char * const connection_header = "Connection";
+    const char * const host_header = "Host";
 
     const char * const application_x_www_from_urlencded = "application/x-www-form-urlencoded";
+
+    namespace {
+        const char * const * const slot_names[ number_of_header_slots ] = {
+            &content_type_header,
+            &content_length_header,
+            &transfer_encoding_header,
+            &etag_header,
+            &last_modified_header,
+            &if_none_match_header,
+            &if_modified_since_header,
+            &range_header,
+            &if_range_header,
+            &content_range_header,
+            &accept_encoding_header,
+            &content_encoding_header,
+            &vary_header,
+            &connection_header,
+            &host_header
+        };
+
+        // hash value of a name is ( length + lower( first ) + lower( last ) ) % 32, which is collision free for the
+        // names above. header_names_test.cpp checks this, when names are added.
+        const std::size_t hash_table_size = 32;
+
+        const header_slot hash_table[ hash_table_size ] = {
+            host_slot,                  //  0
+            no_header_slot,             //  1
+            no_header_slot,             //  2
+            no_header_slot,             //  3
+            no_header_slot,             //  4
+            no_header_slot,             //  5
+            no_header_slot,             //  6
+            no_header_slot,             //  7
+            no_header_slot,             //  8
+            no_header_slot,             //  9
+            no_header_slot,             // 10
+            no_header_slot,             // 11
+            transfer_encoding_slot,     // 12
+            no_header_slot,             // 13
+            no_header_slot,             // 14
+            no_header_slot,             // 15
+            etag_slot,                  // 16
+            no_header_slot,             // 17
+            no_header_slot,             // 18
+            vary_slot,                  // 19
+            content_type_slot,          // 20
+            content_range_slot,         // 21
+            if_range_slot,              // 22
+            accept_encoding_slot,       // 23
+            no_header_slot,             // 24
+            content_length_slot,        // 25
+            content_encoding_slot,      // 26
+            connection_slot,            // 27
+            range_slot,                 // 28
+            last_modified_slot,         // 29
+            if_none_match_slot,         // 30
+            if_modified_since_slot      // 31
+        };
+
+        // all first and last characters of the names are letters
+        unsigned lower( char c )
+        {
+            return static_cast< unsigned char >( c ) | 0x20;
+        }
+    }
+
+    header_slot find_header_slot(const char* begin, const char* end)
+    {
+        if ( begin == end )
+            return no_header_slot;
+
+        const std::size_t   hash = ( static_cast< std::size_t >( end - begin ) + lower( *begin ) + lower( *( end - 1 ) ) )
+                                 % hash_table_size;
+        const header_slot   slot = hash_table[ hash ];
+
+        return slot != no_header_slot && http::strcasecmp( begin, end, *slot_names[ slot ] ) == 0
+            ? slot
+            : no_header_slot;
+    }
+
+    header_slot find_header_slot(const char* name)
+    {
+        return find_header_slot( name, name + std::strlen( name ) );
+    }
 }
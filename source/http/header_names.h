@@ -10,8 +10,58 @@ namespace http
     extern const char * const content_type_header;
     extern const char * const content_length_header;
     extern const char * const transfer_encoding_header;
+    extern const char * const etag_header;
+    extern const char * const last_modified_header;
+    extern const char * const if_none_match_header;
+    extern const char * const if_modified_since_header;
+    extern const char * const range_header;
+    extern const char * const if_range_header;
+    extern const char * const content_range_header;
+    extern const char * const accept_encoding_header;
+    extern const char * const content_encoding_header;
+    extern const char * const vary_header;
+    extern const char * const connection_header;
+    extern const char * const host_header;
 
     extern const char * const application_x_www_from_urlencded;
+
+    /**
+     * @brief the headers from above, that a message_base<> can find without searching all its headers
+     */
+    enum header_slot
+    {
+        content_type_slot,
+        content_length_slot,
+        transfer_encoding_slot,
+        etag_slot,
+        last_modified_slot,
+        if_none_match_slot,
+        if_modified_since_slot,
+        range_slot,
+        if_range_slot,
+        content_range_slot,
+        accept_encoding_slot,
+        content_encoding_slot,
+        vary_slot,
+        connection_slot,
+        host_slot,
+
+        number_of_header_slots,
+        /** the header name is not one of the well known names */
+        no_header_slot = number_of_header_slots
+    };
+
+    /**
+     * @brief classifies the header name [begin, end) (case insensitive) with a perfect hash
+     *
+     * Costs one table lookup and one string compare.
+     */
+    header_slot find_header_slot(const char* begin, const char* end);
+
+    /**
+     * @brief find_header_slot() for a zero terminated name
+     */
+    header_slot find_header_slot(const char* name);
 }
 
 #endif /* SIOUX_SOURCE_HEADER_NAMES_H_ */
@@ -0,0 +1,63 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "http/header_names.h"
+#include <string>
+
+namespace {
+    const char * const * const all_slot_names[] = {
+        &http::content_type_header,
+        &http::content_length_header,
+        &http::transfer_encoding_header,
+        &http::etag_header,
+        &http::last_modified_header,
+        &http::if_none_match_header,
+        &http::if_modified_since_header,
+        &http::range_header,
+        &http::if_range_header,
+        &http::content_range_header,
+        &http::accept_encoding_header,
+        &http::content_encoding_header,
+        &http::vary_header,
+        &http::connection_header,
+        &http::host_header
+    };
+}
+
+/**
+ * @test every well known header name is found in its own slot
+ */
+BOOST_AUTO_TEST_CASE( all_well_known_names_have_a_slot )
+{
+    BOOST_REQUIRE_EQUAL( sizeof all_slot_names / sizeof all_slot_names[ 0 ], std::size_t( http::number_of_header_slots ) );
+
+    for ( int slot = 0; slot != http::number_of_header_slots; ++slot )
+        BOOST_CHECK_EQUAL( http::find_header_slot( *all_slot_names[ slot ] ), slot );
+}
+
+/**
+ * @test the slot of a header name is found case insensitive
+ */
+BOOST_AUTO_TEST_CASE( header_slots_are_case_insensitive )
+{
+    BOOST_CHECK_EQUAL( http::find_header_slot( "content-length" ), http::content_length_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "CONNECTION" ), http::connection_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "hOsT" ), http::host_slot );
+
+    const std::string name = "Transfer-EncodingXX";
+    BOOST_CHECK_EQUAL( http::find_header_slot( name.data(), name.data() + 17 ), http::transfer_encoding_slot );
+}
+
+/**
+ * @test other names, even with the same hash value, are not well known
+ */
+BOOST_AUTO_TEST_CASE( unknown_header_names_have_no_slot )
+{
+    BOOST_CHECK_EQUAL( http::find_header_slot( "" ), http::no_header_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "User-Agent" ), http::no_header_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "Hast" ), http::no_header_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "Content-Lengt" ), http::no_header_slot );
+    BOOST_CHECK_EQUAL( http::find_header_slot( "Content-Lengths" ), http::no_header_slot );
+}
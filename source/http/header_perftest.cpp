@@ -0,0 +1,253 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+/*
+ * micro benchmark for request header processing
+ *
+ * Replays a corpus of request heads and measures request_header parsing, find_header(), filtering of
+ * hop-by-hop headers with http::filter and split_url(). For every step, the time per request, the throughput in
+ * bytes of request heads per second and the number of memory allocations per request are reported.
+ *
+ * By default, the synthetic corpus from http/request_corpus.h is replayed. A different corpus, for example recorded
+ * traffic, can be given as a file, that contains the request heads one after another, each terminated by an empty
+ * line. Lines might end with \n or \r\n.
+ *
+ * usage: header_perftest [iterations [corpus-file]]
+ */
+
+#include "http/filter.h"
+#include "http/header_names.h"
+#include "http/parser.h"
+#include "http/request.h"
+#include "http/request_corpus.h"
+#include "tools/benchmark/measure.h"
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef std::vector< std::string > corpus_t;
+    typedef std::vector< boost::shared_ptr< http::request_header > > parsed_corpus_t;
+
+    corpus_t built_in_corpus()
+    {
+        return corpus_t( http::test::request_corpus, http::test::request_corpus + http::test::request_corpus_size );
+    }
+
+    corpus_t read_corpus( const char* file_name )
+    {
+        std::ifstream input( file_name, std::ios::in | std::ios::binary );
+
+        if ( !input )
+            throw std::runtime_error( std::string( "unable to open corpus: " ) + file_name );
+
+        const std::string text( ( std::istreambuf_iterator< char >( input ) ), std::istreambuf_iterator< char >() );
+
+        corpus_t    result;
+        std::string request;
+        std::string line;
+
+        for ( std::string::size_type pos = 0; pos != text.size(); )
+        {
+            const std::string::size_type eol = text.find( '\n', pos );
+            const std::string::size_type end = eol == std::string::npos ? text.size() : eol + 1;
+
+            line.assign( text, pos, end - pos );
+            pos = end;
+
+            if ( !line.empty() && line[ line.size() - 1 ] == '\n' )
+                line.erase( line.size() - 1 );
+
+            if ( !line.empty() && line[ line.size() - 1 ] == '\r' )
+                line.erase( line.size() - 1 );
+
+            if ( line.empty() && request.empty() )
+                continue;
+
+            request += line + "\r\n";
+
+            if ( line.empty() )
+            {
+                result.push_back( request );
+                request.clear();
+            }
+        }
+
+        if ( result.empty() )
+            throw std::runtime_error( std::string( "no request heads found in: " ) + file_name );
+
+        return result;
+    }
+
+    std::size_t corpus_bytes( const corpus_t& corpus )
+    {
+        std::size_t result = 0;
+
+        for ( corpus_t::const_iterator request = corpus.begin(); request != corpus.end(); ++request )
+            result += request->size();
+
+        return result;
+    }
+
+    // feeds the text in chunks, as large as the read_buffer() offered by the request, just like a connection does
+    bool parse( http::request_header& request, const std::string& text )
+    {
+        bool done = false;
+
+        for ( std::string::size_type pos = 0; !done && pos != text.size(); )
+        {
+            const std::pair< char*, std::size_t > buffer = request.read_buffer();
+            const std::size_t size = std::min( buffer.second, text.size() - pos );
+
+            std::copy( text.begin() + pos, text.begin() + pos + size, buffer.first );
+            pos += size;
+            done = request.parse( size );
+        }
+
+        return done && request.state() == http::request_header::ok;
+    }
+
+    parsed_corpus_t parse_corpus( const corpus_t& corpus )
+    {
+        parsed_corpus_t result;
+
+        for ( corpus_t::const_iterator text = corpus.begin(); text != corpus.end(); ++text )
+        {
+            const boost::shared_ptr< http::request_header > request( new http::request_header );
+
+            if ( !parse( *request, *text ) )
+                throw std::runtime_error( "unable to parse request from corpus:\n" + *text );
+
+            result.push_back( request );
+        }
+
+        return result;
+    }
+
+    // the steps to measure; each step returns a value depending on its result, to keep the optimizer honest
+
+    struct parse_step
+    {
+        explicit parse_step( const corpus_t& corpus ) : corpus_( corpus ) {}
+
+        std::size_t operator()( std::size_t index ) const
+        {
+            http::request_header request;
+
+            if ( !parse( request, corpus_[ index ] ) )
+                throw std::runtime_error( "unable to parse request" );
+
+            return request.headers().size();
+        }
+
+        const corpus_t& corpus_;
+    };
+
+    struct find_header_step
+    {
+        explicit find_header_step( const parsed_corpus_t& corpus ) : corpus_( corpus ) {}
+
+        std::size_t operator()( std::size_t index ) const
+        {
+            static const char* const names[] = {
+                http::content_length_header, http::host_header, http::connection_header,  // slotted headers
+                "Cookie", "User-Agent", "Origin", "X-Forwarded-For" };                    // searched headers
+
+            const http::request_header& request = *corpus_[ index ];
+            std::size_t                 result  = 0;
+
+            for ( const char* const* name = names; name != names + sizeof names / sizeof names[ 0 ]; ++name )
+                result += request.find_header( *name ) != 0;
+
+            return result;
+        }
+
+        const parsed_corpus_t& corpus_;
+    };
+
+    struct filter_step
+    {
+        explicit filter_step( const parsed_corpus_t& corpus )
+            : corpus_( corpus )
+            , hop_by_hop_( "Connection, Keep-Alive, Proxy-Authenticate, Proxy-Authorization, TE, Trailers, "
+                           "Transfer-Encoding, Upgrade" )
+            , result_()
+        {
+        }
+
+        // filters like the proxy does: the static hop-by-hop headers plus the headers named in the Connection header
+        std::size_t operator()( std::size_t index ) const
+        {
+            const http::request_header& request    = *corpus_[ index ];
+            const http::header* const   connection = request.find_header( http::connection_header );
+
+            request.filtered_request_text(
+                hop_by_hop_, connection ? connection->value() : tools::substring(), result_ );
+
+            return result_.size();
+        }
+
+        const parsed_corpus_t&                  corpus_;
+        const http::filter                      hop_by_hop_;
+        mutable std::vector< tools::substring > result_;
+    };
+
+    struct split_url_step
+    {
+        explicit split_url_step( const parsed_corpus_t& corpus ) : corpus_( corpus ) {}
+
+        std::size_t operator()( std::size_t index ) const
+        {
+            tools::substring scheme, authority, path, query, fragment;
+            http::split_url( corpus_[ index ]->uri(), scheme, authority, path, query, fragment );
+
+            return path.size() + query.size();
+        }
+
+        const parsed_corpus_t& corpus_;
+    };
+
+    template < class Step >
+    void measure( const char* name, const corpus_t& corpus, unsigned iterations, const Step& step )
+    {
+        std::cout << std::left << std::setw( 14 ) << name << std::right;
+        tools::benchmark::print( std::cout, tools::benchmark::measure( name, corpus, iterations, step ), "request" );
+    }
+}
+
+int main( int argc, const char* argv[] )
+{
+    try
+    {
+        const unsigned          iterations = argc > 1 ? std::atoi( argv[ 1 ] ) : 20000;
+        const corpus_t          corpus     = argc > 2 ? read_corpus( argv[ 2 ] ) : built_in_corpus();
+        const parsed_corpus_t   parsed     = parse_corpus( corpus );
+
+        if ( iterations == 0 )
+            throw std::runtime_error( "iterations must be greater than 0" );
+
+        std::cout << "corpus: " << corpus.size() << " requests, " << corpus_bytes( corpus ) << " bytes, "
+                  << iterations << " iterations\n";
+        std::cout << std::fixed << std::setprecision( 1 );
+
+        measure( "parse", corpus, iterations, parse_step( corpus ) );
+        measure( "find_header", corpus, iterations, find_header_step( parsed ) );
+        measure( "filter", corpus, iterations, filter_step( parsed ) );
+        measure( "split_url", corpus, iterations, split_url_step( parsed ) );
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/line_scanner.h"
+namespace http
+{
+    namespace {
+        const char* find_CR_scalar( const char* begin, const char* end )
+        {
+            for ( ; begin != end && *begin != '\r'; ++begin )
+                ;
+
+            return begin;
+        }
+
+#   ifdef SIOUX_SSE2
+        const char* find_CR_sse2( const char* begin, const char* end )
+        {
+            const __m128i cr = _mm_set1_epi8( '\r' );
+
+            for ( ; end - begin >= 16; begin += 16 )
+            {
+                const __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( begin ) );
+                const int     found = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, cr ) );
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return find_CR_scalar( begin, end );
+        }
+#   endif
+
+#   ifdef SIOUX_AVX2
+        SIOUX_AVX2_FUNCTION
+        const char* find_CR_avx2( const char* begin, const char* end )
+        {
+            const __m256i cr = _mm256_set1_epi8( '\r' );
+
+            for ( ; end - begin >= 32; begin += 32 )
+            {
+                const __m256i chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( begin ) );
+                const int     found = _mm256_movemask_epi8( _mm256_cmpeq_epi8( chunk, cr ) );
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return find_CR_sse2( begin, end );
+        }
+#   endif
+
+        // the implementations of find_CR() and the one, find_CR( begin, end ) uses
+        tools::scanner_dispatch& scanner()
+        {
+            static tools::scanner_dispatch dispatch(
+                &find_CR_scalar,
+                SIOUX_IF_SSE2( &find_CR_sse2 ),
+                SIOUX_IF_AVX2( &find_CR_avx2 ) );
+
+            return dispatch;
+        }
+    }
+
+    const char* find_CR( const char* begin, const char* end )
+    {
+        return scanner()( begin, end );
+    }
+
+    const char* find_CR( const char* begin, const char* end, tools::simd_isa isa )
+    {
+        return scanner().get( isa )( begin, end );
+    }
+
+    void select_line_scanner( tools::simd_isa isa )
+    {
+        scanner().select( isa );
+    }
+}
@@ -0,0 +1,34 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_HTTP_LINE_SCANNER_H
+#define SIOUX_SOURCE_HTTP_LINE_SCANNER_H
+
+#include "tools/simd.h"
+
+namespace http
+{
+    /**
+     * @brief returns a pointer to the first carriage return in [begin, end) or end, if there is none
+     *
+     * The implementation is chosen at runtime, the first time the function is called, or by select_line_scanner().
+     */
+    const char* find_CR( const char* begin, const char* end );
+
+    /**
+     * @brief find_CR() with an explicitly chosen implementation
+     * @pre isa <= tools::available_simd_isa()
+     */
+    const char* find_CR( const char* begin, const char* end, tools::simd_isa isa );
+
+    /**
+     * @brief chooses the implementation, that find_CR( begin, end ) uses from now on
+     *
+     * Intended for benchmarks, that compare the parsers with the different implementations. Not thread safe.
+     * @pre isa <= tools::available_simd_isa()
+     */
+    void select_line_scanner( tools::simd_isa isa );
+}
+
+#endif // include guard
@@ -0,0 +1,72 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "http/line_scanner.h"
+#include <cstring>
+#include <string>
+
+/**
+ * @test all available implementations of find_CR() find the first CR for all positions, lengths and alignments
+ */
+BOOST_AUTO_TEST_CASE( all_line_scanners_find_the_first_CR )
+{
+    const std::size_t max_size = 100;
+    char buffer[ max_size + 32 ];
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+    {
+        for ( std::size_t offset = 0; offset != 32; ++offset )
+        {
+            char* const begin = buffer + offset;
+
+            for ( std::size_t size = 0; size <= max_size; ++size )
+            {
+                std::memset( buffer, 'a', sizeof buffer );
+
+                // no CR at all, but behind the end
+                begin[ size ] = '\r';
+                BOOST_REQUIRE( http::find_CR( begin, begin + size, static_cast< tools::simd_isa >( isa ) )
+                    == begin + size );
+
+                for ( std::size_t cr = 0; cr < size; ++cr )
+                {
+                    begin[ cr ] = '\r';
+                    BOOST_REQUIRE( http::find_CR( begin, begin + size, static_cast< tools::simd_isa >( isa ) )
+                        == begin + cr );
+                    begin[ cr ] = 'a';
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @test find_CR() without explicit implementation
+ */
+BOOST_AUTO_TEST_CASE( find_CR_with_the_available_scanner )
+{
+    const std::string text = "GET / HTTP/1.1\r\nHost: foo.bar\r\n\r\n";
+
+    BOOST_CHECK( http::find_CR( text.data(), text.data() + text.size() ) == text.data() + 14 );
+    BOOST_CHECK( http::find_CR( text.data(), text.data() + 14 ) == text.data() + 14 );
+    BOOST_CHECK( http::find_CR( text.data() + 15, text.data() + text.size() ) == text.data() + 29 );
+}
+
+/**
+ * @test find_CR() uses the selected implementation
+ */
+BOOST_AUTO_TEST_CASE( find_CR_with_selected_scanner )
+{
+    const std::string text = "GET / HTTP/1.1\r\nHost: foo.bar\r\n\r\n";
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+    {
+        http::select_line_scanner( static_cast< tools::simd_isa >( isa ) );
+        BOOST_CHECK( http::find_CR( text.data(), text.data() + text.size() ) == text.data() + 14 );
+        BOOST_CHECK( http::find_CR( text.data() + 15, text.data() + text.size() ) == text.data() + 29 );
+    }
+
+    http::select_line_scanner( tools::available_simd_isa() );
+}
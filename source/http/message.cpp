@@ -6,54 +6,186 @@
 #include "http/request.h"
 #include "http/response.h"
 #include "http/filter.h"
+#include "http/line_scanner.h"
 #include "http/parser.h"
 #include "tools/split.h"
+#include <boost/detail/atomic_count.hpp>
+#include <boost/static_assert.hpp>
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <new>
 
 
 namespace http {
 
+    namespace {
+        const std::size_t smallest_buffer = message_base< request_header >::initial_buffer_size;
+
+        // pools for 512 bytes up to 1MB
+        const std::size_t number_of_pools = 12;
+        const std::size_t largest_buffer  = smallest_buffer << ( number_of_pools - 1 );
+
+        struct header_pools
+        {
+            header_pools()
+            {
+                // every header starts with a small buffer, so keep more of them
+                for ( std::size_t i = 0; i != number_of_pools; ++i )
+                    pools[ i ] = new tools::buffer_pool( smallest_buffer << i, std::max< std::size_t >( 1024 >> i, 4 ) );
+            }
+
+            tools::buffer_pool* pools[ number_of_pools ];
+        };
+
+        std::size_t size_limit = 64 * 1024;
+
+        // every buffer starts with a reference count, as consecutive headers share a buffer
+        struct buffer_header
+        {
+            buffer_header() : references(1) {}
+
+            boost::detail::atomic_count references;
+        };
+
+        // keeps the text behind the reference count aligned
+        const std::size_t buffer_overhead = 16;
+        BOOST_STATIC_ASSERT( sizeof( buffer_header ) <= buffer_overhead );
+
+        buffer_header& header_of(char* buffer)
+        {
+            return *reinterpret_cast<buffer_header*>(buffer - buffer_overhead);
+        }
+
+        void add_reference(char* buffer)
+        {
+            ++header_of(buffer).references;
+        }
+
+        void release_reference(char* buffer, std::size_t size)
+        {
+            buffer_header& counter = header_of(buffer);
+
+            if ( --counter.references == 0 )
+            {
+                counter.~buffer_header();
+                header_buffer_pool(size + buffer_overhead).release(buffer - buffer_overhead);
+            }
+        }
+
+        tools::substring moved(const tools::substring& s, const char* from, char* to)
+        {
+            return tools::substring(to + (s.begin() - from), to + (s.end() - from));
+        }
+
+        // appends the line [begin, end) and the following CRLF
+        void add_line(std::vector<tools::substring>& text, const char* begin, const char* end)
+        {
+            if ( !text.empty() && text.back().end() == begin )
+            {
+                text.back() = tools::substring(text.back().begin(), end + 2);
+            }
+            else
+            {
+                text.push_back(tools::substring(begin, end + 2));
+            }
+        }
+    }
+
+    tools::buffer_pool& header_buffer_pool( std::size_t block_size )
+    {
+        // the pools are never destroyed, as header objects with static storage duration might outlive them
+        static const header_pools* const pools = new header_pools;
+
+        std::size_t index = 0;
+        for ( ; ( smallest_buffer << index ) < block_size; ++index )
+            ;
+
+        assert( index < number_of_pools && ( smallest_buffer << index ) == block_size );
+
+        return *pools->pools[ index ];
+    }
+
+    std::size_t header_size_limit()
+    {
+        return size_limit;
+    }
+
+    void set_header_size_limit( std::size_t limit )
+    {
+        assert( limit >= smallest_buffer );
+        size_limit = limit;
+    }
+
     //////////////////////////
     // class request_header
+    template <class Type>
+    const std::size_t message_base<Type>::initial_buffer_size;
+
     template <class Type>
     message_base<Type>::message_base()
-        : write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , allocated_size_(0)
+        , start_ptr_(0)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_(parsing)
         , parser_state_(expect_request_line)
     {
+        std::fill(header_slots_, header_slots_ + number_of_header_slots, 0);
+        allocate_buffer(0);
     }
     
     template <class Type>
-    message_base<Type>::message_base(const Type& old_header, std::size_t& remaining, copy_trailing_buffer_t)
-        : write_ptr_(0)
+    message_base<Type>::message_base(const Type& old_header, std::size_t& remaining, share_trailing_buffer_t)
+        : buffer_(0)
+        , buffer_size_(0)
+        , allocated_size_(0)
+        , start_ptr_(0)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_(parsing)
         , parser_state_(expect_request_line)
     {
-        std::copy(&old_header.buffer_[old_header.parse_ptr_], &old_header.buffer_[old_header.write_ptr_], &buffer_[0]);
+        std::fill(header_slots_, header_slots_ + number_of_header_slots, 0);
         remaining = old_header.write_ptr_ - old_header.parse_ptr_;
 
-        // the last request_header must have signaled a buffer-full error
-        assert(remaining != sizeof buffer_);
+        if ( remaining == 0 )
+        {
+            allocate_buffer(0);
+        }
+        else
+        {
+            // continue behind the old header in its buffer
+            add_reference(old_header.buffer_);
+
+            buffer_         = old_header.buffer_;
+            buffer_size_    = old_header.buffer_size_;
+            allocated_size_ = buffer_size_ + buffer_overhead;
+            start_ptr_      = write_ptr_ = parse_ptr_ = read_ptr_ = old_header.parse_ptr_;
+        }
     }
 
     template <class Type>
     message_base<Type>::message_base(const boost::asio::const_buffers_1& old_body, std::size_t& remaining)
-    	: write_ptr_(0)
+    	: buffer_(0)
+    	, buffer_size_(0)
+    	, allocated_size_(0)
+    	, start_ptr_(0)
+    	, write_ptr_(0)
     	, parse_ptr_(0)
     	, read_ptr_(0)
     	, error_(parsing)
     	, parser_state_(expect_request_line)
     {
+    	std::fill(header_slots_, header_slots_ + number_of_header_slots, 0);
     	const char* const buffer = boost::asio::buffer_cast< const char* >( old_body );
     	const std::size_t size   = boost::asio::buffer_size( old_body );
 
-    	if ( size > sizeof buffer_ )
+    	if ( !allocate_buffer( size ) )
     		throw std::runtime_error( "unable to store old_body" );
 
     	std::copy( buffer, buffer + size, &buffer_[0]);
@@ -62,23 +194,129 @@ namespace http {
     
     template <class Type>
     message_base<Type>::message_base(const char* source)
-        : write_ptr_(0)
+        : buffer_(0)
+        , buffer_size_(0)
+        , allocated_size_(0)
+        , start_ptr_(0)
+        , write_ptr_(0)
         , parse_ptr_(0)
         , read_ptr_(0)
         , error_( parsing )
         , parser_state_(expect_request_line)
     {
-        const std::size_t max = std::min(sizeof buffer_, std::strlen(source));
-        std::strncpy(buffer_, source, max);
+        std::fill(header_slots_, header_slots_ + number_of_header_slots, 0);
+
+        // try to store the whole text, so that unparsed_buffer() contains all data behind the header
+        const std::size_t length = std::strlen(source);
+
+        if ( !allocate_buffer(length) )
+            allocate_buffer(0);
+
+        for ( std::size_t pos = 0; pos != length && error_ == parsing; )
+        {
+            const std::pair<char*, std::size_t> buffer = read_buffer();
+            const std::size_t                   size   = std::min(length - pos, buffer.second);
+
+            std::copy(source + pos, source + pos + size, buffer.first);
+            pos += size;
+
+            parse(size);
+        }
+    }
+
+    template <class Type>
+    message_base<Type>::~message_base()
+    {
+        for ( typename std::vector<filled_buffer>::const_iterator b = filled_buffers_.begin(); b != filled_buffers_.end(); ++b )
+            release_reference(b->begin, b->size);
 
-        parse(max);
+        release_reference(buffer_, buffer_size_);
+    }
+
+    template <class Type>
+    bool message_base<Type>::allocate_buffer(std::size_t min_size)
+    {
+        std::size_t size = initial_buffer_size;
+        for ( ; size < min_size + buffer_overhead; size *= 2 )
+            ;
+
+        if ( size > largest_buffer || allocated_size_ + size > header_size_limit() )
+            return false;
+
+        char* const block = header_buffer_pool(size).allocate();
+        new (block) buffer_header;
+
+        buffer_          = block + buffer_overhead;
+        buffer_size_     = size - buffer_overhead;
+        allocated_size_ += size;
+
+        return true;
+    }
+
+    template <class Type>
+    void message_base<Type>::grow_buffer()
+    {
+        assert(write_ptr_ == buffer_size_);
+
+        // a continuation line would extend the last header, so if the last header is the last line in the buffer,
+        // the header has to move too.
+        std::size_t keep = parse_ptr_;
+
+        if ( parser_state_ == expect_header && !headers_.empty() && headers_.back().end() + 2 == &buffer_[parse_ptr_] )
+            keep = headers_.back().begin() - &buffer_[0];
+
+        char* const         old_buffer = buffer_;
+        const std::size_t   old_size   = buffer_size_;
+        const std::size_t   old_start  = start_ptr_;
+        const std::size_t   freed_size = keep == old_start ? old_size + buffer_overhead : 0;
+
+        // if the buffer was started by a previous header, a buffer for the unparsed data is sufficient
+        const std::size_t   new_size   = old_start == 0 ? 2 * old_size : 2 * ( write_ptr_ - keep );
+
+        if ( keep != old_start )
+            filled_buffers_.reserve(filled_buffers_.size() + 1);
+
+        allocated_size_ -= freed_size;
+
+        if ( !allocate_buffer(new_size) )
+        {
+            allocated_size_ += freed_size;
+            error_ = buffer_full;
+
+            return;
+        }
+
+        std::copy(old_buffer + keep, old_buffer + write_ptr_, buffer_);
+
+        if ( keep != parse_ptr_ )
+        {
+            header& last = headers_.back();
+            const char* const from = old_buffer + keep;
+
+            last = header(moved(last.all_, from, buffer_), moved(last.name_, from, buffer_), moved(last.value_, from, buffer_));
+        }
+
+        if ( keep == old_start )
+        {
+            release_reference(old_buffer, old_size);
+        }
+        else
+        {
+            const filled_buffer filled = { old_buffer, old_size, old_start, keep };
+            filled_buffers_.push_back(filled);
+        }
+
+        start_ptr_  = 0;
+        write_ptr_ -= keep;
+        parse_ptr_ -= keep;
+        read_ptr_  -= keep;
     }
 
     template <class Type>
     std::pair<char*, std::size_t> message_base<Type>::read_buffer()
     {
-        assert(write_ptr_ <= sizeof buffer_);
-        return std::make_pair(&buffer_[write_ptr_], sizeof buffer_ - write_ptr_);
+        assert(write_ptr_ < buffer_size_);
+        return std::make_pair(&buffer_[write_ptr_], buffer_size_ - write_ptr_);
     }
     
     template <class Type>
@@ -100,7 +338,7 @@ namespace http {
         assert( error_ == parsing );
         write_ptr_ += size;
 
-        assert( write_ptr_ <= sizeof buffer_ );
+        assert( write_ptr_ <= buffer_size_ );
 
         for ( std::size_t i = read_ptr_; error_ == parsing && read_ptr_ != write_ptr_; )
         {
@@ -108,17 +346,16 @@ namespace http {
             assert(parse_ptr_ < write_ptr_);
             assert(parse_ptr_ <= read_ptr_);
 
-            // seek for CR         
-            for ( ; i != write_ptr_-1 && buffer_[i] != '\r'; ++i )
-                ;
+            // seek for CR
+            i = http::find_CR(&buffer_[i], &buffer_[write_ptr_-1]) - &buffer_[0];
 
             // no \r found, restart seeking at the currently last buffer position
             if ( i == write_ptr_-1 )
             {
                 read_ptr_  = i;
 
-                if ( write_ptr_ == sizeof buffer_ )
-                    error_ = buffer_full;
+                if ( write_ptr_ == buffer_size_ )
+                    grow_buffer();
 
                 return error_ != parsing;
             }
@@ -138,8 +375,8 @@ namespace http {
             }
         }
 
-        if ( write_ptr_ == sizeof buffer_ && error_ == parsing )
-            error_ = buffer_full;
+        if ( write_ptr_ == buffer_size_ && error_ == parsing )
+            grow_buffer();
 
         return error_ != parsing;
     }
@@ -201,6 +438,11 @@ namespace http {
         else if ( h.parse(start, end) )
         {
             headers_.push_back(h);
+
+            const header_slot slot = find_header_slot(h.name_.begin(), h.name_.end());
+
+            if ( slot != no_header_slot && header_slots_[slot] == 0 )
+                header_slots_[slot] = static_cast<unsigned short>(headers_.size());
         }
         else
         {
@@ -242,9 +484,20 @@ namespace http {
     }
 
     template <class Type>
-    tools::substring message_base<Type>::text() const
+    std::string message_base<Type>::text() const
+    {
+        std::string result;
+
+        for ( typename std::vector<filled_buffer>::const_iterator b = filled_buffers_.begin(); b != filled_buffers_.end(); ++b )
+            result.append(b->begin + b->start, b->used - b->start);
+
+        return result.append(&buffer_[start_ptr_], parse_ptr_ - start_ptr_);
+    }
+
+    template <class Type>
+    std::size_t message_base<Type>::allocated_size() const
     {
-        return tools::substring(&buffer_[0], &buffer_[parse_ptr_]);
+        return allocated_size_;
     }
 
     template <class Type>
@@ -285,6 +538,11 @@ namespace http {
     template <class Type>
     const typename message_base<Type>::header* message_base<Type>::find_header_impl(const char* header_name) const
     {
+        const header_slot slot = find_header_slot(header_name);
+
+        if ( slot != no_header_slot )
+            return header_slots_[slot] != 0 ? &headers_[header_slots_[slot] - 1] : 0;
+
         std::vector<header>::const_iterator h = headers_.begin();
         for ( ; h != headers_.end() && http::strcasecmp(h->name_.begin(), h->name_.end(), header_name) != 0; ++h )
             ;
@@ -295,43 +553,42 @@ namespace http {
     template <class Type>
     bool message_base<Type>::close_after_response() const
     {
-        return error_ != ok || milli_version() < 1001 || option_available("connection", "close");
+        return error_ != ok || milli_version() < 1001 || option_available(connection_header, "close");
     }
 
     template <class Type>
     std::vector<tools::substring> message_base<Type>::filtered_request_text(const http::filter& not_wanted_header) const
     {
-        assert(error_ == ok);
         std::vector<tools::substring>   result;
+        filtered_request_text(not_wanted_header, tools::substring(), result);
 
-        tools::substring::iterator current_start = start_line_.begin();
-        tools::substring::iterator current_end   = start_line_.end();
+        return result;
+    }
 
-        // add headers
-        for ( header_list_t::const_iterator h = headers_.begin(); h != headers_.end(); ++h )
-        {
-            if ( not_wanted_header(h->name()) )
-            {
-                if ( current_start != current_end )
-                    result.push_back( tools::substring(current_start, current_end) );
+    template <class Type>
+    void message_base<Type>::filtered_request_text(const http::filter& not_wanted_header,
+        const tools::substring& not_wanted_list, std::vector<tools::substring>& result) const
+    {
+        assert(error_ == ok);
+        result.clear();
 
-                current_start = h->end();
-            }
+        // the lines might be stored in different buffers
+        add_line(result, start_line_.begin(), start_line_.end());
 
-            current_end = h->end();
+        for ( header_list_t::const_iterator h = headers_.begin(); h != headers_.end(); ++h )
+        {
+            if ( !not_wanted_header(h->name()) && ( not_wanted_list.empty() || !listed(not_wanted_list, h->name()) ) )
+                add_line(result, h->begin(), h->end());
         }
 
-        // current_start now points to the end of the last header, if that was filtered out or
-        // to the start of that part of the header that has to be included.
-        result.push_back(tools::substring(current_start, &buffer_[parse_ptr_]));
-
-        return result;
+        // the final empty line
+        add_line(result, &buffer_[parse_ptr_ - 2], &buffer_[parse_ptr_ - 2]);
     }
 
     template <class Type>
     bool message_base<Type>::empty() const
     {
-        return read_ptr_ == 0;
+        return read_ptr_ == start_ptr_;
     }
 
     template <class Type>
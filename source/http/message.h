@@ -7,8 +7,12 @@
 
 #include "http/http.h"
 #include "http/header.h"
+#include "http/header_names.h"
+#include "tools/buffer_pool.h"
 #include <boost/asio/buffer.hpp>
 #include <iosfwd>
+#include <string>
+#include <vector>
 
 namespace http 
 {
@@ -23,7 +27,7 @@ namespace http
         {
             /** request is parsed and valid */
             ok,
-            /** request couldn't be parsed, because an internal buffer is full */
+            /** request couldn't be parsed, because the header is larger than header_size_limit() */
             buffer_full,
             /** the request contains syntactical errors */
             syntax_error,
@@ -36,6 +40,31 @@ namespace http
 
     std::ostream& operator<<(std::ostream& out, message::error_code e);
 
+    /**
+     * @brief the pool, the buffers of request and response headers with the given size are taken from
+     *
+     * Taking the buffers from a pool keeps the header objects small and allows a connection to give up its header
+     * buffer while it waits for the next request. There is a pool for every power of two from
+     * message_base<>::initial_buffer_size up to 1MB.
+     *
+     * @pre block_size is one of these sizes
+     */
+    tools::buffer_pool& header_buffer_pool( std::size_t block_size );
+
+    /**
+     * @brief the maximum number of bytes, a request or response header allocates to store its text
+     *
+     * A header that doesn't fit into this limit is rejected with a buffer_full error. The default is 64KB.
+     */
+    std::size_t header_size_limit();
+
+    /**
+     * @brief changes the header_size_limit() for all headers that are constructed afterwards
+     *
+     * The limit should be changed before the first header is constructed.
+     */
+    void set_header_size_limit( std::size_t limit );
+
     /**
      * @brief base class for request_header and response_header
      */
@@ -43,7 +72,16 @@ namespace http
     class message_base : public message
     {
     public:
-        enum copy_trailing_buffer_t { copy_trailing_buffer };
+        enum share_trailing_buffer_t { share_trailing_buffer };
+
+        /**
+         * @brief the size of the first buffer of a header
+         *
+         * If the header doesn't fit, the next buffer is twice as large, until header_size_limit() is reached.
+         * A header, that was received behind an other header, starts in the buffer of the previous header.
+         * Lines, that are completely received, are never moved, so all tools::substrings stay valid.
+         */
+        static const std::size_t initial_buffer_size = 512;
 
         /**
          * @brief returns the write pointer and remaining buffer size 
@@ -88,9 +126,14 @@ namespace http
         unsigned                milli_version() const;
 
         /**
-         * @brief the whole request text including the final empty line with trailing \\r\n
+         * @brief a copy of the whole request text including the final empty line with trailing \\r\n
          */
-        tools::substring        text() const;
+        std::string             text() const;
+
+        /**
+         * @brief the number of bytes, allocated to store the header text
+         */
+        std::size_t             allocated_size() const;
 
         bool option_available(const char* header_name, const char* option) const;
 
@@ -102,6 +145,8 @@ namespace http
          * not case sensitive.
          * Trailing and leading \\r\n and tabs and spaces are removed in the returned value. If 
          * the header values spawns multiple lines, \\r\n within the value are _not_ removed.
+         * The headers listed in header_names.h are found without searching. If there are multiple
+         * headers with the same name, the first is returned.
          */
         const header* find_header(const char* header_name) const;
 
@@ -117,6 +162,16 @@ namespace http
          */
         std::vector<tools::substring> filtered_request_text(const http::filter&) const;
 
+        /**
+         * @brief filters the headers given by the filter and the headers named in the comma separated list
+         * not_wanted_list, for example the value of a Connection header, from the request
+         *
+         * The result is written to result, which is cleared first. Reusing the result for multiple headers avoids
+         * memory allocations.
+         */
+        void filtered_request_text(const http::filter& not_wanted_header, const tools::substring& not_wanted_list,
+            std::vector<tools::substring>& result) const;
+
         /**
          * @brief returns true, if no single byte was received and buffered
          */
@@ -139,11 +194,14 @@ namespace http
          * @attention after constructing a request header this way, it might be possible
          * that this header is too already complete.
          *
+         * The new header shares the buffer with the old header, so the remaining data is not copied and the
+         * the next data is received into the same buffer behind the remaining data.
+         *
          * @param old_header the header that contains data, that doesn't belongs to the previous htt-header
          * @param remaining returns the unparsed bytes. If not 0, parse() can be called with this
          * information.
          */
-        message_base(const Type& old_header, std::size_t& remaining, copy_trailing_buffer_t);
+        message_base(const Type& old_header, std::size_t& remaining, share_trailing_buffer_t);
 
         message_base(const boost::asio::const_buffers_1& old_body, std::size_t& remaining);
 
@@ -152,7 +210,7 @@ namespace http
          */
         explicit message_base(const char*);
 
-        ~message_base() {}
+        ~message_base();
 
         bool parse_version(const tools::substring& version_text);
 
@@ -170,7 +228,27 @@ namespace http
 
         void parse_error();
 
-        char                        buffer_[ 4 * 1024 ];
+        // allocates a buffer of at least min_size bytes, returns false, if the header_size_limit() would be exceeded
+        bool allocate_buffer(std::size_t min_size);
+
+        // moves the unparsed data into a larger buffer or sets error_ to buffer_full
+        void grow_buffer();
+
+        struct filled_buffer
+        {
+            char*                   begin;
+            std::size_t             size;
+            std::size_t             start;
+            std::size_t             used;
+        };
+
+        // buffers, that are full and contain the first lines of the header
+        std::vector<filled_buffer>  filled_buffers_;
+        // buffers are reference counted and can be shared with the previous and the next header
+        char*                       buffer_;
+        std::size_t                 buffer_size_;
+        std::size_t                 allocated_size_;
+        std::size_t                 start_ptr_; // first byte of this header
         std::size_t                 write_ptr_;
         std::size_t                 parse_ptr_; // already consumed including trailing CRLF
         std::size_t                 read_ptr_;  // read, but no CRLF found so far
@@ -186,6 +264,9 @@ namespace http
         } parser_state_;
 
         header_list_t               headers_;
+
+        // index + 1 into headers_ of the first header with a well known name, 0 if there is no such header
+        unsigned short              header_slots_[ number_of_header_slots ];
     };
 
 } // namespace http 
@@ -9,6 +9,8 @@
 #include "tools/split.h"
 
 #include <boost/regex.hpp>
+#include <cassert>
+#include <iterator>
 #include <sstream>
 
 namespace http {
@@ -67,33 +69,88 @@ bad_query::bad_query( const std::string& s ) : std::runtime_error( s )
 {
 }
 
-static void add_name_value( std::vector< std::pair< tools::substring, tools::substring > >& result, const tools::substring& name_value )
+std::vector< std::pair< tools::substring, tools::substring > > split_query( const tools::substring& query )
 {
-    tools::substring name, value;
-    if ( tools::split_to_empty( name_value, '=', name, value ) )
-    {
-        result.push_back( std::make_pair( name, value ) );
-    }
-    else
-    {
-        throw bad_query( "bad-query: " + std::string( name_value.begin(), name_value.end() ) );
-    }
+    return std::vector< std::pair< tools::substring, tools::substring > >( query_iterator( query ), query_iterator() );
 }
 
-std::vector< std::pair< tools::substring, tools::substring > > split_query( const tools::substring& query )
+////////////////////////
+// class query_iterator
+query_iterator::query_iterator()
+    : rest_()
+    , end_( true )
+    , current_()
 {
-    std::vector< std::pair< tools::substring, tools::substring > > result;
+}
 
-    tools::substring second = query;
-    for ( tools::substring first, rest = query; tools::split_to_empty( rest, '&', first, second );  rest = second )
+query_iterator::query_iterator( const tools::substring& query )
+    : rest_( query )
+    , end_( false )
+    , current_()
+{
+    next();
+}
+
+query_iterator::reference query_iterator::operator*() const
+{
+    assert( !end_ );
+    return current_;
+}
+
+query_iterator::pointer query_iterator::operator->() const
+{
+    assert( !end_ );
+    return &current_;
+}
+
+query_iterator& query_iterator::operator++()
+{
+    next();
+    return *this;
+}
+
+query_iterator query_iterator::operator++( int )
+{
+    const query_iterator result( *this );
+    next();
+
+    return result;
+}
+
+bool query_iterator::operator==( const query_iterator& rhs ) const
+{
+    return end_ == rhs.end_ && ( end_ || rest_.begin() == rhs.rest_.begin() );
+}
+
+bool query_iterator::operator!=( const query_iterator& rhs ) const
+{
+    return !( *this == rhs );
+}
+
+void query_iterator::next()
+{
+    assert( !end_ );
+
+    if ( rest_.empty() )
     {
-        add_name_value( result, first );
+        end_ = true;
+        return;
     }
 
-    if ( !second.empty() )
-        add_name_value( result, second );
+    tools::substring name_value, second;
 
-    return result;
+    if ( tools::split_to_empty( rest_, '&', name_value, second ) )
+    {
+        rest_ = second;
+    }
+    else
+    {
+        name_value = rest_;
+        rest_ = tools::substring( rest_.end(), rest_.end() );
+    }
+
+    if ( !tools::split_to_empty( name_value, '=', current_.first, current_.second ) )
+        throw bad_query( "bad-query: " + std::string( name_value.begin(), name_value.end() ) );
 }
 
 
@@ -115,26 +172,34 @@ namespace {
 }
 
 namespace {
-    template < class Iter >
-    std::string url_decode( Iter i, Iter end )
+    // decodes %xx and, if plus_is_space is true, '+' into the output iterator out
+    template < class Iter, class Out >
+    Out decode( Iter i, Iter end, Out out, bool plus_is_space )
     {
-        std::string result;
-
-        for ( ; i != end; ++i )
+        for ( ; i != end; ++i, ++out )
         {
-            if ( *i != '%' )
-            {
-                result.push_back( *i );
-            }
-            else
+            if ( *i == '%' )
             {
                 int value = read_nibble( ++i, end ) * 16;
                 value += read_nibble( ++i, end );
 
-                result.push_back( static_cast< char >( value ) );
+                *out = static_cast< char >( value );
+            }
+            else
+            {
+                *out = plus_is_space && *i == '+' ? ' ' : *i;
             }
         }
 
+        return out;
+    }
+
+    template < class Iter >
+    std::string url_decode( Iter begin, Iter end )
+    {
+        std::string result;
+        decode( begin, end, std::back_inserter( result ), false );
+
         return result;
     }
 }
@@ -149,6 +214,11 @@ std::string url_decode( const tools::substring& s )
     return url_decode( s.begin(), s.end() );
 }
 
+char* url_decode( const char* begin, const char* end, char* out )
+{
+    return decode( begin, end, out, false );
+}
+
 static bool special( char c )
 {
     static const char not_encoded_chars[] = "-_.~";
@@ -183,10 +253,10 @@ namespace {
     template < class Iter >
     std::string form_decode_impl( Iter begin, Iter end )
     {
-        std::string result( begin, end );
-        std::replace( result.begin(), result.end(), '+', ' ' );
+        std::string result;
+        decode( begin, end, std::back_inserter( result ), true );
 
-        return url_decode( result.begin(), result.end() );
+        return result;
     }
 }
 
@@ -200,6 +270,11 @@ std::string form_decode( const tools::substring& s )
     return form_decode_impl( s.begin(), s.end() );
 }
 
+char* form_decode( const char* begin, const char* end, char* out )
+{
+    return decode( begin, end, out, true );
+}
+
 int strcasecmp(const char* begin1, const char* end1, const char* null_terminated_str)
 {
     for ( ; begin1 != end1 && *null_terminated_str; ++begin1, ++null_terminated_str)
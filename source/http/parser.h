@@ -7,6 +7,8 @@
 
 #include <string>
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <locale>
 #include <stdexcept>
 #include <limits>
@@ -189,6 +191,54 @@ public:
  */
 std::vector< std::pair< tools::substring, tools::substring > > split_query( const tools::substring& query );
 
+/**
+ * @brief forward iterator over the name, value pairs of a query, that splits the query while iterating
+ *
+ * Yields the same pairs as split_query(), without storing them. A broken name, value pair results in a bad_query
+ * exception, when the iterator is incremented to that pair.
+ *
+ * @code
+ * for ( query_iterator i( query ), end; i != end; ++i )
+ *     use( i->first, i->second );
+ * @endcode
+ */
+class query_iterator
+{
+public:
+    typedef std::forward_iterator_tag                               iterator_category;
+    typedef std::pair< tools::substring, tools::substring >         value_type;
+    typedef std::ptrdiff_t                                          difference_type;
+    typedef const value_type*                                       pointer;
+    typedef const value_type&                                       reference;
+
+    /**
+     * @brief constructs an end iterator
+     */
+    query_iterator();
+
+    /**
+     * @brief constructs an iterator, that points to the first name, value pair of query
+     * @exception bad_query if the first pair is broken
+     */
+    explicit query_iterator( const tools::substring& query );
+
+    reference operator*() const;
+    pointer operator->() const;
+
+    query_iterator& operator++();
+    query_iterator operator++( int );
+
+    bool operator==( const query_iterator& rhs ) const;
+    bool operator!=( const query_iterator& rhs ) const;
+
+private:
+    void next();
+
+    tools::substring    rest_;
+    bool                end_;
+    value_type          current_;
+};
+
 /**
  * @brief decodes all encoded characters
  *
@@ -202,6 +252,15 @@ std::string url_decode( const std::string& );
  */
 std::string url_decode( const tools::substring& );
 
+/**
+ * @brief decodes [begin, end) into the caller supplied buffer out and returns the end of the decoded text
+ *
+ * The decoded text is never longer than the encoded text, so out has to provide end - begin bytes. out can be
+ * equal to begin, to decode in place.
+ * @throw bad_url if no valid hex number follows after a % sign
+ */
+char* url_decode( const char* begin, const char* end, char* out );
+
 /**
  * @brief encodes the given string
  * see rfc3986 for details
@@ -220,6 +279,13 @@ std::string form_decode( const std::string& );
  */
 std::string form_decode( const tools::substring& );
 
+/**
+ * @brief decodes [begin, end) like form_decode() into the caller supplied buffer out
+ *
+ * @copydetails url_decode( const char*, const char*, char* )
+ */
+char* form_decode( const char* begin, const char* end, char* out );
+
 template <class Iter, typename SizeT>
 bool parse_number(Iter begin, Iter end, SizeT& r)
 {
@@ -158,3 +158,51 @@ BOOST_AUTO_TEST_CASE( form_decode_test )
 
     BOOST_CHECK_EQUAL( result, "  JK+");
 }
+
+BOOST_AUTO_TEST_CASE( url_decode_into_buffer )
+{
+    const char  text[] = "%20abc+%4a%4B";
+    char        buffer[ sizeof text ];
+
+    const char* const end = http::url_decode( text, text + sizeof text - 1, buffer );
+    BOOST_CHECK_EQUAL( std::string( static_cast< const char* >( buffer ), end ), " abc+JK" );
+
+    char form[] = "a+b%2B%25c";
+    const char* const form_end = http::form_decode( form, form + sizeof form - 1, form );
+    BOOST_CHECK_EQUAL( std::string( static_cast< const char* >( form ), form_end ), "a b+%c" );
+
+    BOOST_CHECK_THROW( http::url_decode( text, text + 2, buffer ), http::bad_url );
+}
+
+BOOST_AUTO_TEST_CASE( iterate_over_query )
+{
+    const char query[] = "action=%20foo%20&message=a+bs&key=";
+
+    http::query_iterator i( substr( query ) ), end;
+
+    BOOST_REQUIRE( i != end );
+    BOOST_CHECK_EQUAL( i->first, "action" );
+    BOOST_CHECK_EQUAL( i->second, "%20foo%20" );
+
+    BOOST_REQUIRE( ++i != end );
+    BOOST_CHECK_EQUAL( i->first, "message" );
+    BOOST_CHECK_EQUAL( ( *i ).second, "a+bs" );
+
+    const http::query_iterator last = ++i;
+    BOOST_REQUIRE( i != end );
+    BOOST_CHECK_EQUAL( i->first, "key" );
+    BOOST_CHECK_EQUAL( i->second, "" );
+
+    BOOST_CHECK( last == i++ );
+    BOOST_CHECK( i == end );
+    BOOST_CHECK( http::query_iterator( tools::substring() ) == end );
+}
+
+BOOST_AUTO_TEST_CASE( query_iterator_throws_at_buggy_pair )
+{
+    const char query[] = "action=%20foo%20&messageabs&key=";
+
+    http::query_iterator i( substr( query ) );
+    BOOST_CHECK_EQUAL( i->first, "action" );
+    BOOST_CHECK_THROW( ++i, http::bad_query );
+}
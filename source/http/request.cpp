@@ -29,8 +29,8 @@ namespace http {
     {
     }
 
-    request_header::request_header(const request_header& old_header, std::size_t& remaining, copy_trailing_buffer_t)
-        : message_base< request_header >( old_header, remaining, copy_trailing_buffer )
+    request_header::request_header(const request_header& old_header, std::size_t& remaining, share_trailing_buffer_t)
+        : message_base< request_header >( old_header, remaining, share_trailing_buffer )
     {
     }
 
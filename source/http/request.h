@@ -48,7 +48,7 @@ namespace http
          *
          * @pre state() returned ok
          */
-        request_header(const request_header& old_header, std::size_t& remaining, copy_trailing_buffer_t);
+        request_header(const request_header& old_header, std::size_t& remaining, share_trailing_buffer_t);
 
         /**
          * @brief constructs a new request_header with the remaining data past the
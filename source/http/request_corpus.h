@@ -0,0 +1,161 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_HTTP_REQUEST_CORPUS_H
+#define SIOUX_HTTP_REQUEST_CORPUS_H
+
+#include <cstddef>
+
+namespace http {
+namespace test {
+
+    /**
+     * @brief synthetic request heads, like browsers and cometd clients send them to a bayeux server
+     *
+     * The heads are hand-written, not recorded: host names, cookies and session ids are placeholders. The header
+     * sets and their order follow the respective clients. Used by header_perftest as a default mix of requests;
+     * recorded traffic can be passed to header_perftest as a corpus file.
+     */
+    const char* const request_corpus[] = {
+        // Chrome, initial page load
+        "GET /chat/index.html HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "Connection: keep-alive\r\n"
+        "Cache-Control: max-age=0\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: de-DE,de;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+        "Cookie: _ga=GA1.2.1234567890.1700000000; _gid=GA1.2.987654321.1700000000; lang=de\r\n"
+        "\r\n",
+
+        // Firefox, revalidating a cached script
+        "GET /chat/jquery/jquery.cometd.js?v=2.4.3 HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:121.0) Gecko/20100101 Firefox/121.0\r\n"
+        "Accept: */*\r\n"
+        "Accept-Language: de,en-US;q=0.7,en;q=0.3\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "Cookie: _ga=GA1.2.1234567890.1700000000; _gid=GA1.2.987654321.1700000000; lang=de\r\n"
+        "If-Modified-Since: Tue, 14 Nov 2023 09:12:44 GMT\r\n"
+        "If-None-Match: \"5f3a-60a1b2c3d4e5f\"\r\n"
+        "Cache-Control: max-age=0\r\n"
+        "\r\n",
+
+        // Safari, image with range request
+        "GET /chat/images/avatar_default.png HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "Accept: image/webp,image/avif,video/*;q=0.8,image/png,image/svg+xml,image/*;q=0.8,*/*;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: de-DE,de;q=0.9\r\n"
+        "Connection: keep-alive\r\n"
+        "Range: bytes=0-1023\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/17.1 Safari/605.1.15\r\n"
+        "\r\n",
+
+        // cometd handshake
+        "POST /bayeux HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: 188\r\n"
+        "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+        "X-Requested-With: XMLHttpRequest\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Content-Type: application/json;charset=UTF-8\r\n"
+        "Origin: http://www.example.com\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: de-DE,de;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+        "Cookie: _ga=GA1.2.1234567890.1700000000; _gid=GA1.2.987654321.1700000000; lang=de\r\n"
+        "\r\n",
+
+        // cometd long-poll connect
+        "POST /bayeux/connect HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Length: 102\r\n"
+        "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+        "X-Requested-With: XMLHttpRequest\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+        "Content-Type: application/json;charset=UTF-8\r\n"
+        "Origin: http://www.example.com\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept-Language: de-DE,de;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+        "Cookie: _ga=GA1.2.1234567890.1700000000; _gid=GA1.2.987654321.1700000000; lang=de; "
+            "BAYEUX_BROWSER=6b1f-1a2kq9x7zv3mbc0d\r\n"
+        "\r\n",
+
+        // cometd publish, form encoded by an older client library
+        "POST /bayeux HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64; rv:121.0) Gecko/20100101 Firefox/121.0\r\n"
+        "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+        "Accept-Language: de,en-US;q=0.7,en;q=0.3\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+        "X-Requested-With: XMLHttpRequest\r\n"
+        "Content-Length: 241\r\n"
+        "Origin: http://www.example.com\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "Cookie: _ga=GA1.2.1234567890.1700000000; lang=de; BAYEUX_BROWSER=3c9e-0p1l2m3n4b5v6c7x\r\n"
+        "Pragma: no-cache\r\n"
+        "Cache-Control: no-cache\r\n"
+        "\r\n",
+
+        // callback-polling (JSONP) connect
+        "GET /bayeux/connect?jsonp=jQuery17205_1700000012345&message=%5B%7B%22channel%22%3A%22%2Fmeta%2Fconnect%22%2C"
+            "%22connectionType%22%3A%22callback-polling%22%2C%22id%22%3A%2217%22%2C%22clientId%22%3A%22"
+            "1a2kq9x7zv3mbc0d%22%7D%5D&_=1700000012399 HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (compatible; MSIE 9.0; Windows NT 6.1; Trident/5.0)\r\n"
+        "Accept: application/javascript, */*;q=0.8\r\n"
+        "Referer: http://www.example.com/chat/index.html\r\n"
+        "Accept-Language: de-DE\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Connection: Keep-Alive\r\n"
+        "Cookie: lang=de; BAYEUX_BROWSER=9f8e-7d6c5b4a3z2y1x0w\r\n"
+        "\r\n",
+
+        // request forwarded by a load balancer
+        "POST /bayeux HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "X-Forwarded-For: 203.0.113.17, 198.51.100.4\r\n"
+        "X-Forwarded-Proto: https\r\n"
+        "X-Real-IP: 203.0.113.17\r\n"
+        "Via: 1.1 lb1.example.com\r\n"
+        "Content-Length: 96\r\n"
+        "Content-Type: application/json;charset=UTF-8\r\n"
+        "Accept: application/json\r\n"
+        "User-Agent: Mozilla/5.0 (iPhone; CPU iPhone OS 17_1 like Mac OS X) AppleWebKit/605.1.15 (KHTML, like Gecko) Mobile/15E148\r\n"
+        "Cookie: BAYEUX_BROWSER=2b3c-4d5e6f7g8h9i0j1k\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+
+        // HTTP/1.0 health check
+        "GET /status HTTP/1.0\r\n"
+        "Host: 10.0.0.12\r\n"
+        "User-Agent: check_http/v2.3.3 (monitoring-plugins 2.3.3)\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+
+        // command line client
+        "GET /chat/index.html HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "User-Agent: curl/8.4.0\r\n"
+        "Accept: */*\r\n"
+        "\r\n"
+    };
+
+    const std::size_t request_corpus_size = sizeof request_corpus / sizeof request_corpus[ 0 ];
+
+} // namespace test
+} // namespace http
+
+#endif // include guard
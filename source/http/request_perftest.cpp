@@ -0,0 +1,155 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+/*
+ * micro benchmark for the request header parser
+ *
+ * Measures the throughput of the different find_CR() implementations compared to the former byte by byte search
+ * and the number of request headers parsed per second with every implementation. The scalar implementation is the
+ * baseline, as it is the byte by byte search, message_base<>::parse() used before. The parsed request resembles a
+ * long-poll reconnect of a browser, with a big cookie header.
+ *
+ * usage: request_perftest [iterations]
+ */
+
+#include "http/line_scanner.h"
+#include "http/request.h"
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+    std::string browser_request()
+    {
+        std::string cookie;
+        for ( int i = 0; cookie.size() < 2000; ++i )
+            cookie += "session_value_" + std::string( 1, static_cast< char >( 'a' + i % 26 ) ) + "=0123456789abcdef; ";
+
+        return
+            "POST /bayeux HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+            "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+            "Accept-Language: de-DE,de;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+            "Accept-Encoding: gzip, deflate\r\n"
+            "Content-Type: application/x-www-form-urlencoded; charset=UTF-8\r\n"
+            "Content-Length: 0\r\n"
+            "X-Requested-With: XMLHttpRequest\r\n"
+            "Referer: http://www.example.com/chat/index.html\r\n"
+            "Cookie: " + cookie + "\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n";
+    }
+
+    // the search loop, message_base<>::parse() used before find_CR() was introduced
+    const char* byte_by_byte( const char* begin, const char* end )
+    {
+        for ( ; begin != end && *begin != '\r'; ++begin )
+            ;
+
+        return begin;
+    }
+
+    const char* scan( const char* begin, const char* end, tools::simd_isa isa )
+    {
+        return http::find_CR( begin, end, isa );
+    }
+
+    template < class Scanner >
+    double scan_throughput( const std::string& text, unsigned iterations, Scanner scanner )
+    {
+        const char* const           begin = text.data();
+        const char* const           end   = begin + text.size();
+        std::size_t                 lines = 0;
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            for ( const char* cr = scanner( begin, end ); cr != end; cr = scanner( cr + 1, end ) )
+                ++lines;
+        }
+
+        const double seconds = ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() / 1e6;
+
+        if ( lines == 0 )
+            throw std::runtime_error( "no lines found" );
+
+        return text.size() * static_cast< double >( iterations ) / seconds / ( 1024 * 1024 );
+    }
+
+    double parse_rate( const std::string& text, unsigned iterations )
+    {
+        const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+        for ( unsigned i = 0; i != iterations; ++i )
+        {
+            http::request_header request;
+            bool                 done = false;
+
+            for ( std::string::size_type pos = 0; !done && pos != text.size(); )
+            {
+                const std::pair< char*, std::size_t > buffer = request.read_buffer();
+                const std::size_t size = std::min( buffer.second, text.size() - pos );
+
+                std::copy( text.begin() + pos, text.begin() + pos + size, buffer.first );
+                pos += size;
+                done = request.parse( size );
+            }
+
+            if ( !done || request.state() != http::request_header::ok )
+                throw std::runtime_error( "unable to parse request" );
+        }
+
+        const double seconds = ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() / 1e6;
+
+        return iterations / seconds;
+    }
+
+}
+
+int main( int argc, const char* argv[] )
+{
+    try
+    {
+        const unsigned      iterations = argc > 1 ? std::atoi( argv[ 1 ] ) : 100000;
+        const std::string   request    = browser_request();
+
+        std::cout << "request size: " << request.size() << " bytes, " << iterations << " iterations\n";
+        std::cout << std::fixed << std::setprecision( 1 );
+        std::cout << "byte by byte: " << scan_throughput( request, iterations, &byte_by_byte ) << " MB/s\n";
+
+        for ( int i = tools::scalar_isa; i <= tools::available_simd_isa(); ++i )
+        {
+            const tools::simd_isa isa = static_cast< tools::simd_isa >( i );
+
+            std::cout << "find_CR " << tools::simd_isa_name( isa ) << ": "
+                      << scan_throughput( request, iterations, boost::bind( &scan, _1, _2, isa ) )
+                      << " MB/s\n";
+        }
+
+        for ( int i = tools::scalar_isa; i <= tools::available_simd_isa(); ++i )
+        {
+            const tools::simd_isa isa = static_cast< tools::simd_isa >( i );
+
+            http::select_line_scanner( isa );
+            std::cout << "request_header::parse() " << tools::simd_isa_name( isa ) << ": "
+                      << parse_rate( request, iterations ) << " requests/s\n";
+        }
+
+        std::cout << std::flush;
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
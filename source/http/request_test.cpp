@@ -4,10 +4,12 @@
 
 #include <boost/test/unit_test.hpp>
 #include "http/request.h"
+#include "http/header_names.h"
 #include "http/test_request_texts.h"
 #include "http/filter.h"
 #include <algorithm>
 #include <iterator>
+#include <memory>
 
 using namespace http::test;
 
@@ -224,6 +226,38 @@ BOOST_AUTO_TEST_CASE(filter_header_test)
     BOOST_CHECK(other.find_header("Accept-Language"));
 }
 
+/**
+ * @test filter the headers named in a Connection header, reusing the result vector
+ */
+BOOST_AUTO_TEST_CASE(filter_header_with_list_test)
+{
+    const http::request_header header(
+        "GET / HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "Connection: Keep-Alive, X-Hop\r\n"
+        "Keep-Alive: 300\r\n"
+        "x-hop: 1\r\n"
+        "Accept: text/plain\r\n"
+        "\r\n");
+    BOOST_REQUIRE_EQUAL(http::request_header::ok, header.state());
+
+    const http::header* const connection = header.find_header("Connection");
+    BOOST_REQUIRE(connection);
+
+    std::vector<tools::substring> result(5);
+    header.filtered_request_text(http::filter("connection"), connection->value(), result);
+
+    BOOST_CHECK_EQUAL(to_header(result),
+        "GET / HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "Accept: text/plain\r\n"
+        "\r\n");
+
+    header.filtered_request_text(http::filter(), tools::substring(), result);
+    BOOST_CHECK_EQUAL(1u, result.size());
+    BOOST_CHECK_EQUAL(to_header(result), header.text());
+}
+
 BOOST_AUTO_TEST_CASE(check_header_value_test)
 {
     const http::request_header request(
@@ -242,6 +276,37 @@ BOOST_AUTO_TEST_CASE(check_header_value_test)
     BOOST_CHECK(header != 0 && header->value() == "rababer\r\n\tboobar\r\n foo");
 }
 
+/**
+ * @test well known and other headers are found, case insensitive, the first of duplicates is returned
+ */
+BOOST_AUTO_TEST_CASE(find_well_known_and_other_headers)
+{
+    const http::request_header request(
+        "POST / HTTP/1.1\r\n"
+        "host: google.de\r\n"
+        "X-Foo: bar\r\n"
+        "Content-Length: 10\r\n"
+        "CONTENT-LENGTH: 20\r\n"
+        "Connection: keep-alive,\r\n"
+        " close\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::request_header::ok, request.state());
+
+    const http::header* const length = request.find_header("content-length");
+    BOOST_REQUIRE(length != 0);
+    BOOST_CHECK_EQUAL(length->value(), "10");
+
+    BOOST_CHECK(request.find_header("Host") != 0 && request.find_header("Host")->value() == "google.de");
+    BOOST_CHECK(request.find_header("x-foo") != 0 && request.find_header("x-foo")->value() == "bar");
+
+    BOOST_CHECK(request.find_header(http::transfer_encoding_header) == 0);
+    BOOST_CHECK(request.find_header("X-Bar") == 0);
+
+    // the slot must point to the header, that was extended by the continuation line
+    BOOST_CHECK(request.close_after_response());
+}
+
 BOOST_AUTO_TEST_CASE(check_host_and_port)
 {
     { // no port given, default is 80        
@@ -305,4 +370,200 @@ BOOST_AUTO_TEST_CASE(check_unparsed_buffer)
     BOOST_CHECK_EQUAL(3u, request.unparsed_buffer().second);
 }
 
+namespace {
+    // feeds the text in parts of at most max_size bytes
+    bool feed_in_parts(const std::string& text, http::request_header& header, std::size_t max_size)
+    {
+        for ( std::string::size_type pos = 0; pos != text.size(); )
+        {
+            const std::pair<char*, std::size_t> mem  = header.read_buffer();
+            const std::size_t                   size = std::min(std::min(mem.second, max_size), text.size() - pos);
+
+            std::copy(text.begin() + pos, text.begin() + pos + size, mem.first);
+            pos += size;
+
+            if ( header.parse(size) )
+                return pos == text.size();
+        }
+
+        return false;
+    }
+
+    std::string big_cookie(std::size_t size)
+    {
+        std::string result;
+        for ( unsigned i = 0; result.size() < size; ++i )
+            result += "c" + std::string(1, static_cast<char>('a' + i % 26)) + "=0123456789; ";
+
+        return result + "end=1";
+    }
+}
+
+/**
+ * @test a small header fits into the first, small buffer
+ */
+BOOST_AUTO_TEST_CASE(small_header_uses_a_small_buffer)
+{
+    const http::request_header request(
+        "GET / HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "\r\n");
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+    BOOST_CHECK_EQUAL(http::request_header::initial_buffer_size, request.allocated_size());
+}
+
+/**
+ * @test headers, larger than the first buffer are parsed and the results stay valid, while the buffer grows
+ */
+BOOST_AUTO_TEST_CASE(header_buffer_grows)
+{
+    const std::string cookie = big_cookie(10 * 1024);
+    const std::string text =
+        "GET /index.html HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "Cookie: " + cookie + "\r\n"
+        "Accept: text/plain\r\n"
+        "\r\n";
+
+    for ( std::size_t part = 1; part < 1024; part = part * 3 + 1 )
+    {
+        http::request_header request;
+        BOOST_REQUIRE(feed_in_parts(text, request, part));
+        BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+
+        BOOST_CHECK_EQUAL(request.uri(), "/index.html");
+        BOOST_CHECK_EQUAL(request.host(), "google.de");
+        BOOST_CHECK(request.find_header("cookie") != 0 && request.find_header("cookie")->value() == cookie.c_str());
+        BOOST_CHECK(request.find_header("accept") != 0 && request.find_header("accept")->value() == "text/plain");
+        BOOST_CHECK_EQUAL(text, request.text());
+        BOOST_CHECK_GT(request.allocated_size(), cookie.size());
+
+        std::string filtered;
+        const std::vector<tools::substring> parts = request.filtered_request_text(http::filter("Accept"));
+        for ( std::vector<tools::substring>::const_iterator p = parts.begin(); p != parts.end(); ++p )
+            filtered.append(p->begin(), p->end());
+
+        BOOST_CHECK_EQUAL(filtered,
+            "GET /index.html HTTP/1.1\r\n"
+            "Host: google.de\r\n"
+            "Cookie: " + cookie + "\r\n"
+            "\r\n");
+    }
+}
+
+/**
+ * @test a continuation line, that is received after the buffer had to grow, extends the right header
+ */
+BOOST_AUTO_TEST_CASE(continuation_line_in_grown_buffer)
+{
+    const std::string filler(http::request_header::initial_buffer_size, 'x');
+    const std::string text =
+        "GET / HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "FooBar: rababer\r\n"
+        " " + filler + "\r\n"
+        "\r\n";
+
+    http::request_header request;
+    BOOST_REQUIRE(feed_in_parts(text, request, 100));
+    BOOST_REQUIRE_EQUAL(http::message::ok, request.state());
+
+    const http::header* const header = request.find_header("foobar");
+    BOOST_REQUIRE(header != 0);
+    BOOST_CHECK_EQUAL(header->value(), ("rababer\r\n " + filler).c_str());
+    BOOST_CHECK_EQUAL(text, request.text());
+}
+
+/**
+ * @test a header, that exceeds the header_size_limit() results in a buffer_full error
+ */
+BOOST_AUTO_TEST_CASE(header_size_limit_exceeded)
+{
+    const std::string text =
+        "GET / HTTP/1.1\r\n"
+        "Cookie: " + big_cookie(http::header_size_limit()) + "\r\n"
+        "\r\n";
+
+    http::request_header request;
+    feed_in_parts(text, request, text.size());
+
+    BOOST_CHECK_EQUAL(http::message::buffer_full, request.state());
+    BOOST_CHECK_LE(request.allocated_size(), http::header_size_limit());
+}
+
+/**
+ * @test pipelined requests share the buffer, the first request was received in
+ */
+BOOST_AUTO_TEST_CASE(pipelined_requests_share_a_buffer)
+{
+    tools::buffer_pool& pool = http::header_buffer_pool(http::request_header::initial_buffer_size);
+    const std::size_t   blocks_in_use = pool.blocks_in_use();
+
+    std::auto_ptr<http::request_header> first(new http::request_header(
+        "GET /first HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "\r\n"
+        "GET /second HTTP/1.1\r\n"
+        "Host: goo"));
+
+    BOOST_REQUIRE_EQUAL(http::message::ok, first->state());
+    BOOST_CHECK_EQUAL(blocks_in_use + 1, pool.blocks_in_use());
 
+    std::size_t remaining = 0;
+    http::request_header second(*first, remaining, http::request_header::share_trailing_buffer);
+
+    BOOST_CHECK_EQUAL(blocks_in_use + 1, pool.blocks_in_use());
+    BOOST_REQUIRE_EQUAL(31u, remaining);
+    BOOST_CHECK(!second.parse(remaining));
+
+    // the next data is received behind the remaining data
+    const std::pair<char*, std::size_t> buffer = second.read_buffer();
+    BOOST_CHECK(buffer.first == first->unparsed_buffer().first + remaining);
+
+    const std::string rest = "gle.de\r\n\r\n";
+    std::copy(rest.begin(), rest.end(), buffer.first);
+    BOOST_REQUIRE(second.parse(rest.size()));
+    BOOST_REQUIRE_EQUAL(http::message::ok, second.state());
+
+    first.reset();
+    BOOST_CHECK_EQUAL(blocks_in_use + 1, pool.blocks_in_use());
+
+    BOOST_CHECK_EQUAL(second.uri(), "/second");
+    BOOST_CHECK_EQUAL(second.host(), "google.de");
+    BOOST_CHECK_EQUAL("GET /second HTTP/1.1\r\nHost: google.de\r\n\r\n", second.text());
+}
+
+/**
+ * @test a request, that starts in the buffer of the previous request, but doesn't fit, is moved to a new buffer
+ */
+BOOST_AUTO_TEST_CASE(pipelined_request_moves_out_of_a_shared_buffer)
+{
+    const std::string second_text =
+        "GET /second HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "Cookie: " + big_cookie(2 * http::request_header::initial_buffer_size) + "\r\n"
+        "\r\n";
+
+    const std::string text =
+        "GET /first HTTP/1.1\r\n"
+        "Host: google.de\r\n"
+        "\r\n" + second_text;
+
+    http::request_header first;
+    BOOST_REQUIRE(!feed_in_parts(text, first, text.size()));
+    BOOST_REQUIRE_EQUAL(http::message::ok, first.state());
+
+    std::size_t remaining = 0;
+    http::request_header second(first, remaining, http::request_header::share_trailing_buffer);
+    BOOST_REQUIRE(remaining != 0);
+
+    const std::size_t consumed = first.text().size() + remaining;
+    BOOST_REQUIRE(!second.parse(remaining));
+    BOOST_REQUIRE(feed_in_parts(text.substr(consumed), second, text.size()));
+    BOOST_REQUIRE_EQUAL(http::message::ok, second.state());
+
+    BOOST_CHECK_EQUAL(second.uri(), "/second");
+    BOOST_CHECK_EQUAL(second_text, second.text());
+    BOOST_CHECK_EQUAL(first.uri(), "/first");
+}
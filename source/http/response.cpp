@@ -12,8 +12,8 @@ namespace http {
     {
     }
 
-    response_header::response_header(const response_header& old_header, std::size_t& remaining, copy_trailing_buffer_t)
-        : message_base< response_header >(old_header, remaining, copy_trailing_buffer)
+    response_header::response_header(const response_header& old_header, std::size_t& remaining, share_trailing_buffer_t)
+        : message_base< response_header >(old_header, remaining, share_trailing_buffer)
     {
     }
 
@@ -35,7 +35,7 @@ namespace http {
          *
          * @pre state() returned ok
          */
-        response_header(const response_header& old_header, std::size_t& remaining, copy_trailing_buffer_t);
+        response_header(const response_header& old_header, std::size_t& remaining, share_trailing_buffer_t);
 
         response_header( const boost::asio::const_buffers_1& old_body, std::size_t& remaining );
 
@@ -0,0 +1,286 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "http/response_head.h"
+#include "http/header_names.h"
+#include "http/message.h"
+#include "tools/buffer_pool.h"
+#include <boost/thread/tss.hpp>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace http
+{
+    namespace {
+        const int first_status_code = 100;
+        const int last_status_code  = 599;
+
+        // all status lines, rendered once
+        class status_line_table
+        {
+        public:
+            status_line_table()
+            {
+                for ( int code = first_status_code; code <= last_status_code; ++code )
+                {
+                    std::string& line = lines_[ code - first_status_code ];
+                    char number[ max_decimal_size ];
+
+                    line = "HTTP/1.1 ";
+                    line.append( number, format_decimal( code, number ) );
+                    line += ' ';
+                    line += reason_phrase( static_cast< http_error_code >( code ) );
+                    line += "\r\n";
+                }
+            }
+
+            tools::substring operator[]( http_error_code code ) const
+            {
+                assert( code >= first_status_code && code <= last_status_code );
+                const std::string& line = lines_[ code - first_status_code ];
+
+                return tools::substring( line.data(), line.data() + line.size() );
+            }
+
+        private:
+            std::string lines_[ last_status_code - first_status_code + 1 ];
+        };
+
+        const status_line_table& status_lines()
+        {
+            static const status_line_table table;
+            return table;
+        }
+
+        // make sure, the table is constructed before main() and thus before a second thread can race for it
+        const status_line_table& force_status_line_table_initialization = status_lines();
+
+        char* format_two_digits( unsigned value, char* buffer )
+        {
+            *buffer++ = static_cast< char >( '0' + value / 10 );
+            *buffer++ = static_cast< char >( '0' + value % 10 );
+
+            return buffer;
+        }
+
+        char* copy( const char* text, char* buffer )
+        {
+            while ( *text )
+                *buffer++ = *text++;
+
+            return buffer;
+        }
+
+        struct date_cache
+        {
+            date_cache() : time( -1 )
+            {
+            }
+
+            std::time_t time;
+            char        text[ date_header_size ];
+        };
+
+        boost::thread_specific_ptr< date_cache > date_caches;
+    }
+
+    tools::substring prerendered_status_line( http_error_code code )
+    {
+        return status_lines()[ code ];
+    }
+
+    char* format_decimal( boost::uintmax_t value, char* buffer )
+    {
+        char  reversed[ max_decimal_size ];
+        char* end = reversed;
+
+        do
+        {
+            *end++ = static_cast< char >( '0' + value % 10 );
+            value /= 10;
+        }
+        while ( value != 0 );
+
+        while ( end != reversed )
+            *buffer++ = *--end;
+
+        return buffer;
+    }
+
+    char* format_date_header( std::time_t time, char* buffer )
+    {
+        static const char* const week_days[] = { "Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed" };
+        static const char* const months[] = {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+        assert( time >= 0 );
+        const boost::uintmax_t  seconds = static_cast< boost::uintmax_t >( time );
+        const boost::uintmax_t  days    = seconds / ( 24 * 60 * 60 );
+        const unsigned          of_day  = static_cast< unsigned >( seconds % ( 24 * 60 * 60 ) );
+
+        // civil date from the number of days since 1970-01-01 (the epoch was a Thursday)
+        const boost::uintmax_t  z       = days + 719468;
+        const boost::uintmax_t  era     = z / 146097;
+        const unsigned          doe     = static_cast< unsigned >( z - era * 146097 );
+        const unsigned          yoe     = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+        const unsigned          doy     = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+        const unsigned          mp      = ( 5 * doy + 2 ) / 153;
+        const unsigned          day     = doy - ( 153 * mp + 2 ) / 5 + 1;
+        const unsigned          month   = mp < 10 ? mp + 3 : mp - 9;
+        const boost::uintmax_t  year    = yoe + era * 400 + ( month <= 2 ? 1 : 0 );
+
+        buffer = copy( "Date: ", buffer );
+        buffer = copy( week_days[ days % 7 ], buffer );
+        buffer = copy( ", ", buffer );
+        buffer = format_two_digits( day, buffer );
+        *buffer++ = ' ';
+        buffer = copy( months[ month - 1 ], buffer );
+        *buffer++ = ' ';
+        buffer = format_two_digits( static_cast< unsigned >( year / 100 ), buffer );
+        buffer = format_two_digits( static_cast< unsigned >( year % 100 ), buffer );
+        *buffer++ = ' ';
+        buffer = format_two_digits( of_day / 3600, buffer );
+        *buffer++ = ':';
+        buffer = format_two_digits( of_day / 60 % 60, buffer );
+        *buffer++ = ':';
+        buffer = format_two_digits( of_day % 60, buffer );
+
+        return copy( " GMT\r\n", buffer );
+    }
+
+    tools::substring date_header()
+    {
+        date_cache* cache = date_caches.get();
+
+        if ( !cache )
+        {
+            cache = new date_cache;
+            date_caches.reset( cache );
+        }
+
+        const std::time_t now = std::time( 0 );
+
+        if ( now != cache->time )
+        {
+            format_date_header( now, cache->text );
+            cache->time = now;
+        }
+
+        return tools::substring( cache->text, cache->text + date_header_size );
+    }
+
+    //////////////////////
+    // class response_head
+    response_head::response_head()
+        : size_( 0 )
+        , buffer_( 0 )
+    {
+    }
+
+    response_head::response_head( http_error_code code )
+        : size_( 0 )
+        , buffer_( 0 )
+    {
+        status( code );
+    }
+
+    response_head::~response_head()
+    {
+        if ( buffer_ )
+            header_buffer_pool( capacity ).release( buffer_ );
+    }
+
+    response_head& response_head::status( http_error_code code )
+    {
+        const tools::substring line = prerendered_status_line( code );
+
+        size_ = 0;
+        return append( line.begin(), line.end() );
+    }
+
+    response_head& response_head::date()
+    {
+        const tools::substring header = date_header();
+
+        return append( header.begin(), header.end() );
+    }
+
+    response_head& response_head::header( const char* name, const char* value )
+    {
+        return append( name ).append( ": " ).append( value ).append( "\r\n" );
+    }
+
+    response_head& response_head::header( const char* name, const std::string& value )
+    {
+        return append( name ).append( ": " ).append( value ).append( "\r\n" );
+    }
+
+    response_head& response_head::content_length( boost::uintmax_t length )
+    {
+        return append( content_length_header ).append( ": " ).append_decimal( length ).append( "\r\n" );
+    }
+
+    response_head& response_head::append( const char* text )
+    {
+        return append( text, text + std::strlen( text ) );
+    }
+
+    response_head& response_head::append( const char* begin, const char* end )
+    {
+        const std::size_t size = end - begin;
+        std::memcpy( reserve( size ), begin, size );
+        size_ += size;
+
+        return *this;
+    }
+
+    response_head& response_head::append( const std::string& text )
+    {
+        return append( text.data(), text.data() + text.size() );
+    }
+
+    response_head& response_head::append_decimal( boost::uintmax_t value )
+    {
+        char number[ max_decimal_size ];
+
+        return append( number, format_decimal( value, number ) );
+    }
+
+    response_head& response_head::finish()
+    {
+        return append( "\r\n" );
+    }
+
+    const char* response_head::data() const
+    {
+        return buffer_;
+    }
+
+    std::size_t response_head::size() const
+    {
+        return size_;
+    }
+
+    boost::asio::const_buffers_1 response_head::buffer() const
+    {
+        return boost::asio::buffer( static_cast< const char* >( buffer_ ), size_ );
+    }
+
+    std::string response_head::text() const
+    {
+        return buffer_ ? std::string( buffer_, size_ ) : std::string();
+    }
+
+    char* response_head::reserve( std::size_t size )
+    {
+        if ( capacity - size_ < size )
+            throw std::length_error( "http::response_head: capacity exceeded" );
+
+        if ( !buffer_ )
+            buffer_ = header_buffer_pool( capacity ).allocate();
+
+        return buffer_ + size_;
+    }
+}
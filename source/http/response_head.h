@@ -0,0 +1,147 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_HTTP_RESPONSE_HEAD_H
+#define SIOUX_SOURCE_HTTP_RESPONSE_HEAD_H
+
+#include "http/http.h"
+#include "tools/substring.h"
+#include <boost/asio/buffer.hpp>
+#include <boost/cstdint.hpp>
+#include <ctime>
+#include <string>
+
+namespace http
+{
+    /**
+     * @brief the pre-rendered HTTP/1.1 status line for the given code, including the trailing \\r\\n
+     *
+     * The status lines of all codes from 100 to 599 are rendered once, the returned text is valid for the whole
+     * run time of the program.
+     * @pre code >= 100 && code < 600
+     */
+    tools::substring prerendered_status_line( http_error_code code );
+
+    /**
+     * @brief the maximum number of characters, written by format_decimal()
+     */
+    const std::size_t max_decimal_size = 20;
+
+    /**
+     * @brief writes the decimal representation of value to buffer, without terminating zero
+     * @return the end of the written number
+     */
+    char* format_decimal( boost::uintmax_t value, char* buffer );
+
+    /**
+     * @brief writes "Date: <rfc 1123 date>\\r\\n" of the given time to buffer and returns the end of the written text
+     *
+     * The buffer must have room for date_header_size characters.
+     */
+    char* format_date_header( std::time_t time, char* buffer );
+
+    const std::size_t date_header_size = 37;
+
+    /**
+     * @brief the Date header of the current second
+     *
+     * The header is rendered once per second and per thread. The returned text is valid until the next call to
+     * date_header() from the same thread.
+     */
+    tools::substring date_header();
+
+    /**
+     * @brief builds the head of a HTTP/1.1 response into a buffer of fixed size
+     *
+     * The buffer is taken from header_buffer_pool( capacity ), when the first text is appended, and is returned
+     * to the pool by the destructor. So a response, that does not yet render its head, does not carry the buffer
+     * and building a response head usually reuses a pooled buffer. All numbers are formatted without iostreams.
+     * Example:
+     * @code
+     * response_head head;
+     * head.status( http_ok ).date().header( content_type_header, "application/json" ).content_length( size ).finish();
+     * connection.async_write( head.buffer(), ... );
+     * @endcode
+     */
+    class response_head
+    {
+    public:
+        /**
+         * @brief the maximum size of a response head
+         */
+        static const std::size_t capacity = 1024;
+
+        /**
+         * @brief an empty response head
+         */
+        response_head();
+
+        /**
+         * @brief a response head, starting with the status line of the given code
+         */
+        explicit response_head( http_error_code code );
+
+        ~response_head();
+
+        /**
+         * @brief discards the current content and starts a new response head with the status line of the given code
+         */
+        response_head& status( http_error_code code );
+
+        /**
+         * @brief appends the cached Date header of the current second
+         */
+        response_head& date();
+
+        /**
+         * @brief appends a header with the given name and value
+         */
+        response_head& header( const char* name, const char* value );
+        response_head& header( const char* name, const std::string& value );
+
+        /**
+         * @brief appends a Content-Length header
+         */
+        response_head& content_length( boost::uintmax_t length );
+
+        /**
+         * @brief appends text, that is already formatted as header lines
+         */
+        response_head& append( const char* text );
+        response_head& append( const char* begin, const char* end );
+        response_head& append( const std::string& text );
+
+        /**
+         * @brief appends the decimal representation of the value
+         */
+        response_head& append_decimal( boost::uintmax_t value );
+
+        /**
+         * @brief appends the empty line, that terminates the head
+         */
+        response_head& finish();
+
+        const char* data() const;
+        std::size_t size() const;
+
+        /**
+         * @brief the content of the head, referring to this object
+         */
+        boost::asio::const_buffers_1 buffer() const;
+
+        std::string text() const;
+    private:
+        // not implemented
+        response_head( const response_head& );
+        response_head& operator=( const response_head& );
+
+        // returns a pointer to size free bytes
+        char* reserve( std::size_t size );
+
+        std::size_t size_;
+        char*       buffer_;
+    };
+}
+
+#endif // include guard
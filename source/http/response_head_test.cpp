@@ -0,0 +1,132 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "http/response_head.h"
+#include "http/header_names.h"
+#include "http/response.h"
+#include "http/message.h"
+#include "tools/buffer_pool.h"
+#include <limits>
+
+using namespace http;
+
+namespace {
+    std::string decimal( boost::uintmax_t value )
+    {
+        char buffer[ max_decimal_size ];
+        return std::string( buffer, format_decimal( value, buffer ) );
+    }
+
+    std::string date( std::time_t time )
+    {
+        char buffer[ date_header_size ];
+        char* const end = format_date_header( time, buffer );
+        BOOST_REQUIRE_EQUAL( static_cast< std::size_t >( end - buffer ), date_header_size );
+
+        return std::string( buffer, end );
+    }
+
+    std::string text( const tools::substring& s )
+    {
+        return std::string( s.begin(), s.end() );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( prerendered_status_lines_match_the_formatted_status_lines )
+{
+    BOOST_CHECK_EQUAL( "HTTP/1.1 200 OK\r\n", text( prerendered_status_line( http_ok ) ) );
+    BOOST_CHECK_EQUAL( "HTTP/1.1 404 Not Found\r\n", text( prerendered_status_line( http_not_found ) ) );
+
+    for ( int code = 100; code != 600; ++code )
+    {
+        const http_error_code ec = static_cast< http_error_code >( code );
+        BOOST_CHECK_EQUAL( status_line( "1.1", ec ), text( prerendered_status_line( ec ) ) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( format_decimal_numbers )
+{
+    BOOST_CHECK_EQUAL( "0", decimal( 0 ) );
+    BOOST_CHECK_EQUAL( "7", decimal( 7 ) );
+    BOOST_CHECK_EQUAL( "10", decimal( 10 ) );
+    BOOST_CHECK_EQUAL( "4711", decimal( 4711 ) );
+    BOOST_CHECK_EQUAL( "18446744073709551615", decimal( std::numeric_limits< boost::uint64_t >::max() ) );
+}
+
+BOOST_AUTO_TEST_CASE( format_rfc1123_date_headers )
+{
+    BOOST_CHECK_EQUAL( "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n", date( 0 ) );
+    BOOST_CHECK_EQUAL( "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n", date( 784111777 ) );
+    BOOST_CHECK_EQUAL( "Date: Tue, 29 Feb 2000 23:59:59 GMT\r\n", date( 951868799 ) );
+    BOOST_CHECK_EQUAL( "Date: Sat, 31 Dec 2011 12:00:00 GMT\r\n", date( 1325332800 ) );
+}
+
+BOOST_AUTO_TEST_CASE( cached_date_header_is_the_date_of_the_current_second )
+{
+    const std::time_t before = std::time( 0 );
+    const std::string header = text( date_header() );
+    const std::time_t after  = std::time( 0 );
+
+    BOOST_CHECK( header == date( before ) || header == date( after ) );
+
+    // the cache is reused within the same second
+    const tools::substring first  = date_header();
+    const tools::substring second = date_header();
+    BOOST_CHECK( first.begin() == second.begin() );
+}
+
+BOOST_AUTO_TEST_CASE( build_a_response_head )
+{
+    response_head head( http_ok );
+    head.header( content_type_header, "application/json" )
+        .header( "X-Name", std::string( "value" ) )
+        .content_length( 4711 )
+        .finish();
+
+    BOOST_CHECK_EQUAL(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "X-Name: value\r\n"
+        "Content-Length: 4711\r\n"
+        "\r\n", head.text() );
+
+    BOOST_CHECK_EQUAL( head.size(), boost::asio::buffer_size( head.buffer() ) );
+
+    // status() starts a new head
+    head.status( http_not_found ).date().finish();
+    BOOST_CHECK_EQUAL( text( prerendered_status_line( http_not_found ) ) + text( date_header() ) + "\r\n", head.text() );
+}
+
+/*
+ * the buffer of a response head is taken from the pool, when the head is built and not before
+ */
+BOOST_AUTO_TEST_CASE( response_head_buffer_is_pooled )
+{
+    const tools::buffer_pool& pool = header_buffer_pool( response_head::capacity );
+    const std::size_t in_use = pool.blocks_in_use();
+
+    {
+        response_head head;
+        BOOST_CHECK_EQUAL( in_use, pool.blocks_in_use() );
+        BOOST_CHECK_EQUAL( 0u, head.size() );
+
+        head.status( http_ok ).date().content_length( 0 ).finish();
+        BOOST_CHECK_EQUAL( in_use + 1, pool.blocks_in_use() );
+
+        const response_header response( head.text().c_str() );
+        BOOST_CHECK_EQUAL( response_header::ok, response.state() );
+        BOOST_CHECK( response.find_header( "Date" ) );
+    }
+
+    BOOST_CHECK_EQUAL( in_use, pool.blocks_in_use() );
+}
+
+BOOST_AUTO_TEST_CASE( response_head_overflow )
+{
+    response_head head( http_ok );
+    const std::string value( response_head::capacity, 'x' );
+
+    BOOST_CHECK_THROW( head.header( "X-Large", value ), std::length_error );
+}
@@ -3,15 +3,22 @@
 // Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
 
 #include "json/json.h"
+#include "json/scanner.h"
 #include "tools/dynamic_type.h"
 #include "tools/asstring.h"
 #include "tools/iterators.h"
 #include "tools/substring.h"
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/detail/atomic_count.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/noncopyable.hpp>
 #include <algorithm>
 #include <iterator>
 #include <cctype>
-#include <map>
+#include <cstring>
+#include <limits>
+#include <new>
 
 namespace json
 {
@@ -40,6 +47,11 @@ namespace json
             null_code
         };
 
+        impl() : references_(0), arena_(0) {}
+
+        // a copy has its own reference count and is not allocated from an arena
+        impl(const impl&) : references_(0), arena_(0) {}
+
         virtual ~impl() {}
 
         virtual void visit(const impl_visitor&) const = 0;
@@ -47,8 +59,173 @@ namespace json
         virtual void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const = 0;
         virtual type_code code() const = 0;
         virtual const char* name() const = 0;
+
+        boost::detail::atomic_count references_;
+
+        // the arena, this was allocated from by a parser, permanent_arena() for atoms, or null
+        arena::storage*             arena_;
+    private:
+        impl& operator=(const impl&);
     };
 
+    namespace {
+        char permanent_arena_tag;
+
+        /*
+         * marks the values, that are never released, in value::impl::arena_. Nothing is allocated from this arena.
+         * The permanent values are shared by all threads and are not reference counted, so that threads do not
+         * contend on their reference counters.
+         */
+        arena::storage* permanent_arena()
+        {
+            return reinterpret_cast<arena::storage*>(&permanent_arena_tag);
+        }
+    }
+
+    void intrusive_ptr_add_ref(value::impl* p)
+    {
+        if ( p->arena_ != permanent_arena() )
+            ++p->references_;
+    }
+
+    const value::impl& implementation(const value& v)
+    {
+        return *v.pimpl_;
+    }
+
+    //////////////////////
+    // class arena::storage
+    class arena::storage : boost::noncopyable
+    {
+    public:
+        explicit storage(std::size_t chunk_size)
+            : references_(0)
+            , chunk_size_(chunk_size)
+            , next_chunk_size_(chunk_size < arena::first_chunk_size ? chunk_size : arena::first_chunk_size)
+            , chunks_()
+            , pos_(0)
+            , end_(0)
+            , allocated_(0)
+            , capacity_(0)
+        {
+        }
+
+        ~storage()
+        {
+            for ( std::vector<char*>::const_iterator c = chunks_.begin(); c != chunks_.end(); ++c )
+                delete[] *c;
+        }
+
+        void* allocate(std::size_t size)
+        {
+            static const std::size_t alignment = 2 * sizeof(void*);
+            size = (size + alignment - 1) & ~(alignment - 1);
+            allocated_ += size;
+
+            // large allocations get a chunk of their own, to not waste the rest of the current chunk
+            if ( size > chunk_size_ / 4 )
+                return new_chunk(size);
+
+            if ( static_cast<std::size_t>(end_ - pos_) < size )
+            {
+                const std::size_t chunk_size = std::max(next_chunk_size_, size);
+
+                pos_ = new_chunk(chunk_size);
+                end_ = pos_ + chunk_size;
+                next_chunk_size_ = std::min(2 * next_chunk_size_, chunk_size_);
+            }
+
+            char* const result = pos_;
+            pos_ += size;
+
+            return result;
+        }
+
+        std::size_t chunks() const
+        {
+            return chunks_.size();
+        }
+
+        std::size_t allocated() const
+        {
+            return allocated_;
+        }
+
+        std::size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        boost::detail::atomic_count references_;
+    private:
+        char* new_chunk(std::size_t size)
+        {
+            chunks_.reserve(chunks_.size() + 1);
+            chunks_.push_back(new char[size]);
+            capacity_ += size;
+
+            return chunks_.back();
+        }
+
+        const std::size_t   chunk_size_;
+        std::size_t         next_chunk_size_;
+        std::vector<char*>  chunks_;
+        char*               pos_;
+        char*               end_;
+        std::size_t         allocated_;
+        std::size_t         capacity_;
+    };
+
+    void intrusive_ptr_add_ref(arena::storage* p)
+    {
+        ++p->references_;
+    }
+
+    void intrusive_ptr_release(arena::storage* p)
+    {
+        if ( --p->references_ == 0 )
+            delete p;
+    }
+
+    // values allocated from an arena are destructed in place and keep the arena alive, until they are released
+    void intrusive_ptr_release(value::impl* p)
+    {
+        if ( p->arena_ == permanent_arena() || --p->references_ != 0 )
+            return;
+
+        if ( arena::storage* const memory = p->arena_ )
+        {
+            p->~impl();
+            intrusive_ptr_release(memory);
+        }
+        else
+        {
+            delete p;
+        }
+    }
+
+    //////////////
+    // class arena
+    arena::arena(std::size_t chunk_size)
+        : storage_(new storage(chunk_size))
+    {
+    }
+
+    std::size_t arena::chunks() const
+    {
+        return storage_->chunks();
+    }
+
+    std::size_t arena::allocated() const
+    {
+        return storage_->allocated();
+    }
+
+    std::size_t arena::capacity() const
+    {
+        return storage_->capacity();
+    }
+
     namespace {
         class impl_visitor
         {
@@ -64,26 +241,146 @@ namespace json
             virtual ~impl_visitor() {}
         };
 
-        bool less_impl(const std::vector<char>& lhs, const std::vector<char>& rhs)
+        /*
+         * the json encoded characters of a string or number. Short texts, like most keys, ids and numbers, are
+         * stored inline. Longer texts are stored on the heap, or, if an arena is given, in the arena.
+         */
+        class text : boost::noncopyable
+        {
+        public:
+            static const std::size_t inline_size = 24;
+
+            text(std::size_t size, arena::storage* memory)
+                : size_(checked_size(size))
+                , heap_(size > inline_size && memory == 0)
+            {
+                allocate(memory);
+            }
+
+            text(const char* begin, const char* end, arena::storage* memory)
+                : size_(checked_size(end - begin))
+                , heap_(size_ > inline_size && memory == 0)
+            {
+                allocate(memory);
+                std::memcpy(data(), begin, size_);
+            }
+
+            ~text()
+            {
+                if ( heap_ )
+                    delete[] remote_;
+            }
+
+            char* data()
+            {
+                return size_ > inline_size ? remote_ : local_;
+            }
+
+            const char* begin() const
+            {
+                return size_ > inline_size ? remote_ : local_;
+            }
+
+            const char* end() const
+            {
+                return begin() + size_;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+        private:
+            static boost::uint32_t checked_size(std::size_t size)
+            {
+                if ( size > std::numeric_limits<boost::uint32_t>::max() )
+                    throw std::length_error("json text too long");
+
+                return static_cast<boost::uint32_t>(size);
+            }
+
+            void allocate(arena::storage* memory)
+            {
+                if ( size_ > inline_size )
+                    remote_ = memory ? static_cast<char*>(memory->allocate(size_)) : new char[size_];
+            }
+
+            union {
+                char*   remote_;
+                char    local_[inline_size];
+            };
+
+            const boost::uint32_t   size_;
+            const bool              heap_;
+        };
+
+        bool less_impl(const text& lhs, const text& rhs)
         {
             if ( lhs.size() != rhs.size() )
                 return lhs.size() < rhs.size();
 
-            const std::pair<std::vector<char>::const_iterator, std::vector<char>::const_iterator> found =
-                std::mismatch(lhs.begin(), lhs.end(), rhs.begin());
+            // compares (signed) chars and not bytes, to keep the order of non ASCII keys and thus the serialization
+            const std::pair<const char*, const char*> found = std::mismatch(lhs.begin(), lhs.end(), rhs.begin());
 
             return found.first != lhs.end() && *found.first < *found.second;
         }
 
+        bool equal_impl(const text& lhs, const text& rhs)
+        {
+            return lhs.size() == rhs.size() && std::memcmp(lhs.begin(), rhs.begin(), lhs.size()) == 0;
+        }
+
+        // FNV-1a
+        boost::uint32_t hash_impl(const char* begin, const char* end)
+        {
+            boost::uint32_t result = 2166136261u;
+
+            for ( ; begin != end; ++begin )
+                result = (result ^ static_cast<unsigned char>(*begin)) * 16777619u;
+
+            return result;
+        }
+
+        boost::uint32_t hash_impl(const text& t)
+        {
+            return hash_impl(t.begin(), t.end());
+        }
+
+        // number of characters, a character needs in a json string
+        std::size_t escaped_size(char c)
+        {
+            switch ( c )
+            {
+            case '\"' :
+            case '\\' :
+            case '\b' :
+            case '\f' :
+            case '\n' :
+            case '\r' :
+            case '\t' :
+                return 2;
+            }
+
+            return 1;
+        }
+
         class string_impl : public value::impl
         {
         public:
-            explicit string_impl( std::vector<char>& v )
+            // a string from json encoded characters, including the quotes
+            string_impl( const tools::substring& json, arena::storage* memory )
+                : data_( json.begin(), json.end(), memory )
+            {
+            }
+
+            string_impl( const text& json, arena::storage* memory )
+                : data_( json.begin(), json.end(), memory )
             {
-                data_.swap( v );
             }
 
             string_impl( const char* begin, const char* end )
+                : data_( encoded_size( begin, end ), 0 )
             {
                 init( begin, end );
             }
@@ -141,52 +438,64 @@ namespace json
                     : begin != 0 && *begin != 0;
             }
 
+            static std::size_t encoded_size( const char* s, const char* end )
+            {
+                std::size_t result = 2;
+
+                for ( ; cont( s, end ); ++s )
+                    result += escaped_size( *s );
+
+                return result;
+            }
+
             void init( const char* s, const char* end )
             {
-                data_.push_back('\"');
+                char* out = data_.data();
+                *out++ = '\"';
 
                 for ( ; cont( s, end ); ++s )
                 {
                     switch ( *s )
                     {
                     case '\"' :
-                        data_.push_back('\\');
-                        data_.push_back('\"');
+                        *out++ = '\\';
+                        *out++ = '\"';
                         break;
                     case '\\' :
-                        data_.push_back('\\');
-                        data_.push_back('\\');
+                        *out++ = '\\';
+                        *out++ = '\\';
                         break;
 /* @todo Until the compare bug is fixed                    case '/' :
-                        data_.push_back('\\');
-                        data_.push_back('/');
+                        *out++ = '\\';
+                        *out++ = '/';
                         break;*/
                     case '\b' :
-                        data_.push_back('\\');
-                        data_.push_back('b');
+                        *out++ = '\\';
+                        *out++ = 'b';
                         break;
                     case '\f' :
-                        data_.push_back('\\');
-                        data_.push_back('f');
+                        *out++ = '\\';
+                        *out++ = 'f';
                         break;
                     case '\n' :
-                        data_.push_back('\\');
-                        data_.push_back('n');
+                        *out++ = '\\';
+                        *out++ = 'n';
                         break;
                     case '\r' :
-                        data_.push_back('\\');
-                        data_.push_back('r');
+                        *out++ = '\\';
+                        *out++ = 'r';
                         break;
                     case '\t' :
-                        data_.push_back('\\');
-                        data_.push_back('t');
+                        *out++ = '\\';
+                        *out++ = 't';
                         break;
                     default:
-                        data_.push_back(*s);
+                        *out++ = *s;
                     }
                 }
 
-                data_.push_back('\"');
+                *out++ = '\"';
+                assert( out == data_.end() );
             }
 
             void visit(const impl_visitor& v) const 
@@ -201,7 +510,7 @@ namespace json
 
             void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const
             {
-                const_buffer_sequence.push_back(boost::asio::buffer(data_));
+                const_buffer_sequence.push_back(boost::asio::buffer(data_.begin(), data_.size()));
             }
 
             type_code code() const
@@ -214,7 +523,8 @@ namespace json
                 return "string";
             }
 
-            std::vector<char>   data_;
+        public:
+            text    data_;
         };
 
         ///////////////////////////////////////
@@ -222,42 +532,36 @@ namespace json
         class number_impl : public value::impl
         {
         public:
-            explicit number_impl(std::vector<char>& buffer)
+            number_impl(const tools::substring& json, arena::storage* memory)
+                : data_(json.begin(), json.end(), memory)
             {
-                data_.swap(buffer);
             }
 
-            explicit number_impl(int val)
-                : data_()   
+            number_impl(const text& json, arena::storage* memory)
+                : data_(json.begin(), json.end(), memory)
             {
-                if ( val == 0 )
-                {
-                    data_.push_back('0');
-                    return;
-                }
-
-                bool negativ = false; 
+            }
 
-                if ( val < 0 )
-                {
-                    negativ = true;
-                    val = -val;
-                }
+            explicit number_impl(int val)
+                : data_(digits(val), 0)
+            {
+                unsigned abs = val < 0 ? 0u - static_cast<unsigned>(val) : static_cast<unsigned>(val);
+                char*    out = data_.data() + data_.size();
 
-                for ( ; val != 0; val = val / 10)
+                do
                 {
-                    data_.insert(data_.begin(), (val % 10) + '0');
+                    *--out = static_cast<char>('0' + abs % 10);
+                    abs /= 10;
                 }
+                while ( abs != 0 );
 
-                if ( negativ )
-                    data_.insert(data_.begin(), '-');
+                if ( val < 0 )
+                    *--out = '-';
             }
 
-            explicit number_impl(double val)
-                : data_()
+            explicit number_impl(const std::string& formatted)
+                : data_(formatted.data(), formatted.data() + formatted.size(), 0)
             {
-                const std::string s = tools::as_string(val);
-                data_.insert(data_.begin(), s.begin(), s.end());
             }
 
             bool operator<(const number_impl& rhs) const
@@ -267,7 +571,7 @@ namespace json
 
             int to_int() const
             {
-                const tools::basic_substring<std::vector<char>::const_iterator> s(data_.begin(), data_.end());
+                const tools::substring s(data_.begin(), data_.end());
                 return boost::lexical_cast<int>(s);
             }
         private:
@@ -283,7 +587,7 @@ namespace json
 
             void to_json(std::vector<boost::asio::const_buffer>& const_buffer_sequence) const
             {
-                const_buffer_sequence.push_back(boost::asio::buffer(data_));
+                const_buffer_sequence.push_back(boost::asio::buffer(data_.begin(), data_.size()));
             }
 
             type_code code() const 
@@ -296,17 +600,105 @@ namespace json
                 return "number";
             }
 
-            std::vector<char>   data_;
+            // number of characters needed to print val
+            static std::size_t digits(int val)
+            {
+                unsigned    abs    = val < 0 ? 0u - static_cast<unsigned>(val) : static_cast<unsigned>(val);
+                std::size_t result = val < 0 ? 2 : 1;
+
+                for ( ; abs >= 10; abs /= 10 )
+                    ++result;
+
+                return result;
+            }
+
+        public:
+            text    data_;
         };
 
         ////////////////////
         // class object_impl
+        const string_impl& key_impl(const string& key)
+        {
+            return static_cast<const string_impl&>(implementation(key));
+        }
+
+        const text& key_text(const string& key)
+        {
+            return key_impl(key).data_;
+        }
+
+        // two different atoms never have the same text
+        bool same_key(const string_impl& lhs, const string& rhs)
+        {
+            const string_impl& key = key_impl(rhs);
+
+            if ( &lhs == &key )
+                return true;
+
+            if ( lhs.arena_ == permanent_arena() && key.arena_ == permanent_arena() )
+                return false;
+
+            return equal_impl(lhs.data_, key.data_);
+        }
+
+        /*
+         * The members are stored in a vector, in the order of their keys, like a std::map<string, value> would
+         * store them, so that the serialization is deterministic. Small objects, like bayeux messages, are searched
+         * linearly. Objects with more than linear_limit members get an open addressing hash index into the vector.
+         * The parser appends all members of an object unordered and sorts and indexes them once, when the object is
+         * complete.
+         *
+         * Adding a member, that does not go behind the last member, and erasing a member other than the last, moves
+         * the following members and renumbers their slots in the index. That is O(n) per call, but without hashing
+         * or allocating. Bulk construction thus has to use append() and complete(), like the parser and promote() do.
+         */
         class object_impl : public value::impl
         {
         public:
+            static const std::size_t linear_limit = 8;
+
+            // like std::map::insert(), an already existing member is not replaced
             void add(const string& name, const value& val)
             {
-                members_.insert(std::make_pair(name, val));
+                const string_impl& key = key_impl(name);
+
+                if ( index_of(key) != npos )
+                    return;
+
+                // members are usually added in order, when parsing a serialized object
+                list_t::iterator pos = members_.end();
+
+                if ( !members_.empty() && less_impl(key.data_, key_text(members_.back().first)) )
+                    pos = std::upper_bound(members_.begin(), members_.end(), key.data_, key_less());
+
+                const std::size_t index = pos - members_.begin();
+                members_.insert(pos, std::make_pair(name, val));
+
+                if ( !slots_.empty() || members_.size() > linear_limit )
+                    index_inserted(index, key);
+            }
+
+            // appends a member, without keeping the order or the index; complete() has to be called, before the
+            // object is used
+            void append(const string& name, const value& val)
+            {
+                members_.push_back(std::make_pair(name, val));
+            }
+
+            // orders the appended members and builds the index. Like add(), the first member with a given key wins.
+            void complete()
+            {
+                if ( std::adjacent_find(members_.begin(), members_.end(), member_not_less()) != members_.end() )
+                {
+                    std::stable_sort(members_.begin(), members_.end(), member_less());
+                    members_.erase(std::unique(members_.begin(), members_.end(), member_equal()), members_.end());
+                }
+
+                if ( members_.size() > linear_limit )
+                    rebuild_index();
+                else
+                    slots_t().swap(slots_);
             }
 
             bool operator<(const object_impl& rhs) const
@@ -323,6 +715,8 @@ namespace json
             std::vector<string> keys() const
             {
                 std::vector<string> result;
+                result.reserve(members_.size());
+
                 for ( list_t::const_iterator i = members_.begin(); i != members_.end(); ++i )
                     result.push_back(i->first);
 
@@ -331,17 +725,32 @@ namespace json
 
             void erase(const string& key)
             {
-                members_.erase(key);
+                const std::size_t index = index_of(key_impl(key));
+
+                if ( index == npos )
+                    return;
+
+                if ( members_.size() > linear_limit + 1 )
+                {
+                    erase_slot(index);
+                    members_.erase(members_.begin() + index);
+                    index_erased(index);
+                }
+                else
+                {
+                    members_.erase(members_.begin() + index);
+                    slots_t().swap(slots_);
+                }
             }
 
             value& at(const string& key)
             {
-                const list_t::iterator pos = members_.find(key);
+                const std::size_t index = index_of(key_impl(key));
 
-                if ( pos == members_.end() )
+                if ( index == npos )
                     throw std::out_of_range( "object::at() out of range: " + key.to_std_string() );
 
-                return pos->second;
+                return members_[index].second;
             }
 
             const value& at(const string& key) const
@@ -351,16 +760,14 @@ namespace json
 
             const value* find( const string& key ) const
             {
-                const list_t::const_iterator pos = members_.find(key);
-
-                return pos == members_.end() ? 0 : &pos->second;
+                return const_cast< object_impl& >( *this ).find( key );
             }
 
             value* find( const string& key )
             {
-                const list_t::iterator pos = members_.find(key);
+                const std::size_t index = index_of(key_impl(key));
 
-                return pos == members_.end() ? 0 : &pos->second;
+                return index == npos ? 0 : &members_[index].second;
             }
 
             bool empty() const
@@ -368,6 +775,151 @@ namespace json
                 return members_.empty();
             }
         private:
+            static const std::size_t npos = static_cast<std::size_t>(-1);
+
+            struct key_less
+            {
+                bool operator()(const text& key, const std::pair<string, value>& member) const
+                {
+                    return less_impl(key, key_text(member.first));
+                }
+            };
+
+            struct member_less
+            {
+                bool operator()(const std::pair<string, value>& lhs, const std::pair<string, value>& rhs) const
+                {
+                    return less_impl(key_text(lhs.first), key_text(rhs.first));
+                }
+            };
+
+            struct member_not_less
+            {
+                bool operator()(const std::pair<string, value>& lhs, const std::pair<string, value>& rhs) const
+                {
+                    return !less_impl(key_text(lhs.first), key_text(rhs.first));
+                }
+            };
+
+            struct member_equal
+            {
+                bool operator()(const std::pair<string, value>& lhs, const std::pair<string, value>& rhs) const
+                {
+                    return equal_impl(key_text(lhs.first), key_text(rhs.first));
+                }
+            };
+
+            std::size_t index_of(const string_impl& key) const
+            {
+                if ( slots_.empty() )
+                {
+                    for ( std::size_t index = 0; index != members_.size(); ++index )
+                    {
+                        if ( same_key(key, members_[index].first) )
+                            return index;
+                    }
+
+                    return npos;
+                }
+
+                const std::size_t mask = slots_.size() - 1;
+
+                for ( std::size_t slot = hash_impl(key.data_) & mask; slots_[slot] != 0; slot = (slot + 1) & mask )
+                {
+                    const std::size_t index = slots_[slot] - 1;
+
+                    if ( same_key(key, members_[index].first) )
+                        return index;
+                }
+
+                return npos;
+            }
+
+            // a slot holds the index of a member + 1, or 0 if it's free
+            void insert_slot(const text& key, std::size_t index)
+            {
+                const std::size_t mask = slots_.size() - 1;
+                std::size_t       slot = hash_impl(key) & mask;
+
+                for ( ; slots_[slot] != 0; slot = (slot + 1) & mask )
+                    ;
+
+                slots_[slot] = static_cast<boost::uint32_t>(index + 1);
+            }
+
+            void index_inserted(std::size_t index, const string_impl& key)
+            {
+                // keep the load factor below 1/2
+                if ( 2 * members_.size() > slots_.size() )
+                {
+                    rebuild_index();
+                    return;
+                }
+
+                // an appended member does not move other members
+                if ( index + 1 != members_.size() )
+                {
+                    for ( slots_t::iterator slot = slots_.begin(); slot != slots_.end(); ++slot )
+                    {
+                        if ( *slot > index )
+                            ++*slot;
+                    }
+                }
+
+                insert_slot(key.data_, index);
+            }
+
+            // removes the slot of the member at index from the index, by moving following slots of the same cluster
+            // back, so that no lookup has to skip over deleted slots
+            void erase_slot(std::size_t index)
+            {
+                const std::size_t mask = slots_.size() - 1;
+                std::size_t       slot = hash_impl(key_text(members_[index].first)) & mask;
+
+                for ( ; slots_[slot] != index + 1; slot = (slot + 1) & mask )
+                    ;
+
+                for ( std::size_t next = (slot + 1) & mask; slots_[next] != 0; next = (next + 1) & mask )
+                {
+                    const std::size_t home = hash_impl(key_text(members_[slots_[next] - 1].first)) & mask;
+
+                    // the member in next can be found from slot, if slot is not in front of its home slot
+                    if ( ((next - home) & mask) >= ((next - slot) & mask) )
+                    {
+                        slots_[slot] = slots_[next];
+                        slot         = next;
+                    }
+                }
+
+                slots_[slot] = 0;
+            }
+
+            void index_erased(std::size_t index)
+            {
+                // erasing the last member does not move other members
+                if ( index == members_.size() )
+                    return;
+
+                for ( slots_t::iterator slot = slots_.begin(); slot != slots_.end(); ++slot )
+                {
+                    if ( *slot > index )
+                        --*slot;
+                }
+            }
+
+            void rebuild_index()
+            {
+                std::size_t size = 4 * linear_limit;
+
+                for ( ; size < 4 * members_.size(); size *= 2 )
+                    ;
+
+                slots_.assign(size, 0);
+
+                for ( std::size_t index = 0; index != members_.size(); ++index )
+                    insert_slot(key_text(members_[index].first), index);
+            }
+
             void visit(const impl_visitor& v) const
             {
                 v.visit(*this);
@@ -422,7 +974,11 @@ namespace json
                 return "object";
             }
 
-            typedef std::map<string, value> list_t;
+            typedef std::vector<boost::uint32_t> slots_t;
+            slots_t slots_;
+
+        public:
+            typedef std::vector<std::pair<string, value> > list_t;
             list_t members_;
         };
 
@@ -667,6 +1223,116 @@ namespace json
     	return get_impl< string_impl >().to_std_string();
     }
 
+    string::string( impl* p )
+        : value( p )
+    {
+    }
+
+    ////////
+    // atoms
+    namespace {
+        /*
+         * all atoms in a fixed size open addressing hash table, keyed by their json encoded text. Atoms are only
+         * added and never removed, so that parsers can look up keys without locking.
+         */
+        class atom_table : boost::noncopyable
+        {
+        public:
+            atom_table()
+                : atoms_(0)
+            {
+                for ( std::size_t slot = 0; slot != table_size; ++slot )
+                    slots_[slot].store(0, boost::memory_order_relaxed);
+            }
+
+            // the atom with the json encoded text [begin, end), or null
+            string_impl* find(const char* begin, const char* end) const
+            {
+                const std::size_t size = end - begin;
+
+                for ( std::size_t slot = hash_impl(begin, end) & mask; ; slot = (slot + 1) & mask )
+                {
+                    string_impl* const atom = slots_[slot].load(boost::memory_order_acquire);
+
+                    if ( atom == 0 )
+                        return 0;
+
+                    if ( atom->data_.size() == size && std::memcmp(atom->data_.begin(), begin, size) == 0 )
+                        return atom;
+                }
+            }
+
+            // adds candidate, if there is no atom with the same text. Returns the atom, or null if the table is full
+            string_impl* insert(string_impl* candidate)
+            {
+                // keep the load factor below 1/2
+                if ( atoms_.fetch_add(1, boost::memory_order_relaxed) >= table_size / 2 )
+                {
+                    atoms_.fetch_sub(1, boost::memory_order_relaxed);
+                    return 0;
+                }
+
+                const text& key = candidate->data_;
+
+                for ( std::size_t slot = hash_impl(key) & mask; ; slot = (slot + 1) & mask )
+                {
+                    string_impl* atom = 0;
+
+                    if ( slots_[slot].compare_exchange_strong(atom, candidate, boost::memory_order_acq_rel) )
+                        return candidate;
+
+                    // an other thread was faster
+                    if ( equal_impl(atom->data_, key) )
+                    {
+                        atoms_.fetch_sub(1, boost::memory_order_relaxed);
+                        return atom;
+                    }
+                }
+            }
+
+        private:
+            static const std::size_t table_size = 1024;
+            static const std::size_t mask       = table_size - 1;
+
+            boost::atomic<std::size_t>      atoms_;
+            boost::atomic<string_impl*>     slots_[table_size];
+        };
+
+        atom_table& atoms()
+        {
+            static atom_table table;
+
+            return table;
+        }
+    }
+
+    string atom(const char* s)
+    {
+        string_impl* const  candidate = new string_impl(s, 0);
+        const text&         key       = candidate->data_;
+        string_impl*        result    = atoms().find(key.begin(), key.end());
+
+        if ( result == 0 )
+        {
+            // has to be marked, before it's visible to other threads
+            candidate->arena_ = permanent_arena();
+            result = atoms().insert(candidate);
+
+            if ( result == candidate )
+                return string(result);
+
+            candidate->arena_ = 0;
+
+            // the table is full
+            if ( result == 0 )
+                return string(candidate);
+        }
+
+        delete candidate;
+
+        return string(result);
+    }
+
     ///////////////
     // class number
     number::number(int val)
@@ -675,7 +1341,7 @@ namespace json
     }
 
     number::number(double val)
-        : value(new number_impl(val))
+        : value(new number_impl(tools::as_string(val)))
     {
     }
 
@@ -836,21 +1502,21 @@ namespace json
     }
 
     namespace {
-        const boost::shared_ptr<value::impl>& single_true()
+        const boost::intrusive_ptr<value::impl>& single_true()
         {
-            static const boost::shared_ptr<value::impl> result(new true_impl());
+            static const boost::intrusive_ptr<value::impl> result(new true_impl());
             return result;
         }
 
-        const boost::shared_ptr<value::impl>& single_false()
+        const boost::intrusive_ptr<value::impl>& single_false()
         {
-            static const boost::shared_ptr<value::impl> result(new false_impl());
+            static const boost::intrusive_ptr<value::impl> result(new false_impl());
             return result;
         }
 
-        const boost::shared_ptr<value::impl>& single_null()
+        const boost::intrusive_ptr<value::impl>& single_null()
         {
-            static const boost::shared_ptr<value::impl> result(new null_impl());
+            static const boost::intrusive_ptr<value::impl> result(new null_impl());
             return result;
         }
     }
@@ -1125,13 +1791,91 @@ namespace json
         pimpl_.swap( other.pimpl_ );
     }
 
+    bool value::arena_allocated() const
+    {
+        if ( pimpl_->arena_ && pimpl_->arena_ != permanent_arena() )
+            return true;
+
+        if ( pimpl_->code() == impl::object_code )
+        {
+            const object_impl::list_t& members = get_impl< object_impl >().members_;
+
+            for ( object_impl::list_t::const_iterator i = members.begin(); i != members.end(); ++i )
+            {
+                if ( i->first.arena_allocated() || i->second.arena_allocated() )
+                    return true;
+            }
+        }
+        else if ( pimpl_->code() == impl::array_code )
+        {
+            const array_impl::list_t& members = get_impl< array_impl >().members_;
+
+            for ( array_impl::list_t::const_iterator i = members.begin(); i != members.end(); ++i )
+            {
+                if ( i->arena_allocated() )
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    value value::promote() const
+    {
+        if ( !arena_allocated() )
+            return *this;
+
+        switch ( pimpl_->code() )
+        {
+        case impl::string_code:
+            return value( new string_impl( get_impl< string_impl >().data_, 0 ) );
+        case impl::number_code:
+            return value( new number_impl( get_impl< number_impl >().data_, 0 ) );
+        case impl::object_code:
+            {
+                const object_impl::list_t&  members = get_impl< object_impl >().members_;
+                object_impl* const          result  = new object_impl;
+                const value                 keep( result );
+
+                result->members_.reserve( members.size() );
+
+                for ( object_impl::list_t::const_iterator i = members.begin(); i != members.end(); ++i )
+                {
+                    const value name = i->first.promote();
+                    result->append( static_cast< const string& >( name ), i->second.promote() );
+                }
+
+                result->complete();
+
+                return keep;
+            }
+        case impl::array_code:
+            {
+                const array_impl::list_t&   members = get_impl< array_impl >().members_;
+                array_impl* const           result  = new array_impl;
+                const value                 keep( result );
+
+                result->members_.reserve( members.size() );
+
+                for ( array_impl::list_t::const_iterator i = members.begin(); i != members.end(); ++i )
+                    result->add( i->promote() );
+
+                return keep;
+            }
+        default:
+            break;
+        }
+
+        return *this;
+    }
+
     value::value(impl* p)
         : pimpl_(p)
     {
         assert( p );
     }
 
-    value::value(const boost::shared_ptr<impl>& impl)
+    value::value(const boost::intrusive_ptr<impl>& impl)
         : pimpl_(impl)
     {
         assert( pimpl_.get() );
@@ -1212,12 +1956,128 @@ namespace json
         state_.push( idle_parsing );
     }
 
+    parser::parser( const arena& memory )
+        : arena_( memory.storage_ )
+    {
+        state_.push( idle_parsing );
+    }
+
+    template < class Impl >
+    value parser::make_value()
+    {
+        if ( !arena_ )
+            return value( new Impl );
+
+        Impl* const result = new ( arena_->allocate( sizeof( Impl ) ) ) Impl;
+        result->arena_ = arena_.get();
+        intrusive_ptr_add_ref( arena_.get() );
+
+        return value( result );
+    }
+
+    template < class Impl >
+    value parser::make_text_value( const char* begin, const char* end )
+    {
+        const tools::substring json( begin, end );
+
+        if ( !arena_ )
+            return value( new Impl( json, 0 ) );
+
+        Impl* const result = new ( arena_->allocate( sizeof( Impl ) ) ) Impl( json, arena_.get() );
+        result->arena_ = arena_.get();
+        intrusive_ptr_add_ref( arena_.get() );
+
+        return value( result );
+    }
+
+    value parser::make_key( const char* begin, const char* end )
+    {
+        if ( value::impl* const key = atoms().find( begin, end ) )
+            return value( key );
+
+        return make_text_value< string_impl >( begin, end );
+    }
+
+    // a string or number, that was split over several calls to parse() and was thus collected in buffer_
+    template < class Impl >
+    value parser::make_buffered_text_value()
+    {
+        assert( !buffer_.empty() );
+        const value result = make_text_value< Impl >( &buffer_[ 0 ], &buffer_[ 0 ] + buffer_.size() );
+        buffer_.clear();
+
+        return result;
+    }
+
+    // on, unless select_parser_fast_paths( false ) was called
+    static bool& parser_fast_paths()
+    {
+        static bool enabled = true;
+
+        return enabled;
+    }
+
+    void select_parser_fast_paths( bool enabled )
+    {
+        parser_fast_paths() = enabled;
+    }
+
+    // most tokens are not preceded by white space, so the scanner is only called for runs of white space
     static const char* eat_white_space(const char* begin, const char* end)
     {
-        for ( ; begin != end && ( *begin == ' ' || *begin == '\t' || *begin == '\n' || *begin == '\r' ); ++begin )
-            ;
+        if ( begin == end || ( *begin != ' ' && *begin != '\t' && *begin != '\n' && *begin != '\r' ) )
+            return begin;
 
-        return begin;
+        return skip_white_space(begin + 1, end);
+    }
+
+    static bool is_escapeable(char c)
+    {
+        static const char escapeable_characters[] = { '\"', '\\', '/', 'b', 'f', 'n', 'r', 't'};
+
+        return std::find(tools::begin(escapeable_characters), tools::end(escapeable_characters), c)
+            != tools::end(escapeable_characters);
+    }
+
+    static bool is_hex_digit(char c)
+    {
+        return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+    }
+
+    /*
+     * returns a pointer behind the closing quote of the string that starts with the opening quote at begin, or 0,
+     * if the string is not completely contained in [begin, end) or contains an invalid escape sequence. In this
+     * case, the string has to be parsed character by character, to report the error or to wait for more input.
+     */
+    static const char* find_string_end(const char* begin, const char* end)
+    {
+        assert(begin != end && *begin == '\"');
+
+        for ( const char* p = find_string_delimiter(begin + 1, end); p != end; p = find_string_delimiter(p, end) )
+        {
+            if ( *p == '\"' )
+                return p + 1;
+
+            if ( end - p < 2 )
+                return 0;
+
+            if ( p[1] == 'u' )
+            {
+                if ( end - p < 6 || !is_hex_digit(p[2]) || !is_hex_digit(p[3]) || !is_hex_digit(p[4]) || !is_hex_digit(p[5]) )
+                    return 0;
+
+                p += 6;
+            }
+            else
+            {
+                if ( !is_escapeable(p[1]) )
+                    return 0;
+
+                p += 2;
+            }
+        }
+
+        return 0;
     }
 
     std::pair< bool, bool > parser::parse(const char* begin, const char* end)
@@ -1325,7 +2185,9 @@ namespace json
     const char* parser::parse_number(const char* begin, const char* end)
     {
         assert(!state_.empty());
-        bool stop = false;
+        const char* const   start = begin;
+        int                 state = state_.top();
+        bool                stop  = false;
 
         for ( ; begin != end && !stop; )
         {
@@ -1333,41 +2195,41 @@ namespace json
             {
             case '-':
             case '+':
-                if ( state_.top() > start_number_parsing && state_.top() != exponent_parsed )
+                if ( state > start_number_parsing && state != exponent_parsed )
                     throw parse_error("unexpected sign");
 
-                state_.top() = state_.top() == exponent_parsed
+                state = state == exponent_parsed
                     ? exponent_sign_parsed
                     : sign_parsed;
                 break;
             case '.':
-                if ( state_.top() != pre_dot_parsed && state_.top() != leading_zero_parsed )
+                if ( state != pre_dot_parsed && state != leading_zero_parsed )
                     throw parse_error("unexpected dot(.)");
 
-                state_.top() = dot_parsed;
+                state = dot_parsed;
                 break;
             case '0':
-                if ( state_.top() != sign_parsed && state_.top() != start_number_parsing && state_.top() != pre_dot_parsed
-                    && state_.top() != dot_parsed && state_.top() != post_dot_parsed && state_.top() < exponent_parsed )
+                if ( state != sign_parsed && state != start_number_parsing && state != pre_dot_parsed
+                    && state != dot_parsed && state != post_dot_parsed && state < exponent_parsed )
                 {
                     throw parse_error("unexpected 0");
                 }
 
-                state_.top() = state_after_digit(state_.top());
+                state = state_after_digit(state);
                 break;
             case 'e':
             case 'E':
-                if ( state_.top() != leading_zero_parsed && state_.top() != pre_dot_parsed && state_.top() != post_dot_parsed )
+                if ( state != leading_zero_parsed && state != pre_dot_parsed && state != post_dot_parsed )
                     throw parse_error("unexpected exponent");
 
-                state_.top() = exponent_parsed;
+                state = exponent_parsed;
                 break;
             default :
                 if (isdigit(*begin))
                 {
-                    state_.top() = state_after_digit(state_.top());
+                    state = state_after_digit(state);
                 }
-                else if ( is_complete_number(state_.top()) )
+                else if ( is_complete_number(state) )
                 {
                     stop = true;
                 }
@@ -1378,15 +2240,24 @@ namespace json
             }
 
             if ( !stop )
-            {
-                buffer_.push_back(*begin);
                 ++begin;
-            }
         }
 
-        if ( stop )
+        state_.top() = state;
+
+        if ( !stop )
+        {
+            // the number might continue with the next call to parse()
+            buffer_.insert(buffer_.end(), start, begin);
+        }
+        else if ( buffer_.empty() && parser_fast_paths() )
+        {
+            value_parsed(make_text_value<number_impl>(start, begin));
+        }
+        else
         {
-            value_parsed(value(new number_impl(buffer_)));
+            buffer_.insert(buffer_.end(), start, begin);
+            value_parsed(make_buffered_text_value<number_impl>());
         }
 
         return begin;
@@ -1399,7 +2270,7 @@ namespace json
             assert(begin != end && *begin == '[');
 
             state_.top() = left_bracket_parsed;             
-            result_.push(array());
+            result_.push(make_value<array_impl>());
 
             ++begin;
         }
@@ -1460,7 +2331,7 @@ namespace json
             assert(begin != end && *begin == '{');
 
             state_.top() = left_brace_parsed;             
-            result_.push(object());
+            result_.push(make_value<object_impl>());
 
             ++begin;
         }
@@ -1472,13 +2343,25 @@ namespace json
             {
                 if ( *begin == '}' )
                 {
+                    result_.top().get_impl<object_impl>().complete();
+
                     ++begin;
                     state_.pop();
                 }
                 else if ( *begin == '\"' )
                 {
                     state_.top() = member_name_parsed;
-                    state_.push(start_string_parsing);
+
+                    // keys, that are completely contained in the input, might be atoms
+                    if ( const char* const key_end = find_string_end(begin, end) )
+                    {
+                        result_.push(make_key(begin, key_end));
+                        begin = key_end;
+                    }
+                    else
+                    {
+                        state_.push(start_string_parsing);
+                    }
                 }
                 else
                 {
@@ -1519,7 +2402,7 @@ namespace json
                 string name = static_cast<string&>(result_.top());
                 result_.pop();
 
-                static_cast<object&>(result_.top()).add(name, val);
+                result_.top().get_impl<object_impl>().append(name, val);
             }
         }
 
@@ -1538,6 +2421,13 @@ namespace json
                 assert(*begin == '\"');
                 assert(buffer_.empty());
 
+                // the whole string is in the input, so it can be constructed without copying it into buffer_
+                if ( const char* const string_end = parser_fast_paths() ? find_string_end(begin, end) : 0 )
+                {
+                    value_parsed( make_text_value< string_impl >( begin, string_end ) );
+                    return string_end;
+                }
+
                 state_.top() = string_parsing;
 
                 buffer_.push_back(*begin);
@@ -1545,9 +2435,7 @@ namespace json
                 break;
             case string_parsing:
                 {
-                    const char* p = begin;
-                    for ( ; p != end && *p != '\"' && *p != '\\'; ++p )
-                        ;
+                    const char* const p = find_string_delimiter( begin, end );
 
                     buffer_.insert( buffer_.end(), begin, p );
                     begin = p;
@@ -1557,7 +2445,7 @@ namespace json
                         buffer_.push_back( *begin );
                         if ( *begin == '\"' )
                         {
-                            value_parsed( value( new string_impl( buffer_ ) ) );
+                            value_parsed( make_buffered_text_value< string_impl >() );
                             stop = true;
                         }
                         else 
@@ -1578,13 +2466,8 @@ namespace json
                     }
                     else
                     {
-                        static const char escapeable_characters[] = { '\"', '\\', '/', 'b', 'f', 'n', 'r', 't'};
-
-                        if ( std::find(tools::begin(escapeable_characters), tools::end(escapeable_characters), *begin)
-                             == tools::end(escapeable_characters) )
-                        {
+                        if ( !is_escapeable(*begin) )
                             throw parse_error("Unexpected escaped char: " + tools::as_string(int(*begin)));
-                        }
 
                         state_.top() = string_parsing;
                     }
@@ -1599,7 +2482,7 @@ namespace json
                     static_cast<void>(missing_hexdigits);
                     assert(missing_hexdigits > 0 && missing_hexdigits <= 4);
                     
-                    if (!std::isxdigit(*begin))
+                    if (!is_hex_digit(*begin))
                         throw parse_error("Hex-Digit expected.");
 
                     buffer_.push_back(*begin);
@@ -1662,7 +2545,7 @@ namespace json
             if ( !is_complete_number( state_.top() ) )
                 throw parse_error( "incomplete json number" );
 
-            value_parsed( value( new number_impl( buffer_ ) ) );
+            value_parsed( make_buffered_text_value< number_impl >() );
         }
 
         if ( !state_.empty() || result_.size() != 1 )
@@ -1674,6 +2557,25 @@ namespace json
         return parse(text.begin(), text.end());
     }
 
+    value parse(const char* begin, const char* end, const arena& memory)
+    {
+        parser p(memory);
+
+        const std::pair< bool, bool > parse_result = p.parse(begin, end);
+
+        if ( parse_result.first )
+        {
+            if ( !parse_result.second )
+                p.flush();
+        }
+        else
+        {
+            throw parse_error("extra characters after JSON expression.");
+        }
+
+        return p.result();
+    }
+
     value parse_single_quoted( const std::string single_quoted_string )
     {
 		std::string txt( single_quoted_string );
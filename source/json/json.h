@@ -5,8 +5,10 @@
 #ifndef SIOUX_SOURCE_JSON_JSON_H
 #define SIOUX_SOURCE_JSON_JSON_H
 
+#include <boost/intrusive_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/asio/buffer.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 #include <cstddef>
 #include <vector>
 #include <string>
@@ -18,6 +20,7 @@
 namespace json
 {
     class parser;
+    class arena;
 
     class value;
     class string;
@@ -28,6 +31,20 @@ namespace json
     class false_val;
     class null;
 
+    namespace detail {
+        /*
+         * iterators over characters, that are stored contiguously in memory and can thus be parsed without copying
+         */
+        template < class Iter >
+        struct contiguous_chars : boost::false_type {};
+
+        template <> struct contiguous_chars< char* > : boost::true_type {};
+        template <> struct contiguous_chars< std::string::iterator > : boost::true_type {};
+        template <> struct contiguous_chars< std::string::const_iterator > : boost::true_type {};
+        template <> struct contiguous_chars< std::vector< char >::iterator > : boost::true_type {};
+        template <> struct contiguous_chars< std::vector< char >::const_iterator > : boost::true_type {};
+    }
+
     /**
      * @brief interface to examine a value
      */
@@ -124,9 +141,23 @@ namespace json
          * @exception none _
          */
         void swap( value& other );
+
+        /**
+         * @brief returns true, if this value or one of its elements was allocated from an arena
+         */
+        bool arena_allocated() const;
+
+        /**
+         * @brief returns a value equal to this, that is not allocated from an arena
+         *
+         * A value, that was parsed into an arena, keeps the whole arena alive. Before storing such a value, or a
+         * part of it, beyond the scope of the request, the value should be promoted to a heap allocated copy. If
+         * neither this value nor one of its elements was allocated from an arena, *this is returned.
+         */
+        value promote() const;
     protected:
         explicit value(impl*);
-        explicit value(const boost::shared_ptr<impl>& impl);
+        explicit value(const boost::intrusive_ptr<impl>& impl);
 
         template <class Type>
         Type& get_impl();
@@ -134,11 +165,24 @@ namespace json
         template <class Type>
         const Type& get_impl() const;
     private:
-        boost::shared_ptr<impl> pimpl_;
+        boost::intrusive_ptr<impl> pimpl_;
 
         friend class parser;
+        friend const impl& implementation(const value&);
     };
 
+    /**
+     * @brief the implementations of all values are reference counted intrusively, so that a value costs a single
+     *        allocation at most
+     * @relates value
+     */
+    void intrusive_ptr_add_ref(value::impl*);
+
+    /**
+     * @relates value
+     */
+    void intrusive_ptr_release(value::impl*);
+
     /**
      * @relates value
      */
@@ -181,8 +225,26 @@ namespace json
          * But instead to to_json() is the text not json encoded.
          */
         std::string to_std_string() const;
+    private:
+        explicit string(impl*);
+
+        friend string atom(const char*);
     };
 
+    /**
+     * @brief returns the interned string with the given text
+     *
+     * Atoms are meant for the names of protocol fields, like "channel" or "clientId". All atoms with the same text
+     * share one implementation, that is never released. Object keys that a parser reads and that are equal to an
+     * atom refer to the atom instead of allocating a string of their own, and an object lookup of such a key with
+     * the atom is a pointer comparison. The number of atoms is limited. Once the limit is reached, atom() returns
+     * ordinary strings, that behave the same but are not shared.
+     *
+     * atom() is thread safe.
+     * @relates string
+     */
+    string atom(const char* text);
+
     class number : public value
     {
     public:
@@ -215,6 +277,9 @@ namespace json
 
         /**
          * @brief adds a new property to the object
+         *
+         * Adding properties in the order of their keys is cheapest. For objects with many properties, adding a
+         * property in front of others takes time linear in the number of properties.
          */
         object& add(const string& name, const value& val);
 
@@ -227,6 +292,9 @@ namespace json
 
         /**
          * @brief removes the element with the given key
+         *
+         * For objects with many elements, erasing an element other than the last takes time linear in the number of
+         * elements.
          */
         void erase(const string& key);
 
@@ -419,6 +487,54 @@ namespace json
         explicit parse_error(const std::string&);
     };
 
+    /**
+     * @brief monotonic memory, used by a parser to allocate the values of a request scoped json document
+     *
+     * The memory is allocated in chunks and released in one shot, when the arena and all values allocated from
+     * it are destroyed. The first chunk is small, so that small documents don't pin a lot of memory, and every
+     * further chunk doubles in size, up to the given chunk_size. Copies of an arena refer to the same memory. An
+     * arena is not thread safe, but values allocated from it can be passed to other threads like every other value.
+     */
+    class arena
+    {
+    public:
+        static const std::size_t default_chunk_size = 8 * 1024;
+        static const std::size_t first_chunk_size   = 256;
+
+        explicit arena( std::size_t chunk_size = default_chunk_size );
+
+        /**
+         * @brief the number of chunks allocated so far
+         */
+        std::size_t chunks() const;
+
+        /**
+         * @brief the number of bytes handed out so far
+         */
+        std::size_t allocated() const;
+
+        /**
+         * @brief the number of bytes of all chunks allocated so far
+         */
+        std::size_t capacity() const;
+
+        class storage;
+    private:
+        boost::intrusive_ptr< storage > storage_;
+
+        friend class parser;
+    };
+
+    /**
+     * @relates arena
+     */
+    void intrusive_ptr_add_ref(arena::storage*);
+
+    /**
+     * @relates arena
+     */
+    void intrusive_ptr_release(arena::storage*);
+
     /**
      * @brief a state full json parser
      */
@@ -427,6 +543,11 @@ namespace json
     public:
         parser();
 
+        /**
+         * @brief a parser that allocates all parsed values from the given arena
+         */
+        explicit parser( const arena& memory );
+
         /**
          * @brief tries to parse a json value by consuming the sequence [begin, end)
          *
@@ -436,11 +557,16 @@ namespace json
          */
         std::pair< bool, bool > parse( const char* begin, const char* end );
 
+        /**
+         * @copydoc parse( const char* begin, const char* end )
+         *
+         * Characters from std::string, std::vector< char > and char arrays are parsed in place, every other
+         * sequence is copied first.
+         */
         template <class Iter>
         std::pair< bool, bool > parse( Iter begin, Iter end )
         {
-            const std::vector< char > buffer( begin, end );
-            return parse( &buffer[ 0 ], &buffer[ 0 ] + buffer.size() );
+            return parse( begin, end, detail::contiguous_chars< Iter >() );
         }
 
         /**
@@ -460,6 +586,22 @@ namespace json
          */
         value result() const;
     private:
+        template <class Iter>
+        std::pair< bool, bool > parse( Iter begin, Iter end, boost::true_type )
+        {
+            const char* const first = begin == end ? 0 : &*begin;
+            return parse( first, first + ( end - begin ) );
+        }
+
+        template <class Iter>
+        std::pair< bool, bool > parse( Iter begin, Iter end, boost::false_type )
+        {
+            const std::vector< char > buffer( begin, end );
+            return buffer.empty()
+                ? parse( static_cast< const char* >( 0 ), static_cast< const char* >( 0 ) )
+                : parse( &buffer[ 0 ], &buffer[ 0 ] + buffer.size() );
+        }
+
         int parse_idle( char c );
         const char* parse_number( const char* begin, const char* end );
         const char* parse_array( const char* begin, const char* end );
@@ -469,11 +611,34 @@ namespace json
 
         void value_parsed( const value& );
 
-        std::vector< char >   buffer_;
-        std::stack< value >   result_;
-        std::stack< int >     state_;
+        template < class Impl >
+        value make_value();
+
+        // a string or number from the json encoded characters [begin, end)
+        template < class Impl >
+        value make_text_value( const char* begin, const char* end );
+
+        template < class Impl >
+        value make_buffered_text_value();
+
+        // an object key from the json encoded characters [begin, end); an atom, if there is one with that text
+        value make_key( const char* begin, const char* end );
+
+        boost::intrusive_ptr< arena::storage >  arena_;
+        std::vector< char >                     buffer_;
+        std::stack< value >                     result_;
+        std::stack< int >                       state_;
     };
 
+    /**
+     * @brief switches the fast paths of the parser on or off
+     *
+     * With the fast paths off, strings and numbers are always collected in the buffer of the parser, instead of
+     * being constructed from the input directly. Together with json::select_scanner( tools::scalar_isa ), this is the
+     * baseline, that benchmarks compare the parser with. The fast paths are on by default. Not thread safe.
+     */
+    void select_parser_fast_paths( bool enabled );
+
     /**
      * @brief constructs a value from a json text
      * @relates value
@@ -487,6 +652,12 @@ namespace json
      */
     value parse(const std::string text);
 
+    /**
+     * @brief constructs a value from a json text and allocates the value from the given arena
+     * @relates value
+     */
+    value parse(const char* begin, const char* end, const arena& memory);
+
     /**
      * @brief first substitutes all occurens of the ' (single quote) with a " (double quote) and than passes the
      *        result to parse()
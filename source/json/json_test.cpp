@@ -6,7 +6,10 @@
 #include "json/json.h"
 #include "tools/iterators.h"
 #include "tools/asstring.h"
+#include <boost/timer/timer.hpp>
+#include <deque>
 #include <iostream>
+#include <limits>
 
 BOOST_AUTO_TEST_CASE( json_string_test )
 {
@@ -48,6 +51,46 @@ BOOST_AUTO_TEST_CASE( json_number_test )
     BOOST_CHECK_EQUAL(3u, negativ.size());
 }
 
+BOOST_AUTO_TEST_CASE( json_number_limits_test )
+{
+    BOOST_CHECK_EQUAL("2147483647", json::number(std::numeric_limits<int>::max()).to_json());
+    BOOST_CHECK_EQUAL("-2147483648", json::number(std::numeric_limits<int>::min()).to_json());
+    BOOST_CHECK_EQUAL(std::numeric_limits<int>::min(), json::number(std::numeric_limits<int>::min()).to_int());
+}
+
+/*
+ * short strings are stored inline, longer strings on the heap; both have to behave the same
+ */
+BOOST_AUTO_TEST_CASE( short_and_long_strings_test )
+{
+    for ( std::size_t length = 0; length != 64; ++length )
+    {
+        const std::string   text(length, 'a');
+        const std::string   escaped = std::string(length, '\n');
+        const json::string  s(text.c_str());
+        const json::string  e(escaped.c_str());
+
+        BOOST_CHECK_EQUAL(text, s.to_std_string());
+        BOOST_CHECK_EQUAL('"' + text + '"', s.to_json());
+        BOOST_CHECK_EQUAL(length + 2, s.size());
+        BOOST_CHECK_EQUAL(2 * length + 2, e.size());
+
+        const json::value parsed = json::parse(s.to_json());
+        BOOST_CHECK_EQUAL(s, parsed);
+        BOOST_CHECK_EQUAL(e, json::parse(e.to_json()));
+
+        // copies share the representation
+        const json::value copy = parsed;
+        BOOST_CHECK_EQUAL(copy, s);
+
+        if ( length != 0 )
+        {
+            BOOST_CHECK(json::string(std::string(length - 1, 'a').c_str()) < s);
+            BOOST_CHECK(s != json::string(std::string(length, 'b').c_str()));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( json_object_test )
 {
     const json::object empty;
@@ -84,6 +127,156 @@ BOOST_AUTO_TEST_CASE( json_object_find_test )
     BOOST_CHECK( not_found == 0 );
 }
 
+/*
+ * objects with more members than can be searched linearly: members are found, kept in key order and not replaced
+ * by members with the same key
+ */
+BOOST_AUTO_TEST_CASE( large_object_test )
+{
+    const unsigned  size = 100;
+    json::object    obj;
+
+    // add in an order, that differs from the key order
+    for ( unsigned i = 0; i != size; ++i )
+    {
+        const unsigned key = i * 37 % size;
+        obj.add( json::string( ( "key" + tools::as_string( key ) ).c_str() ), json::number( int( key ) ) );
+    }
+
+    obj.add( json::string( "key42" ), json::null() );
+
+    const std::vector< json::string > keys = obj.keys();
+    BOOST_REQUIRE_EQUAL( size, keys.size() );
+
+    for ( std::vector< json::string >::size_type k = 1; k != keys.size(); ++k )
+        BOOST_CHECK( keys[ k - 1 ] < keys[ k ] );
+
+    for ( unsigned key = 0; key != size; ++key )
+    {
+        const json::string name( ( "key" + tools::as_string( key ) ).c_str() );
+
+        BOOST_REQUIRE( obj.find( name ) != 0 );
+        BOOST_CHECK_EQUAL( json::number( int( key ) ), obj.at( name ) );
+    }
+
+    BOOST_CHECK( obj.find( json::string( "key100" ) ) == 0 );
+    BOOST_CHECK_THROW( obj.at( json::string( "key" ) ), std::out_of_range );
+
+    // the serialization does not depend on the order, in which the members were added
+    json::object in_order;
+
+    for ( std::vector< json::string >::const_iterator k = keys.begin(); k != keys.end(); ++k )
+        in_order.add( *k, obj.at( *k ) );
+
+    BOOST_CHECK_EQUAL( in_order.to_json(), obj.to_json() );
+    BOOST_CHECK_EQUAL( in_order, obj );
+    BOOST_CHECK_EQUAL( json::parse( obj.to_json() ), obj );
+
+    // erase members, until the object is small enough to be searched linearly
+    json::object copy = obj.copy();
+
+    for ( unsigned key = 0; key != size - 3; ++key )
+    {
+        copy.erase( json::string( ( "key" + tools::as_string( key ) ).c_str() ) );
+        BOOST_CHECK( copy.find( json::string( ( "key" + tools::as_string( key ) ).c_str() ) ) == 0 );
+        BOOST_CHECK( copy.find( json::string( "key99" ) ) != 0 );
+    }
+
+    BOOST_CHECK_EQUAL( json::parse( "{\"key97\":97,\"key98\":98,\"key99\":99}" ), copy );
+    BOOST_CHECK_EQUAL( size, obj.keys().size() );
+}
+
+/*
+ * erasing members of a large object in an order, that differs from the key order, keeps all other members findable
+ */
+BOOST_AUTO_TEST_CASE( erase_from_large_object_test )
+{
+    const unsigned  size = 100;
+    json::object    obj;
+
+    for ( unsigned key = 0; key != size; ++key )
+        obj.add( json::string( ( "key" + tools::as_string( key ) ).c_str() ), json::number( int( key ) ) );
+
+    for ( unsigned i = 0; i != size / 2; ++i )
+    {
+        const unsigned erased = i * 37 % size;
+        obj.erase( json::string( ( "key" + tools::as_string( erased ) ).c_str() ) );
+
+        for ( unsigned key = 0; key != size; ++key )
+        {
+            const json::value* const found = obj.find( json::string( ( "key" + tools::as_string( key ) ).c_str() ) );
+            bool                     erased_before = false;
+
+            for ( unsigned j = 0; j <= i && !erased_before; ++j )
+                erased_before = j * 37 % size == key;
+
+            BOOST_REQUIRE_EQUAL( erased_before, found == 0 );
+
+            if ( found )
+                BOOST_REQUIRE_EQUAL( json::number( int( key ) ), *found );
+        }
+    }
+
+    BOOST_CHECK_EQUAL( size / 2, obj.keys().size() );
+
+    // erased members can be added again
+    obj.add( json::string( "key0" ), json::null() );
+    BOOST_CHECK_EQUAL( json::null(), obj.at( json::string( "key0" ) ) );
+    BOOST_CHECK_EQUAL( json::parse( obj.to_json() ), obj );
+}
+
+namespace {
+    std::string large_object_text( unsigned size, bool reverse )
+    {
+        std::string result = "{";
+
+        for ( unsigned i = 0; i != size; ++i )
+        {
+            const unsigned key = reverse ? size - i - 1 : i;
+            result += ( i == 0 ? "\"" : ",\"" ) + tools::as_string( key ) + "\":" + tools::as_string( key );
+        }
+
+        return result + "}";
+    }
+}
+
+/*
+ * parsing an object with a lot of members must not take quadratic time, independent from the order of the keys
+ */
+BOOST_AUTO_TEST_CASE( parse_large_object_test )
+{
+    const unsigned size = 200 * 1000;
+
+    for ( int reverse = 0; reverse != 2; ++reverse )
+    {
+        const std::string               text  = large_object_text( size, reverse != 0 );
+        const boost::timer::cpu_timer   timer;
+        const json::object              obj   = json::parse( text ).upcast< json::object >();
+
+        BOOST_CHECK_LT( timer.elapsed().wall / 1e9, 5.0 );
+
+        BOOST_CHECK_EQUAL( size, obj.keys().size() );
+        BOOST_CHECK_EQUAL( json::number( 4711 ), obj.at( json::string( "4711" ) ) );
+        BOOST_CHECK_EQUAL( json::parse( large_object_text( size, reverse == 0 ) ), obj );
+    }
+
+    // like object::add(), the first of the members with the same key wins
+    const json::value duplicates = json::parse( "{\"b\":1,\"a\":2,\"b\":3,\"c\":4,\"a\":5}" );
+    BOOST_CHECK_EQUAL( "{\"a\":2,\"b\":1,\"c\":4}", duplicates.to_json() );
+}
+
+/*
+ * keys of the same length are ordered by comparing chars, so non ASCII keys are placed in front of ASCII keys
+ */
+BOOST_AUTO_TEST_CASE( non_ascii_key_order_test )
+{
+    const json::value obj = json::parse( "{\"\xc3\xa9\":1,\"ab\":2}" );
+
+    BOOST_CHECK_EQUAL( "{\"\xc3\xa9\":1,\"ab\":2}", obj.to_json() );
+    BOOST_CHECK_EQUAL( json::parse( "{\"ab\":2,\"\xc3\xa9\":1}" ).to_json(), obj.to_json() );
+    BOOST_CHECK( json::string( "\xc3\xa9" ) < json::string( "ab" ) );
+}
+
 BOOST_AUTO_TEST_CASE( copy_object_test )
 {
 	const json::object obj = json::parse_single_quoted(
@@ -289,6 +482,87 @@ BOOST_AUTO_TEST_CASE( white_space_test )
     BOOST_CHECK_EQUAL(json::parse("{\"f o\":\"b a r\",\"b \":[1,2,true,false]}"), val);
 }
 
+/*
+ * strings with long runs of plain characters, escapes at every position and white space runs, longer than the
+ * vector width of the scanners, are parsed equally, when the input is split at any position
+ */
+BOOST_AUTO_TEST_CASE( long_strings_and_white_space_test )
+{
+    const std::string text =
+        "{\n                                        \"long\": \"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ\",\n"
+        "\t\t\t\t\t\t\t\t\"escapes\" :\r\n \"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e4 0123456789abcdefghijklmnopqrstuvwxyz\\\"\" ,"
+        "\"numbers\":[ 1234567890123 , -0.5e-10 ,0 ]                                        }";
+
+    const json::value result = json::parse( text );
+    BOOST_CHECK_EQUAL( json::string( "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJ" ),
+        result.upcast< json::object >().at( json::string( "long" ) ) );
+    BOOST_CHECK_EQUAL( "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u00e4 0123456789abcdefghijklmnopqrstuvwxyz\\\"\"",
+        result.upcast< json::object >().at( json::string( "escapes" ) ).to_json() );
+    BOOST_CHECK( split_parse( text ) );
+}
+
+/*
+ * invalid escape sequences are detected, no matter whether the string is complete in the input or not
+ */
+BOOST_AUTO_TEST_CASE( invalid_escapes_test )
+{
+    const char* invalid_strings[] = {
+        "\"\\a\"", "\"abc\\x\"", "\"\\u12g4\"", "\"\\u\"", "\"0123456789abcdefghijklmnopqrstuvwxyz\\'\""
+    };
+
+    for ( const char* const * i = tools::begin(invalid_strings); i != tools::end(invalid_strings); ++i)
+    {
+        const std::string s(*i);
+        BOOST_CHECK_THROW(json::parse(s.begin(), s.end()), json::parse_error);
+
+        json::parser p;
+        BOOST_CHECK_THROW(
+            for ( std::string::size_type c = 0; c != s.size(); ++c )
+                p.parse( s.data() + c, s.data() + c + 1 ),
+            json::parse_error );
+    }
+}
+
+/*
+ * contiguous and not contiguous character sequences result in the same values
+ */
+BOOST_AUTO_TEST_CASE( parse_from_different_containers )
+{
+    const std::string           text = "{\"a\":[1,\"b\",{\"c\":null}],\"d\":-12.5e3}";
+    const std::vector< char >   vector( text.begin(), text.end() );
+    const std::deque< char >    deque( text.begin(), text.end() );
+    std::vector< char >         mutable_vector( vector );
+
+    const json::value expected = json::parse( text.data(), text.data() + text.size(), json::arena() );
+
+    BOOST_CHECK_EQUAL( expected, json::parse( text ) );
+    BOOST_CHECK_EQUAL( expected, json::parse( vector.begin(), vector.end() ) );
+    BOOST_CHECK_EQUAL( expected, json::parse( mutable_vector.begin(), mutable_vector.end() ) );
+    BOOST_CHECK_EQUAL( expected, json::parse( deque.begin(), deque.end() ) );
+    BOOST_CHECK_EQUAL( expected, json::parse( &mutable_vector[ 0 ], &mutable_vector[ 0 ] + mutable_vector.size() ) );
+
+    // empty input is consumed, without parsing a value
+    json::parser p;
+    const std::string empty;
+    BOOST_CHECK( p.parse( empty.begin(), empty.end() ) == std::make_pair( true, false ) );
+    BOOST_CHECK( p.parse( deque.end(), deque.end() ) == std::make_pair( true, false ) );
+}
+
+/*
+ * the baseline of the parser benchmark, without the fast paths, results in the same values
+ */
+BOOST_AUTO_TEST_CASE( parse_without_fast_paths )
+{
+    const std::string text = "{\"a\":[1,\"b\\\"c\",{\"c\":null}],\"d\":-12.5e3, \"e\" : \"\\u00e4\"}";
+    const json::value expected = json::parse( text );
+
+    json::select_parser_fast_paths( false );
+    const json::value baseline = json::parse( text );
+    json::select_parser_fast_paths( true );
+
+    BOOST_CHECK_EQUAL( expected, baseline );
+}
+
 BOOST_AUTO_TEST_CASE( equality_test )
 {
     using namespace json;
@@ -608,3 +882,180 @@ BOOST_AUTO_TEST_CASE( parse_false )
     BOOST_CHECK( split_parse( "false" ) );
 }
 
+namespace {
+    const char arena_document[] =
+        "{\"channel\":\"/chat/demo\",\"clientId\":\"1a2kq9x7zv3mbc0d\",\"id\":\"17\","
+        "\"data\":{\"user\":\"Torsten\",\"chat\":\"Hallo \\\"Welt\\\"\",\"count\":[1,2.5,-3e2,true,false,null]}}";
+
+    const char* arena_document_end()
+    {
+        return arena_document + sizeof arena_document - 1;
+    }
+}
+
+/*
+ * parsing into an arena results in the same value as parsing onto the heap
+ */
+BOOST_AUTO_TEST_CASE( parse_into_arena )
+{
+    const json::arena memory;
+    const json::value heap  = json::parse( arena_document, arena_document_end() );
+    const json::value arena = json::parse( arena_document, arena_document_end(), memory );
+
+    BOOST_CHECK_EQUAL( heap, arena );
+    BOOST_CHECK_EQUAL( heap.to_json(), arena.to_json() );
+    BOOST_CHECK( arena.arena_allocated() );
+    BOOST_CHECK( !heap.arena_allocated() );
+
+    // a small document pins only a fraction of a chunk
+    BOOST_CHECK( memory.allocated() > 0 );
+    BOOST_CHECK( memory.capacity() >= memory.allocated() );
+    BOOST_CHECK( memory.capacity() < json::arena::default_chunk_size / 4 );
+}
+
+/*
+ * a parser, constructed with an arena can parse in pieces, like the bayeux connector does
+ */
+BOOST_AUTO_TEST_CASE( parse_into_arena_in_pieces )
+{
+    const json::arena memory( 256 );
+    json::parser      parser( memory );
+
+    for ( const char* p = arena_document; p != arena_document_end(); ++p )
+        parser.parse( p, p + 1 );
+
+    BOOST_CHECK_EQUAL( json::parse( arena_document, arena_document_end() ), parser.result() );
+    BOOST_CHECK( memory.chunks() > 1u );
+}
+
+/*
+ * values keep the arena alive and stay valid after the arena and the parser are gone
+ */
+BOOST_AUTO_TEST_CASE( arena_values_outlive_the_arena )
+{
+    json::value result = json::null();
+
+    {
+        const json::arena memory;
+        json::parser      parser( memory );
+        parser.parse( arena_document, arena_document_end() );
+        result = parser.result();
+    }
+
+    BOOST_CHECK_EQUAL( json::parse( arena_document, arena_document_end() ), result );
+}
+
+BOOST_AUTO_TEST_CASE( promote_arena_values_to_the_heap )
+{
+    const json::arena memory;
+    const json::value arena    = json::parse( arena_document, arena_document_end(), memory );
+    const json::value promoted = arena.promote();
+
+    BOOST_CHECK_EQUAL( arena, promoted );
+    BOOST_CHECK( !promoted.arena_allocated() );
+
+    // an element of an object is promoted, too
+    const json::value data = arena.upcast< json::object >().at( json::string( "data" ) );
+    BOOST_CHECK( data.arena_allocated() );
+    BOOST_CHECK( !data.promote().arena_allocated() );
+    BOOST_CHECK_EQUAL( data, data.promote() );
+
+    // promoting a heap value is a no-op
+    const json::value heap = json::parse( arena_document, arena_document_end() );
+    BOOST_CHECK( !heap.promote().arena_allocated() );
+    BOOST_CHECK_EQUAL( heap, heap.promote() );
+}
+
+BOOST_AUTO_TEST_CASE( large_strings_in_an_arena )
+{
+    const std::string large( 10000, 'x' );
+    const std::string text = "[\"" + large + "\",\"" + large + "\",42]";
+
+    const json::arena memory( 1024 );
+    const json::value result = json::parse( text.data(), text.data() + text.size(), memory );
+
+    BOOST_CHECK_EQUAL( json::parse( text ), result );
+    BOOST_CHECK_EQUAL( text, result.to_json() );
+    BOOST_CHECK( memory.allocated() > 2 * large.size() );
+}
+
+/*
+ * atoms are equal to strings with the same text and can be used as keys, in both directions
+ */
+BOOST_AUTO_TEST_CASE( atoms_are_strings )
+{
+    const json::string channel = json::atom( "channel" );
+
+    BOOST_CHECK_EQUAL( json::string( "channel" ), channel );
+    BOOST_CHECK_EQUAL( json::atom( "channel" ), channel );
+    BOOST_CHECK_NE( json::atom( "clientId" ), channel );
+    BOOST_CHECK_EQUAL( "\"channel\"", channel.to_json() );
+    BOOST_CHECK_EQUAL( "a \"quoted\" atom", json::atom( "a \"quoted\" atom" ).to_std_string() );
+
+    json::object obj;
+    obj.add( json::string( "channel" ), json::number( 1 ) );
+    obj.add( json::atom( "id" ), json::number( 2 ) );
+
+    BOOST_REQUIRE( obj.find( channel ) != 0 );
+    BOOST_CHECK_EQUAL( json::number( 1 ), *obj.find( channel ) );
+    BOOST_CHECK_EQUAL( json::number( 2 ), obj.at( json::string( "id" ) ) );
+    BOOST_CHECK( obj.find( json::atom( "data" ) ) == 0 );
+    BOOST_CHECK_EQUAL( json::parse( "{\"channel\":1,\"id\":2}" ), obj );
+
+    // parsed keys, that are equal to an atom, are found by the atom and by an ordinary string
+    const json::object parsed = json::parse( arena_document, arena_document_end() ).upcast< json::object >();
+    BOOST_CHECK_EQUAL( json::string( "/chat/demo" ), parsed.at( channel ) );
+    BOOST_CHECK_EQUAL( json::string( "/chat/demo" ), parsed.at( json::string( "channel" ) ) );
+    BOOST_CHECK( parsed.find( json::atom( "clientid" ) ) == 0 );
+}
+
+/*
+ * keys, that are atoms, are not allocated from the arena
+ */
+BOOST_AUTO_TEST_CASE( parsed_atoms_are_shared )
+{
+    const json::string key = json::atom( "shared_key" );
+
+    const json::arena atom_memory;
+    const json::value atom_keys = json::parse_single_quoted( "{'shared_key':1}" );
+    const std::string atom_text = "{\"shared_key\":1}";
+    json::parse( atom_text.data(), atom_text.data() + atom_text.size(), atom_memory );
+
+    const json::arena other_memory;
+    const std::string other_text = "{\"unique_key\":1}";
+    json::parse( other_text.data(), other_text.data() + other_text.size(), other_memory );
+
+    BOOST_CHECK( atom_memory.allocated() < other_memory.allocated() );
+    BOOST_CHECK_EQUAL( json::number( 1 ), atom_keys.upcast< json::object >().at( key ) );
+
+    // keys, that are split over two calls to parse() are not shared, but equal
+    const json::arena   split_memory;
+    json::parser        parser( split_memory );
+    parser.parse( atom_text.data(), atom_text.data() + 5 );
+    parser.parse( atom_text.data() + 5, atom_text.data() + atom_text.size() );
+    parser.flush();
+
+    BOOST_CHECK_EQUAL( split_memory.allocated(), other_memory.allocated() );
+    BOOST_CHECK_EQUAL( json::number( 1 ), parser.result().upcast< json::object >().at( key ) );
+}
+
+/*
+ * once the table of atoms is full, atom() returns ordinary strings
+ */
+BOOST_AUTO_TEST_CASE( more_atoms_than_the_table_can_hold )
+{
+    json::object obj;
+
+    for ( int i = 0; i != 1000; ++i )
+    {
+        const json::string atom = json::atom( ( "atom-" + tools::as_string( i ) ).c_str() );
+        BOOST_REQUIRE_EQUAL( json::string( ( "atom-" + tools::as_string( i ) ).c_str() ), atom );
+
+        obj.add( atom, json::number( i ) );
+    }
+
+    for ( int i = 0; i != 1000; ++i )
+        BOOST_REQUIRE_EQUAL( json::number( i ), obj.at( json::atom( ( "atom-" + tools::as_string( i ) ).c_str() ) ) );
+
+    BOOST_CHECK_EQUAL( json::atom( "channel" ), json::string( "channel" ) );
+}
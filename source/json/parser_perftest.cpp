@@ -0,0 +1,338 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+/*
+ * micro benchmark for the json parser
+ *
+ * Parses three corpora: bayeux requests, like browsers post them to the bayeux connector, the documents of pubsub
+ * nodes (lists of short records) and the same documents, indented like a pretty printer would do. Every corpus is
+ * parsed from a std::string onto the heap, into an arena and, like the bayeux connector reads request bodies,
+ * in pieces of 256 bytes. The members of the objects in the parsed documents are looked up, like the bayeux
+ * connector probes messages for "channel", "clientId", "id" and "data", once with ordinary strings and once with
+ * atoms. The names of the bayeux protocol fields are atoms, like in the bayeux connector. For every step, the time
+ * per document, the throughput and the number of memory allocations per document are reported.
+ *
+ * Finally, the throughput of the string and white space scanners is reported for every available implementation.
+ *
+ * With "baseline" as second argument, the corpora are parsed with the scalar scanners and without the fast paths of
+ * the parser, that construct strings and numbers directly from the input. This approximates the parser before the
+ * SIMD scanners and the fast paths were introduced and is what the default run is compared with.
+ *
+ * usage: parser_perftest [iterations] [baseline]
+ */
+
+#include "json/json.h"
+#include "json/scanner.h"
+#include "tools/asstring.h"
+#include "tools/benchmark/measure.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef std::vector< std::string > corpus_t;
+
+    std::string client_id( unsigned client )
+    {
+        return "\"clientId\":\"" + tools::as_string( 192837465 + client * 7919 ) + "x7k2mq\"";
+    }
+
+    // handshakes, connects, subscribes and batches of publishes with chat messages
+    corpus_t bayeux_corpus()
+    {
+        corpus_t result;
+
+        for ( unsigned client = 0; client != 50; ++client )
+        {
+            result.push_back(
+                "[{\"channel\":\"/meta/handshake\",\"version\":\"1.0\",\"minimumVersion\":\"1.0\","
+                "\"supportedConnectionTypes\":[\"long-polling\",\"callback-polling\"],"
+                "\"advice\":{\"timeout\":60000,\"interval\":0},\"id\":\"1\"}]" );
+
+            result.push_back(
+                "[{\"channel\":\"/meta/connect\"," + client_id( client ) + ","
+                "\"connectionType\":\"long-polling\",\"id\":\"2\"},"
+                "{\"channel\":\"/meta/subscribe\"," + client_id( client ) + ","
+                "\"subscription\":\"/chat/room-" + tools::as_string( client % 5 ) + "\",\"id\":\"3\"}]" );
+
+            std::string publish = "[";
+
+            for ( unsigned message = 0; message != client % 4 + 1; ++message )
+            {
+                if ( message != 0 )
+                    publish += ",";
+
+                publish +=
+                    "{\"channel\":\"/chat/room-" + tools::as_string( client % 5 ) + "\"," + client_id( client ) + ","
+                    "\"id\":\"" + tools::as_string( 4 + message ) + "\","
+                    "\"data\":{\"user\":\"user-" + tools::as_string( client ) + "\","
+                    "\"chat\":\"Hallo, this is message number " + tools::as_string( message ) +
+                    " with some \\\"quoted\\\" text and an umlaut: \\u00e4\",\"time\":" +
+                    tools::as_string( 1350000000 + client * 13 + message ) + "}}";
+            }
+
+            result.push_back( publish + "]" );
+
+            result.push_back(
+                "[{\"channel\":\"/meta/connect\"," + client_id( client ) + ","
+                "\"connectionType\":\"long-polling\",\"id\":\"" + tools::as_string( 10 + client ) + "\","
+                "\"advice\":{\"timeout\":0}}]" );
+        }
+
+        return result;
+    }
+
+    // the same records as in node_memory_perftest
+    std::string record( unsigned node, unsigned index, const std::string& indent )
+    {
+        const std::string separator = indent.empty() ? "" : "\n" + indent + "    ";
+        const std::string colon     = indent.empty() ? ":" : " : ";
+
+        return "{" + separator +
+            "\"id\"" + colon + tools::as_string( node * 10000 + index ) + "," + separator +
+            "\"name\"" + colon + "\"user-" + tools::as_string( index ) + "\"," + separator +
+            "\"state\"" + colon + "\"" + ( index % 3 == 0 ? "away" : "online" ) + "\"," + separator +
+            "\"score\"" + colon + tools::as_string( index * 7 % 100 ) + "," + separator +
+            "\"room\"" + colon + "\"lobby\"," + separator +
+            "\"tags\"" + colon + "[\"de\",\"" + ( index % 2 == 0 ? "admin" : "guest" ) + "\"]" +
+            ( indent.empty() ? "" : "\n" + indent ) + "}";
+    }
+
+    corpus_t node_corpus( bool indented )
+    {
+        const std::string indent = indented ? "        " : "";
+        corpus_t          result;
+
+        for ( unsigned node = 0; node != 20; ++node )
+        {
+            std::string document = "[";
+
+            for ( unsigned index = 0; index != 50; ++index )
+            {
+                if ( index != 0 )
+                    document += ",";
+
+                if ( indented )
+                    document += "\n" + indent;
+
+                document += record( node, index, indent );
+            }
+
+            result.push_back( document + ( indented ? "\n]" : "]" ) );
+        }
+
+        return result;
+    }
+
+    std::size_t corpus_bytes( const corpus_t& corpus )
+    {
+        std::size_t result = 0;
+
+        for ( corpus_t::const_iterator document = corpus.begin(); document != corpus.end(); ++document )
+            result += document->size();
+
+        return result;
+    }
+
+    // the steps to measure; each step returns a value depending on its result, to keep the optimizer honest
+
+    struct string_step
+    {
+        std::size_t operator()( const std::string& document ) const
+        {
+            return json::parse( document ).size();
+        }
+    };
+
+    struct arena_step
+    {
+        std::size_t operator()( const std::string& document ) const
+        {
+            const json::arena memory;
+
+            return json::parse( document.data(), document.data() + document.size(), memory ).size();
+        }
+    };
+
+    struct pieces_step
+    {
+        std::size_t operator()( const std::string& document ) const
+        {
+            static const std::size_t piece_size = 256;
+
+            const json::arena   memory;
+            json::parser        parser( memory );
+            const char*         begin = document.data();
+            const char* const   end   = begin + document.size();
+
+            for ( ; begin != end; )
+            {
+                const char* const piece_end = begin + std::min< std::size_t >( piece_size, end - begin );
+                parser.parse( begin, piece_end );
+                begin = piece_end;
+            }
+
+            parser.flush();
+
+            return parser.result().size();
+        }
+    };
+
+    const char* const bayeux_fields[] = {
+        "channel", "clientId", "id", "data", "version", "minimumVersion", "supportedConnectionTypes", "advice",
+        "timeout", "interval", "connectionType", "subscription", "ext", "error", "successful" };
+
+    // looks up bayeux and node data fields in every object of a parsed document
+    struct find_step
+    {
+        find_step( const corpus_t& corpus, bool atoms )
+            : parsed_()
+            , names_()
+        {
+            for ( corpus_t::const_iterator document = corpus.begin(); document != corpus.end(); ++document )
+                parsed_[ *document ] = json::parse( *document ).upcast< json::array >();
+
+            const char* const names[] = { "channel", "clientId", "id", "data", "name", "state", "advice", "tags" };
+
+            for ( const char* const* name = names; name != names + sizeof names / sizeof names[ 0 ]; ++name )
+                names_.push_back( atoms ? json::atom( *name ) : json::string( *name ) );
+        }
+
+        std::size_t operator()( const std::string& document ) const
+        {
+            const json::array&  elements = parsed_.find( document )->second;
+            std::size_t         result   = 0;
+
+            for ( std::size_t e = 0; e != elements.length(); ++e )
+            {
+                const json::object& element = static_cast< const json::object& >( elements.at( e ) );
+
+                for ( std::vector< json::string >::const_iterator name = names_.begin(); name != names_.end(); ++name )
+                    result += element.find( *name ) != 0;
+            }
+
+            return result;
+        }
+
+        std::map< std::string, json::array >    parsed_;
+        std::vector< json::string >             names_;
+    };
+
+    // calls the step with the document at the given index
+    template < class Step >
+    struct for_document
+    {
+        for_document( const corpus_t& corpus, const Step& step ) : corpus_( corpus ), step_( step ) {}
+
+        std::size_t operator()( std::size_t index ) const
+        {
+            return step_( corpus_[ index ] );
+        }
+
+        const corpus_t& corpus_;
+        const Step      step_;
+    };
+
+    template < class Step >
+    void measure( const char* name, const corpus_t& corpus, unsigned iterations, const Step& step )
+    {
+        std::cout << "  " << std::left << std::setw( 8 ) << name << std::right;
+        tools::benchmark::print( std::cout,
+            tools::benchmark::measure( name, corpus, iterations, for_document< Step >( corpus, step ) ), "document" );
+    }
+
+    void measure_corpus( const char* name, const corpus_t& corpus, unsigned iterations )
+    {
+        std::cout << name << ": " << corpus.size() << " documents, " << corpus_bytes( corpus ) << " bytes\n";
+
+        measure( "string", corpus, iterations, string_step() );
+        measure( "arena", corpus, iterations, arena_step() );
+        measure( "pieces", corpus, iterations, pieces_step() );
+        measure( "find", corpus, iterations, find_step( corpus, false ) );
+        measure( "atoms", corpus, iterations, find_step( corpus, true ) );
+    }
+
+    typedef const char* ( *scanner_t )( const char*, const char*, tools::simd_isa );
+
+    // scans a buffer with a single match at the very end
+    void measure_scanner( const char* name, scanner_t scanner, char fill, char match, unsigned iterations )
+    {
+        std::vector< char > buffer( 4096, fill );
+        buffer.back() = match;
+
+        const char* const begin = &buffer[ 0 ];
+        const char* const end   = begin + buffer.size();
+
+        for ( int i = tools::scalar_isa; i <= tools::available_simd_isa(); ++i )
+        {
+            const tools::simd_isa isa   = static_cast< tools::simd_isa >( i );
+            std::size_t           check = 0;
+            const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+            for ( unsigned n = 0; n != iterations; ++n )
+                check += scanner( begin + n % 2, end, isa ) - begin;
+
+            const double seconds =
+                ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() / 1e6;
+
+            if ( check == 0 )
+                throw std::runtime_error( std::string( name ) + ": no results" );
+
+            std::cout << "  " << std::left << std::setw( 22 ) << name << std::setw( 8 ) << tools::simd_isa_name( isa )
+                      << std::right << std::setw( 10 )
+                      << buffer.size() * static_cast< double >( iterations ) / seconds / ( 1024 * 1024 * 1024 )
+                      << " GB/s\n";
+        }
+    }
+}
+
+int main( int argc, const char* argv[] )
+{
+    try
+    {
+        const unsigned iterations = argc > 1 ? std::atoi( argv[ 1 ] ) : 200;
+
+        const bool     baseline   = argc > 2 && std::strcmp( argv[ 2 ], "baseline" ) == 0;
+
+        if ( iterations == 0 )
+            throw std::runtime_error( "iterations must be greater than 0" );
+
+        if ( baseline )
+        {
+            json::select_scanner( tools::scalar_isa );
+            json::select_parser_fast_paths( false );
+        }
+
+        for ( const char* const* field = bayeux_fields;
+            field != bayeux_fields + sizeof bayeux_fields / sizeof bayeux_fields[ 0 ]; ++field )
+        {
+            json::atom( *field );
+        }
+
+        std::cout << iterations << " iterations" << ( baseline ? ", baseline" : "" ) << "\n";
+        std::cout << std::fixed << std::setprecision( 1 );
+
+        measure_corpus( "bayeux", bayeux_corpus(), iterations );
+        measure_corpus( "node data", node_corpus( false ), iterations );
+        measure_corpus( "node data, indented", node_corpus( true ), iterations );
+
+        std::cout << "scanners:\n" << std::setprecision( 2 );
+        measure_scanner( "find_string_delimiter", &json::find_string_delimiter, 'a', '\"', iterations * 500 );
+        measure_scanner( "skip_white_space", &json::skip_white_space, ' ', '{', iterations * 500 );
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
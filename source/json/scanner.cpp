@@ -0,0 +1,162 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "json/scanner.h"
+namespace json
+{
+    namespace {
+        bool is_white_space( char c )
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        const char* find_string_delimiter_scalar( const char* begin, const char* end )
+        {
+            for ( ; begin != end && *begin != '\"' && *begin != '\\'; ++begin )
+                ;
+
+            return begin;
+        }
+
+        const char* skip_white_space_scalar( const char* begin, const char* end )
+        {
+            for ( ; begin != end && is_white_space( *begin ); ++begin )
+                ;
+
+            return begin;
+        }
+
+#   ifdef SIOUX_SSE2
+        const char* find_string_delimiter_sse2( const char* begin, const char* end )
+        {
+            const __m128i quote   = _mm_set1_epi8( '\"' );
+            const __m128i solidus = _mm_set1_epi8( '\\' );
+
+            for ( ; end - begin >= 16; begin += 16 )
+            {
+                const __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( begin ) );
+                const int     found = _mm_movemask_epi8(
+                    _mm_or_si128( _mm_cmpeq_epi8( chunk, quote ), _mm_cmpeq_epi8( chunk, solidus ) ) );
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return find_string_delimiter_scalar( begin, end );
+        }
+
+        const char* skip_white_space_sse2( const char* begin, const char* end )
+        {
+            const __m128i space = _mm_set1_epi8( ' ' );
+            const __m128i tab   = _mm_set1_epi8( '\t' );
+            const __m128i lf    = _mm_set1_epi8( '\n' );
+            const __m128i cr    = _mm_set1_epi8( '\r' );
+
+            for ( ; end - begin >= 16; begin += 16 )
+            {
+                const __m128i chunk = _mm_loadu_si128( reinterpret_cast< const __m128i* >( begin ) );
+                const __m128i white = _mm_or_si128(
+                    _mm_or_si128( _mm_cmpeq_epi8( chunk, space ), _mm_cmpeq_epi8( chunk, tab ) ),
+                    _mm_or_si128( _mm_cmpeq_epi8( chunk, lf ), _mm_cmpeq_epi8( chunk, cr ) ) );
+                const int     found = ~_mm_movemask_epi8( white ) & 0xffff;
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return skip_white_space_scalar( begin, end );
+        }
+#   endif
+
+#   ifdef SIOUX_AVX2
+        SIOUX_AVX2_FUNCTION
+        const char* find_string_delimiter_avx2( const char* begin, const char* end )
+        {
+            const __m256i quote   = _mm256_set1_epi8( '\"' );
+            const __m256i solidus = _mm256_set1_epi8( '\\' );
+
+            for ( ; end - begin >= 32; begin += 32 )
+            {
+                const __m256i  chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( begin ) );
+                const unsigned found = _mm256_movemask_epi8(
+                    _mm256_or_si256( _mm256_cmpeq_epi8( chunk, quote ), _mm256_cmpeq_epi8( chunk, solidus ) ) );
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return find_string_delimiter_sse2( begin, end );
+        }
+
+        SIOUX_AVX2_FUNCTION
+        const char* skip_white_space_avx2( const char* begin, const char* end )
+        {
+            const __m256i space = _mm256_set1_epi8( ' ' );
+            const __m256i tab   = _mm256_set1_epi8( '\t' );
+            const __m256i lf    = _mm256_set1_epi8( '\n' );
+            const __m256i cr    = _mm256_set1_epi8( '\r' );
+
+            for ( ; end - begin >= 32; begin += 32 )
+            {
+                const __m256i  chunk = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( begin ) );
+                const __m256i  white = _mm256_or_si256(
+                    _mm256_or_si256( _mm256_cmpeq_epi8( chunk, space ), _mm256_cmpeq_epi8( chunk, tab ) ),
+                    _mm256_or_si256( _mm256_cmpeq_epi8( chunk, lf ), _mm256_cmpeq_epi8( chunk, cr ) ) );
+                const unsigned found = ~static_cast< unsigned >( _mm256_movemask_epi8( white ) );
+
+                if ( found )
+                    return begin + __builtin_ctz( found );
+            }
+
+            return skip_white_space_sse2( begin, end );
+        }
+#   endif
+
+        tools::scanner_dispatch& string_scanner()
+        {
+            static tools::scanner_dispatch dispatch(
+                &find_string_delimiter_scalar,
+                SIOUX_IF_SSE2( &find_string_delimiter_sse2 ),
+                SIOUX_IF_AVX2( &find_string_delimiter_avx2 ) );
+
+            return dispatch;
+        }
+
+        tools::scanner_dispatch& white_space_scanner()
+        {
+            static tools::scanner_dispatch dispatch(
+                &skip_white_space_scalar,
+                SIOUX_IF_SSE2( &skip_white_space_sse2 ),
+                SIOUX_IF_AVX2( &skip_white_space_avx2 ) );
+
+            return dispatch;
+        }
+    }
+
+    const char* find_string_delimiter( const char* begin, const char* end )
+    {
+        return string_scanner()( begin, end );
+    }
+
+    const char* find_string_delimiter( const char* begin, const char* end, tools::simd_isa isa )
+    {
+        return string_scanner().get( isa )( begin, end );
+    }
+
+    const char* skip_white_space( const char* begin, const char* end )
+    {
+        return white_space_scanner()( begin, end );
+    }
+
+    const char* skip_white_space( const char* begin, const char* end, tools::simd_isa isa )
+    {
+        return white_space_scanner().get( isa )( begin, end );
+    }
+
+    void select_scanner( tools::simd_isa isa )
+    {
+        string_scanner().select( isa );
+        white_space_scanner().select( isa );
+    }
+}
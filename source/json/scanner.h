@@ -0,0 +1,49 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_JSON_SCANNER_H
+#define SIOUX_SOURCE_JSON_SCANNER_H
+
+#include "tools/simd.h"
+
+namespace json
+{
+    /**
+     * @brief returns a pointer to the first double quote or reverse solidus in [begin, end) or end, if there is none
+     *
+     * Used to skip over the characters of a json string, that need no further inspection. The implementation is
+     * chosen at runtime, the first time the function is called, or by select_scanner().
+     */
+    const char* find_string_delimiter( const char* begin, const char* end );
+
+    /**
+     * @brief find_string_delimiter() with an explicitly chosen implementation
+     * @pre isa <= tools::available_simd_isa()
+     */
+    const char* find_string_delimiter( const char* begin, const char* end, tools::simd_isa isa );
+
+    /**
+     * @brief returns a pointer to the first character in [begin, end), that is not a json white space, or end
+     *
+     * The implementation is chosen at runtime, the first time the function is called, or by select_scanner().
+     */
+    const char* skip_white_space( const char* begin, const char* end );
+
+    /**
+     * @brief skip_white_space() with an explicitly chosen implementation
+     * @pre isa <= tools::available_simd_isa()
+     */
+    const char* skip_white_space( const char* begin, const char* end, tools::simd_isa isa );
+
+    /**
+     * @brief chooses the implementations, that find_string_delimiter( begin, end ) and skip_white_space( begin, end )
+     *        use from now on
+     *
+     * Intended for benchmarks, that compare the parser with the different implementations. Not thread safe.
+     * @pre isa <= tools::available_simd_isa()
+     */
+    void select_scanner( tools::simd_isa isa );
+}
+
+#endif // include guard
@@ -0,0 +1,128 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "json/scanner.h"
+#include <cstring>
+#include <string>
+
+/**
+ * @test all available implementations of find_string_delimiter() find the first quote or reverse solidus for all
+ *       positions, lengths and alignments
+ */
+BOOST_AUTO_TEST_CASE( all_string_scanners_find_the_first_delimiter )
+{
+    const std::size_t max_size = 100;
+    char buffer[ max_size + 32 ];
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+    {
+        const tools::simd_isa scanner = static_cast< tools::simd_isa >( isa );
+
+        for ( std::size_t offset = 0; offset != 32; ++offset )
+        {
+            char* const begin = buffer + offset;
+
+            for ( std::size_t size = 0; size <= max_size; ++size )
+            {
+                std::memset( buffer, 'a', sizeof buffer );
+
+                // no delimiter at all, but behind the end
+                begin[ size ] = '\"';
+                BOOST_REQUIRE( json::find_string_delimiter( begin, begin + size, scanner ) == begin + size );
+
+                for ( std::size_t pos = 0; pos < size; ++pos )
+                {
+                    begin[ pos ] = '\"';
+                    BOOST_REQUIRE( json::find_string_delimiter( begin, begin + size, scanner ) == begin + pos );
+
+                    begin[ pos ] = '\\';
+                    BOOST_REQUIRE( json::find_string_delimiter( begin, begin + size, scanner ) == begin + pos );
+
+                    begin[ pos ] = 'a';
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @test all available implementations of skip_white_space() find the first character, that is not a white space, for
+ *       all positions, lengths and alignments
+ */
+BOOST_AUTO_TEST_CASE( all_white_space_scanners_find_the_first_non_white_space )
+{
+    const std::size_t max_size = 100;
+    const char        white[]  = " \t\n\r";
+    char buffer[ max_size + 32 ];
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+    {
+        const tools::simd_isa scanner = static_cast< tools::simd_isa >( isa );
+
+        for ( std::size_t offset = 0; offset != 32; ++offset )
+        {
+            char* const begin = buffer + offset;
+
+            for ( std::size_t size = 0; size <= max_size; ++size )
+            {
+                for ( std::size_t i = 0; i != sizeof buffer; ++i )
+                    buffer[ i ] = white[ i % 4 ];
+
+                // white space only, but a token behind the end
+                begin[ size ] = '{';
+                BOOST_REQUIRE( json::skip_white_space( begin, begin + size, scanner ) == begin + size );
+
+                for ( std::size_t pos = 0; pos < size; ++pos )
+                {
+                    const char saved = begin[ pos ];
+
+                    begin[ pos ] = '\"';
+                    BOOST_REQUIRE( json::skip_white_space( begin, begin + size, scanner ) == begin + pos );
+
+                    // characters, that differ from a white space by a single bit
+                    begin[ pos ] = '\0';
+                    BOOST_REQUIRE( json::skip_white_space( begin, begin + size, scanner ) == begin + pos );
+
+                    begin[ pos ] = saved;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @test the scanners without explicit implementation
+ */
+BOOST_AUTO_TEST_CASE( scanners_with_the_available_implementation )
+{
+    const std::string text = "  \r\n\t{\"name\":\"a \\\"quoted\\\" value\"}";
+    const char* const begin = text.data();
+    const char* const end   = begin + text.size();
+
+    BOOST_CHECK( json::skip_white_space( begin, end ) == begin + 5 );
+    BOOST_CHECK( json::skip_white_space( begin + 5, end ) == begin + 5 );
+    BOOST_CHECK( json::find_string_delimiter( begin + 7, end ) == begin + 11 );
+    BOOST_CHECK( json::find_string_delimiter( begin + 14, end ) == begin + 16 );
+    BOOST_CHECK( json::find_string_delimiter( end, end ) == end );
+}
+
+/**
+ * @test the scanners without explicit implementation use the selected implementation
+ */
+BOOST_AUTO_TEST_CASE( scanners_with_selected_implementation )
+{
+    const std::string text = "  {\"name\":\"value\"}";
+    const char* const begin = text.data();
+    const char* const end   = begin + text.size();
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+    {
+        json::select_scanner( static_cast< tools::simd_isa >( isa ) );
+        BOOST_CHECK( json::skip_white_space( begin, end ) == begin + 2 );
+        BOOST_CHECK( json::find_string_delimiter( begin + 4, end ) == begin + 8 );
+    }
+
+    json::select_scanner( tools::available_simd_isa() );
+}
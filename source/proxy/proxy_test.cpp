@@ -80,6 +80,13 @@ static std::string simulate_proxy(
     return std::string(bin.begin(), bin.end());
 }
 
+static std::string simulate_proxy(
+    const boost::shared_ptr< proxy::test::connector >&      proxy,
+    const std::string&                                      request)
+{
+    return simulate_proxy(proxy, tools::substring(request.data(), request.data() + request.size()));
+}
+
 static std::string through_proxy(const boost::shared_ptr<const http::request_header>& r, const std::string& orgin_response)
 {
     boost::asio::io_service queue;
@@ -10,6 +10,7 @@
 #include "server/transfer_buffer.h"
 #include "server/timeout.h"
 #include "server/error_code.h"
+#include "http/filter.h"
 #include "http/request.h"
 #include "http/response.h"
 #include <boost/enable_shared_from_this.hpp>
@@ -107,8 +108,9 @@ namespace proxy
 
         void forward_header();
 
+        // writes the header without the hop-by-hop headers to outbuffers_
         template <class Header>
-        std::vector<tools::substring> filtered_header(const Header& header);
+        void filter_header(const Header& header);
 
         boost::shared_ptr<Connection>                   connection_;
         boost::shared_ptr<const http::request_header>   request_;
@@ -159,7 +161,7 @@ namespace proxy
             boost::bind(&response::handle_orgin_connect, this->shared_from_this(), _1, _2));
 
         // while waiting for the response, the request to the orgin server can be assembled
-        outbuffers_ = filtered_header(*request_);
+        filter_header(*request_);
     }
 
     template <class Connection, std::size_t BodyBufferSize>
@@ -419,7 +421,7 @@ namespace proxy
     void response<Connection, BodyBufferSize>::forward_header()
     {
         // filter all connection headers
-        outbuffers_ = filtered_header(response_header_from_proxy_);
+        filter_header(response_header_from_proxy_);
         writing_body_to_client_ = true;
 
         connection_->async_write(
@@ -434,18 +436,15 @@ namespace proxy
 
     template <class Connection, std::size_t BodyBufferSize>
     template <class Header>
-    std::vector<tools::substring> response<Connection, BodyBufferSize>::filtered_header(const Header& header)
+    void response<Connection, BodyBufferSize>::filter_header(const Header& header)
     {
-        http::filter                    unused_headers(connection_headers_to_be_removed_);
+        // the headers named in the Connection header are removed too
+        const http::header* const connection_header = header.find_header(http::connection_header);
 
-        const http::header* const connection_header = header.find_header("connection");
-        
-        if ( connection_header != 0 )
-        {
-            unused_headers += http::filter(connection_header->value());
-        }
-
-        return header.filtered_request_text(unused_headers);
+        header.filtered_request_text(
+            connection_headers_to_be_removed_,
+            connection_header != 0 ? connection_header->value() : tools::substring(),
+            outbuffers_);
     }
 
     template <class Connection, std::size_t BodyBufferSize>
@@ -0,0 +1,116 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+/*
+ * memory benchmark for the data of pubsub nodes
+ *
+ * Creates a number of nodes, with a typical, large document as data: a list of records, with short member names,
+ * ids, small integers and short strings. The number of allocations and the number of bytes that are in use by
+ * the nodes are reported per node and per json value. The memory used by the allocators book keeping is not part
+ * of the result.
+ *
+ * usage: node_memory_perftest [nodes [records-per-node]]
+ */
+
+#include "pubsub/node.h"
+#include "json/json.h"
+#include "tools/asstring.h"
+#include "tools/benchmark/allocation_counter.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // a record, like a chat room would publish it for every user
+    std::string record( unsigned node, unsigned index )
+    {
+        return "{"
+            "\"id\":" + tools::as_string( node * 10000 + index ) + ","
+            "\"name\":\"user-" + tools::as_string( index ) + "\","
+            "\"state\":\"" + ( index % 3 == 0 ? "away" : "online" ) + "\","
+            "\"score\":" + tools::as_string( index * 7 % 100 ) + ","
+            "\"room\":\"lobby\","
+            "\"tags\":[\"de\",\"" + ( index % 2 == 0 ? "admin" : "guest" ) + "\"]"
+            "}";
+    }
+
+    std::string document( unsigned node, unsigned records )
+    {
+        std::string result = "[";
+
+        for ( unsigned index = 0; index != records; ++index )
+        {
+            if ( index != 0 )
+                result += ",";
+
+            result += record( node, index );
+        }
+
+        return result + "]";
+    }
+
+    // number of json values in a document: 1 array + records * ( object + 6 names + 6 values + 2 tags )
+    std::size_t values_per_document( unsigned records )
+    {
+        return 1 + records * 15;
+    }
+
+    void report( unsigned nodes, std::size_t values, unsigned long allocated, std::size_t bytes )
+    {
+        std::cout << std::setw( 10 ) << static_cast< double >( allocated ) / nodes << " allocations/node"
+                  << std::setw( 12 ) << static_cast< double >( bytes ) / nodes << " bytes/node"
+                  << std::setw( 8 ) << static_cast< double >( bytes ) / values << " bytes/value"
+                  << std::setw( 8 ) << static_cast< double >( allocated ) / values << " allocations/value\n";
+    }
+}
+
+int main( int argc, const char* argv[] )
+{
+    try
+    {
+        const unsigned nodes   = argc > 1 ? std::atoi( argv[ 1 ] ) : 1000;
+        const unsigned records = argc > 2 ? std::atoi( argv[ 2 ] ) : 50;
+
+        if ( nodes == 0 || records == 0 )
+            throw std::runtime_error( "nodes and records must be greater than 0" );
+
+        std::vector< std::string > documents;
+
+        for ( unsigned node = 0; node != nodes; ++node )
+            documents.push_back( document( node, records ) );
+
+        std::vector< pubsub::node > result;
+        result.reserve( nodes );
+
+        std::cout << nodes << " nodes, " << records << " records/node, " << values_per_document( records )
+                  << " values/node\n";
+        std::cout << std::fixed << std::setprecision( 1 );
+
+        const boost::posix_time::ptime  start              = boost::posix_time::microsec_clock::universal_time();
+        const unsigned long             allocations_before = tools::benchmark::allocations();
+        const std::size_t               bytes_before       = tools::benchmark::bytes_in_use();
+
+        for ( unsigned node = 0; node != nodes; ++node )
+            result.push_back( pubsub::node( pubsub::node_version(), json::parse( documents[ node ] ) ) );
+
+        const boost::posix_time::ptime  end = boost::posix_time::microsec_clock::universal_time();
+
+        report( nodes, nodes * values_per_document( records ), tools::benchmark::allocations() - allocations_before,
+            tools::benchmark::bytes_in_use() - bytes_before );
+
+        std::cout << "parsing and storing: "
+                  << ( end - start ).total_milliseconds() << " ms\n";
+    }
+    catch ( const std::exception& e )
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
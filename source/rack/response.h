@@ -51,7 +51,6 @@ namespace rack
 
         void body_read_handler(
             const boost::system::error_code& error,
-            const char* buffer,
             std::size_t bytes_read_and_decoded );
 
         void response_write_handler( const boost::system::error_code& error, std::size_t bytes_transferred );
@@ -11,7 +11,7 @@
 #include "server/error_code.h"
 #include "server/response.h"
 #include "server/timeout.h"
-#include "tools/mem_tools.h"
+#include "server/timer_wheel.h"
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/placeholders.hpp>
@@ -22,9 +22,11 @@
 #include <boost/shared_ptr.hpp>
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <deque>
-#include <map>
 #include <memory>
+#include <new>
+#include <vector>
 
 /** @namespace server */
 namespace server 
@@ -116,11 +118,39 @@ namespace server
   	  	 * 		std::size_t bytes_read_and_decoded      // Number of bytes received.
   	  	 * 		);
   	  	 *
+  	  	 * Content-Length and chunked encoded bodies are supported. If the body can not be decoded or exceeds the
+  	  	 * traits max_body_size(), the handler is called with an error.
+  	  	 *
   	  	 * @pre last received header signaled, that a body is expected
          */
         template< typename ReadHandler >
         void async_read_body( ReadHandler handler );
 
+        /**
+         * @brief Starts reading asynchronously the whole body of a request into the given buffers.
+         *
+         * The body is read directly into the passed buffers, as far as possible. The handler is called once, when
+         * the whole body was read and decoded, or when an error occurred. If the body does not fit into the buffers,
+         * the handler is called with limit_reached. The buffers must stay valid until the handler is called.
+         * The handler must have following signature:
+         * void handler(
+         *      const boost::system::error_code& error, // Result of operation.
+         *      std::size_t bytes_read_and_decoded      // Size of the body.
+         *      );
+         *
+         * @pre last received header signaled, that a body is expected
+         */
+        template< typename MutableBufferSequence, typename ReadHandler >
+        void async_read_body( const MutableBufferSequence& buffers, ReadHandler handler );
+
+        /**
+         * @brief Starts reading asynchronously the whole body of a request and appends it to the given body.
+         *
+         * Same as above, but the body is grown as needed. The body is read directly into the vector.
+         */
+        template< typename ReadHandler >
+        void async_read_body( std::vector< char >& body, ReadHandler handler );
+
         /**
          * @brief to be called by an async_response to signal, that no more writes will be done
          *
@@ -161,49 +191,163 @@ namespace server
         socket_t& socket();
 
         Trait& trait();
+
+        /**
+         * @brief the number of bytes, occupied by this connection and the buffers owned by the connection
+         *
+         * While a connection waits for the first bytes of the next request, it doesn't own a request header
+         * buffer or a body buffer.
+         */
+        std::size_t memory_usage() const;
 	private:
         // not implemented
         connection( const connection& );
         connection& operator=( const connection& );
 
-        class blocked_write_base 
+        /*
+         * a write of a response, that is not in front of the pipeline. Blocked writes are linked into an intrusive
+         * queue and are constructed in storage, that is recycled by the connection.
+         */
+        class blocked_write_base
         {
         public:
+            blocked_write_base(async_response& sender, std::size_t storage_size);
+
             virtual ~blocked_write_base() {}
 
-            virtual void operator()(Connection&) = 0;
+            // appends the buffers to be written to the given list and returns the number of bytes
+            virtual std::size_t gather(std::vector<boost::asio::const_buffer>& buffers) const = 0;
+
+            virtual void complete(const boost::system::error_code& error, std::size_t bytes_transferred) = 0;
 
-            virtual void cancel() = 0;
+            void cancel();
+
+            blocked_write_base*     next_;
+            async_response* const   sender_;
+            const std::size_t       storage_size_;
+            std::size_t             size_;
         };
 
+        // writes of async_write() and async_write_some() are treated the same, as writing all bytes is a valid
+        // result of an async_write_some()
         template <class ConstBufferSequence, class WriteHandler>
         class blocked_write : public blocked_write_base
         {
         public:
             blocked_write(const ConstBufferSequence&  buffers,
-                          WriteHandler                handler);
+                          WriteHandler                handler,
+                          async_response&             sender);
         private:
-            void operator()(Connection&);
-            void cancel();
+            std::size_t gather(std::vector<boost::asio::const_buffer>& buffers) const;
+            void complete(const boost::system::error_code& error, std::size_t bytes_transferred);
 
             const ConstBufferSequence   buffers_;
-            const WriteHandler          handler_;
+            WriteHandler                handler_;
         };
 
-        template <class ConstBufferSequence, class WriteHandler>
-        class blocked_write_some : public blocked_write_base
+        /*
+         * a read of a whole request body into buffers of the response. Constructed in the same, recycled storage as
+         * the blocked writes.
+         */
+        class body_read_base
+        {
+        public:
+            explicit body_read_base(std::size_t storage_size);
+
+            virtual ~body_read_base() {}
+
+            // returns free space for the next, at most size bytes of the body. The returned buffer is empty, if
+            // the body does not fit into the buffers of the response
+            virtual boost::asio::mutable_buffer prepare(std::size_t size) = 0;
+
+            // the first size bytes of the last prepared buffer are filled
+            virtual void commit(std::size_t size) = 0;
+
+            virtual void complete(const boost::system::error_code& error) = 0;
+
+            const std::size_t       storage_size_;
+        };
+
+        template <class MutableBufferSequence, class ReadHandler>
+        class buffers_body_read : public body_read_base
         {
         public:
-            blocked_write_some(const ConstBufferSequence&  buffers,
-                          WriteHandler                handler);
+            buffers_body_read(const MutableBufferSequence& buffers, ReadHandler handler);
         private:
-            void operator()(Connection&);
-            void cancel();
+            boost::asio::mutable_buffer prepare(std::size_t size);
+            void commit(std::size_t size);
+            void complete(const boost::system::error_code& error);
+
+            const MutableBufferSequence                             buffers_;
+            typename MutableBufferSequence::const_iterator          current_;
+            std::size_t                                             offset_;
+            std::size_t                                             size_;
+            ReadHandler                                             handler_;
+        };
 
-            const ConstBufferSequence   buffers_;
-            const WriteHandler          handler_;
+        template <class ReadHandler>
+        class vector_body_read : public body_read_base
+        {
+        public:
+            vector_body_read(std::vector<char>& body, ReadHandler handler);
+        private:
+            boost::asio::mutable_buffer prepare(std::size_t size);
+            void commit(std::size_t size);
+            void complete(const boost::system::error_code& error);
+
+            std::vector<char>&      body_;
+            const std::size_t       start_size_;
+            std::size_t             size_;
+            ReadHandler             handler_;
+        };
+
+        // refers to gathered_buffers_, so that passing the gathered buffers to async_write() does not copy them
+        class gathered_buffers
+        {
+        public:
+            typedef boost::asio::const_buffer                               value_type;
+            typedef std::vector<boost::asio::const_buffer>::const_iterator  const_iterator;
+
+            explicit gathered_buffers(const std::vector<boost::asio::const_buffer>& buffers);
+
+            const_iterator begin() const;
+            const_iterator end() const;
+        private:
+            const std::vector<boost::asio::const_buffer>* buffers_;
         };
 
+        // releases a list of blocked writes when going out of scope
+        class blocked_write_list_guard
+        {
+        public:
+            blocked_write_list_guard(connection& con, blocked_write_base* writes);
+            ~blocked_write_list_guard();
+
+            void dismiss();
+        private:
+            blocked_write_list_guard(const blocked_write_list_guard&);
+            blocked_write_list_guard& operator=(const blocked_write_list_guard&);
+
+            connection&             connection_;
+            blocked_write_base*     writes_;
+        };
+
+        template <class ConstBufferSequence, class WriteHandler>
+        void block_write(const ConstBufferSequence& buffers, WriteHandler handler, async_response& sender);
+
+        // removes all blocked writes of the sender from the queue of blocked writes, keeping there order
+        blocked_write_base* take_blocked_writes(async_response& sender);
+
+        // writes all blocked writes of the sender, that is now in front of the pipeline, with a single gather write
+        void write_blocked_writes(async_response& sender);
+        void blocked_writes_written(const boost::system::error_code& error, std::size_t bytes_transferred);
+
+        void* allocate_storage(std::size_t size);
+        void release_storage(void* storage, std::size_t storage_size);
+        void release_blocked_writes(blocked_write_base* writes);
+
+        // true, if not a single byte of the next request header was read
+        bool idle() const;
         boost::posix_time::time_duration read_timeout_value() const;
         void issue_read(const boost::posix_time::time_duration& time_out);
 		void handle_read(const boost::system::error_code& e, std::size_t bytes_transferred);
@@ -215,15 +359,24 @@ namespace server
          */
         bool handle_request_header(const boost::shared_ptr<const http::request_header>& new_request);
 
-        template <class Handler>
-        void unblock_pending_writes(async_response& sender, const Handler&);
-
         void response_not_possible_impl(async_response& sender, const boost::shared_ptr<async_response>& error_response);
 
         // hurries all responses, that are in front of the given sender
         void hurry_writers(async_response& sender);
 
+        void start_body_read(body_read_base* read);
+        bool reading_body() const;
+        // free space in the response buffers or in the body_buffer_ for the next read of the body
+        boost::asio::mutable_buffer prepare_body_read();
+        // feeds the body decoder and passes the decoded body to the body read. Returns the number of bytes consumed
+        std::size_t decode_body(const char* data, std::size_t size);
         void deliver_body();
+        void copy_body();
+        void body_read_completed();
+        void body_read_failed(const boost::system::error_code& error);
+        void complete_body_read(const boost::system::error_code& error);
+        // reports an error of the body decoder to the body read handler
+        void body_decoding_failed();
 
         Connection                              connection_;
         Trait&                                  trait_;
@@ -233,15 +386,30 @@ namespace server
         typedef std::deque<async_response*>     response_list;
         response_list                           responses_;
 
-        typedef std::map<async_response*, std::vector<blocked_write_base*> >  blocked_write_list;
-        blocked_write_list                      blocked_writes_;
+        // blocked writes of all responses in the order of there issue
+        blocked_write_base*                     blocked_writes_;
+        blocked_write_base**                    blocked_writes_tail_;
+        // blocked writes that are currently written
+        blocked_write_base*                     writing_blocked_writes_;
+        std::vector<boost::asio::const_buffer>  gathered_buffers_;
+
+        // released storage of blocked writes and body reads, reused for the next blocked write or body read
+        static const std::size_t                blocked_write_storage_size = 256;
+
+        struct free_storage
+        {
+            free_storage*   next_;
+        };
+
+        free_storage*                           free_blocked_write_storage_;
 
         bool                                    current_response_is_sending_;
         bool                                    shutdown_read_;
         bool                                    no_read_timeout_set_;
 
-        boost::asio::deadline_timer             read_timer_;
-        boost::asio::deadline_timer             write_timer_;
+        // read, write and keep alive timeouts are armed for every IO, so a coarse timer_wheel is used
+        wheel_timer                             read_timer_;
+        wheel_timer                             write_timer_;
 
         typedef boost::function< void ( const boost::system::error_code&, const char*, std::size_t ) >
         	body_read_cb_t;
@@ -249,7 +417,19 @@ namespace server
         http::body_decoder						body_decoder_;
         // if not empty(), currently, a body is read
         body_read_cb_t							body_read_call_back_;
+        // if not 0, currently, a body is read into buffers of the response
+        body_read_base*                         body_read_;
         std::vector< char >						body_buffer_;
+        // the buffer, that was passed to the last read of a body
+        boost::asio::mutable_buffer             body_read_buffer_;
+
+        // the read size of a body with unknown length is doubled, every time a read fills the whole buffer
+        static const std::size_t                initial_body_read_size = 4 * 1024;
+        static const std::size_t                max_body_read_size     = 64 * 1024;
+        std::size_t                             body_read_size_;
+
+        // while idle, the first bytes of the next request are read into this buffer
+        char                                    idle_buffer_[ 256 ];
  	};
 
     /**
@@ -267,13 +447,22 @@ namespace server
         : connection_(arg)
         , trait_(trait)
         , current_request_()
+        , blocked_writes_(0)
+        , blocked_writes_tail_(&blocked_writes_)
+        , writing_blocked_writes_(0)
+        , gathered_buffers_()
+        , free_blocked_write_storage_(0)
         , current_response_is_sending_(false)
         , shutdown_read_(false)
         , no_read_timeout_set_( false )
         , read_timer_(connection_.get_io_service())
         , write_timer_(connection_.get_io_service())
-        , body_decoder_()
+        , body_decoder_(trait.max_body_size())
         , body_read_call_back_()
+        , body_read_(0)
+        , body_buffer_()
+        , body_read_buffer_()
+        , body_read_size_(initial_body_read_size)
     {
         trait_.event_connection_created(*this);
     }
@@ -281,9 +470,19 @@ namespace server
     template < class Trait, class Connection, class Timer >
 	connection< Trait, Connection, Timer >::~connection()
     {
-        assert( blocked_writes_.empty() );
-        assert( body_read_call_back_.empty() );
+        assert( !blocked_writes_ );
+        assert( !reading_body() );
         assert( responses_.empty() );
+
+        // the handler of a gather write, that was not executed
+        release_blocked_writes( writing_blocked_writes_ );
+
+        while ( free_blocked_write_storage_ )
+        {
+            free_storage* const storage = free_blocked_write_storage_;
+            free_blocked_write_storage_ = storage->next_;
+            ::operator delete( storage );
+        }
     
         connection_.close();
         trait_.event_connection_destroyed( *this );
@@ -292,7 +491,6 @@ namespace server
     template < class Trait, class Connection, class Timer >
     void connection< Trait, Connection, Timer >::start()
     {
-        current_request_.reset( new http::request_header );
         issue_read( trait_.timeout() );
     }
 
@@ -308,6 +506,52 @@ namespace server
         }
     }
 
+    template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::reading_body() const
+    {
+        return !body_read_call_back_.empty() || body_read_;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    boost::asio::mutable_buffer connection< Trait, Connection, Timer >::prepare_body_read()
+    {
+        const std::size_t remaining = body_decoder_.remaining_length();
+
+        // the body lands directly in the buffers of the response, without reading past the end of a body with
+        // known length
+        if ( body_read_ )
+        {
+            const boost::asio::mutable_buffer free = body_read_->prepare( remaining != 0 ? remaining : body_read_size_ );
+
+            if ( boost::asio::buffer_size( free ) != 0 )
+                return body_read_buffer_ = free;
+        }
+
+        // the response buffers are full, but there might be chunk framing left
+        body_buffer_.resize( remaining != 0 ? std::min( remaining, body_read_size_ ) : body_read_size_ );
+
+        return body_read_buffer_ = boost::asio::buffer( body_buffer_ );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    std::size_t connection< Trait, Connection, Timer >::decode_body( const char* data, std::size_t size )
+    {
+        std::size_t consumed = 0;
+
+        // a chunked body is consumed in several steps
+        while ( consumed != size && reading_body() && !body_decoder_.done() && body_decoder_.error() == http::http_ok )
+        {
+            consumed += body_decoder_.feed_buffer( data + consumed, size - consumed );
+
+            if ( body_read_ )
+                copy_body();
+            else
+                deliver_body();
+        }
+
+        return consumed;
+    }
+
     template < class Trait, class Connection, class Timer >
     void connection< Trait, Connection, Timer >::deliver_body()
     {
@@ -319,6 +563,93 @@ namespace server
     	}
     }
 
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::copy_body()
+    {
+        assert( body_read_ );
+        for ( std::pair< std::size_t, const char* > current = body_decoder_.decode(); current.first;
+                current = body_decoder_.decode() )
+        {
+            while ( current.first )
+            {
+                const boost::asio::mutable_buffer free = body_read_->prepare( current.first );
+                const std::size_t                 size = boost::asio::buffer_size( free );
+                char* const                       dest = boost::asio::buffer_cast< char* >( free );
+
+                if ( size == 0 )
+                {
+                    body_read_failed( make_error_code( limit_reached ) );
+                    return;
+                }
+
+                // when read directly into the response buffers, the decoded body is already in place, or, when
+                // chunk framing was removed, source and destination overlap
+                if ( dest != current.second )
+                    std::memmove( dest, current.second, size );
+
+                body_read_->commit( size );
+                current.first  -= size;
+                current.second += size;
+            }
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::body_read_completed()
+    {
+        if ( body_read_ )
+        {
+            complete_body_read( boost::system::error_code() );
+        }
+        else
+        {
+            body_read_cb_t read_call_back;
+            body_read_call_back_.swap( read_call_back );
+
+            read_call_back( boost::system::error_code(), 0, 0 );
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::body_read_failed( const boost::system::error_code& error )
+    {
+        if ( body_read_ )
+        {
+            complete_body_read( error );
+        }
+        else if ( !body_read_call_back_.empty() )
+        {
+            body_read_cb_t read_call_back;
+            body_read_call_back_.swap( read_call_back );
+
+            read_call_back( error, 0, 0 );
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::complete_body_read( const boost::system::error_code& error )
+    {
+        body_read_base* const read = body_read_;
+        body_read_ = 0;
+
+        const std::size_t storage_size = read->storage_size_;
+
+        try
+        {
+            read->complete( error );
+        }
+        catch ( ... )
+        {
+            read->~body_read_base();
+            release_storage( read, storage_size );
+
+            throw;
+        }
+
+        read->~body_read_base();
+        release_storage( read, storage_size );
+    }
+
     template < class Trait, class Connection, class Timer >
     template<typename ConstBufferSequence, typename WriteHandler>
     void connection< Trait, Connection, Timer >::async_write(
@@ -346,8 +677,7 @@ namespace server
             hurry_writers(sender);
 
             // store send request until the current sender is ready
-            typename blocked_write_list::mapped_type& writes = blocked_writes_[&sender];
-            tools::save_push_back(new blocked_write<ConstBufferSequence, WriteHandler>(buffers, handler), writes);
+            block_write(buffers, handler, sender);
         }
     }
 
@@ -378,8 +708,7 @@ namespace server
             hurry_writers(sender);
 
             // store send request until the current sender is ready
-            typename blocked_write_list::mapped_type& writes = blocked_writes_[&sender];
-            tools::save_push_back(new blocked_write_some<ConstBufferSequence, WriteHandler>(buffers, handler), writes);
+            block_write(buffers, handler, sender);
         }
     }
 
@@ -388,10 +717,85 @@ namespace server
     void connection< Trait, Connection, Timer >::async_read_body( ReadHandler handler )
     {
 		assert( current_request_->body_expected() );
-		assert( body_read_call_back_.empty() );
+		assert( !reading_body() );
 
 		body_read_call_back_ = handler;
-		body_decoder_.start( *current_request_ );
+		start_body_read( 0 );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template< typename MutableBufferSequence, typename ReadHandler >
+    void connection< Trait, Connection, Timer >::async_read_body(
+        const MutableBufferSequence& buffers, ReadHandler handler )
+    {
+        typedef buffers_body_read< MutableBufferSequence, ReadHandler > read_t;
+
+        void* const storage = allocate_storage( sizeof( read_t ) );
+        read_t*     read    = 0;
+
+        try
+        {
+            read = new ( storage ) read_t( buffers, handler );
+        }
+        catch ( ... )
+        {
+            release_storage( storage, sizeof( read_t ) );
+            throw;
+        }
+
+        start_body_read( read );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    template< typename ReadHandler >
+    void connection< Trait, Connection, Timer >::async_read_body( std::vector< char >& body, ReadHandler handler )
+    {
+        typedef vector_body_read< ReadHandler > read_t;
+
+        void* const storage = allocate_storage( sizeof( read_t ) );
+        read_t*     read    = 0;
+
+        try
+        {
+            read = new ( storage ) read_t( body, handler );
+        }
+        catch ( ... )
+        {
+            release_storage( storage, sizeof( read_t ) );
+            throw;
+        }
+
+        start_body_read( read );
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::start_body_read( body_read_base* read )
+    {
+        assert( current_request_->body_expected() );
+        assert( !body_read_ );
+
+        body_read_      = read;
+        body_read_size_ = initial_body_read_size;
+
+		if ( body_decoder_.start( *current_request_ ) != http::http_ok )
+		{
+		    connection_.get_io_service().post(
+		        boost::bind( &connection::body_decoding_failed,
+		                     boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ) ) );
+		}
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::body_decoding_failed()
+    {
+        // already reported
+        if ( !reading_body() || body_decoder_.error() == http::http_ok )
+            return;
+
+        body_read_failed(
+            make_error_code( body_decoder_.error() == http::http_request_entity_too_large
+                ? limit_reached
+                : canceled_by_error ) );
     }
 
     template < class Trait, class Connection, class Timer >
@@ -400,7 +804,7 @@ namespace server
         trait_.event_response_completed(*this, sender);
 
         // there is no reason, why there should be outstanding, blocked writes from the current sender
-        assert(blocked_writes_.erase(&sender) == 0);
+        assert(!take_blocked_writes(sender));
         
         response_list::iterator senders_pos = std::find(responses_.begin(), responses_.end(), &sender);
 
@@ -410,22 +814,7 @@ namespace server
             responses_.pop_front();
 
             if ( !responses_.empty() )
-            {
-                const typename blocked_write_list::iterator pending_writes = blocked_writes_.find(responses_.front());
-
-                if ( pending_writes != blocked_writes_.end() )
-                {
-                    // first remove all pending writes from the list
-                    typename blocked_write_list::mapped_type                             list;
-                    tools::ptr_container_guard<typename blocked_write_list::mapped_type> delete_blocked_writes(list);
-
-                    list.swap(pending_writes->second);
-                    blocked_writes_.erase(pending_writes);
-
-                    std::for_each(list.begin(), list.end(),
-                        boost::bind(&blocked_write_base::operator(), _1, boost::ref(connection_)));
-                }
-            }
+                write_blocked_writes(*responses_.front());
         }
         else if ( senders_pos != responses_.end() )
         {
@@ -454,13 +843,11 @@ namespace server
             body_read_call_back_.clear();
         }
 
-        const typename blocked_write_list::const_iterator writes = blocked_writes_.find(&sender);
-
-        if ( writes != blocked_writes_.end() )
+        if ( blocked_write_base* const writes = take_blocked_writes(sender) )
         {
-            tools::ptr_container_guard<typename blocked_write_list::mapped_type> guard(writes->second);
-            std::for_each(writes->second.begin(), writes->second.end(), 
-                boost::bind(&blocked_write_base::cancel, _1));
+            blocked_write_list_guard guard(*this, writes);
+            for ( blocked_write_base* write = writes; write; write = write->next_ )
+                write->cancel();
         }
  
         if ( error_response.get() )
@@ -531,15 +918,35 @@ namespace server
         return trait_;
     }
 
+    template < class Trait, class Connection, class Timer >
+    std::size_t connection< Trait, Connection, Timer >::memory_usage() const
+    {
+        std::size_t result = sizeof( *this )
+            + body_buffer_.capacity()
+            + gathered_buffers_.capacity() * sizeof( boost::asio::const_buffer );
+
+        if ( current_request_ )
+            result += sizeof( http::request_header ) + current_request_->allocated_size();
+
+        return result;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    bool connection< Trait, Connection, Timer >::idle() const
+    {
+        return !reading_body()
+            && ( !current_request_ || ( current_request_->empty() && current_request_->unparsed_buffer().second == 0 ) );
+    }
+
     template < class Trait, class Connection, class Timer >
     boost::posix_time::time_duration connection< Trait, Connection, Timer >::read_timeout_value() const
     {
         boost::posix_time::time_duration result;
 
-        if ( !current_request_->empty() || !body_read_call_back_.empty() )
+        if ( !idle() )
             result = trait_.timeout();
 
-        else if  ( responses_.empty() && current_request_->empty() && body_read_call_back_.empty() )
+        else if  ( responses_.empty() )
             result = trait_.keep_alive_timeout();
 
         return result;
@@ -550,15 +957,24 @@ namespace server
     {
 		std::pair< char*, std::size_t > buffer( 0, 0 );
 
-		if ( body_read_call_back_.empty() )
+		if ( idle() )
+		{
+		    // give the buffers back, until the next request arrives
+		    current_request_.reset();
+		    std::vector< char >().swap( body_buffer_ );
+
+		    buffer = std::make_pair( &idle_buffer_[0], sizeof idle_buffer_ );
+		}
+		else if ( !reading_body() )
 		{
 			buffer = current_request_->read_buffer();
 			assert( buffer.first && buffer.second );
 		}
 		else
 		{
-			body_buffer_.resize( 1024u );
-			buffer = std::make_pair( &body_buffer_[0], body_buffer_.size() );
+		    const boost::asio::mutable_buffer body_buffer = prepare_body_read();
+			buffer = std::make_pair(
+			    boost::asio::buffer_cast< char* >( body_buffer ), boost::asio::buffer_size( body_buffer ) );
 		}
 
 		if ( time_out != boost::posix_time::seconds( 0 ) )
@@ -600,42 +1016,61 @@ namespace server
 
 		if ( error || bytes_transferred == 0 )
 		{
-        	if ( !body_read_call_back_.empty() )
-        	{
-        		const boost::system::error_code published_error = error ? error : make_error_code( canceled_by_error );
-        		body_read_call_back_( published_error, 0, 0 );
-        		body_read_call_back_.clear();
-        	}
+		    body_read_failed( error ? error : make_error_code( canceled_by_error ) );
 			return;
 		}
 
-        while ( bytes_transferred != 0 )
+		// the first bytes of a new request where read into the idle buffer
+		if ( !current_request_ )
+		{
+		    assert( !reading_body() );
+		    current_request_.reset( new http::request_header(
+		        boost::asio::const_buffers_1( &idle_buffer_[0], bytes_transferred ), bytes_transferred ) );
+		}
+
+        // the not yet decoded part of the read body
+        const char* body_data = 0;
+
+        if ( reading_body() )
+        {
+            body_data = boost::asio::buffer_cast< const char* >( body_read_buffer_ );
+
+            if ( bytes_transferred == boost::asio::buffer_size( body_read_buffer_ ) && body_read_size_ < max_body_read_size )
+                body_read_size_ *= 2;
+        }
+
+        while ( bytes_transferred != 0 || ( reading_body() && body_decoder_.done() ) )
         {
         	// reading a body
-        	if ( !body_read_call_back_.empty() )
+        	if ( reading_body() )
         	{
-        		assert( !body_decoder_.done() );
+        		if ( body_decoder_.error() != http::http_ok )
+        		{
+        		    body_decoding_failed();
+        		    return;
+        		}
+
+        		const std::size_t decoded_size = decode_body( body_data, bytes_transferred );
+        		body_data         += decoded_size;
+        		bytes_transferred -= decoded_size;
 
-        		const std::size_t decoded_size = body_decoder_.feed_buffer( &body_buffer_[0], bytes_transferred );
+        		// the body did not fit into the buffers of the response
+        		if ( !reading_body() )
+        		    return;
 
-        		if ( decoded_size )
+        		if ( body_decoder_.error() != http::http_ok )
         		{
-        			bytes_transferred -= decoded_size;
-        			deliver_body();
+        		    body_decoding_failed();
+        		    return;
         		}
 
         		if ( body_decoder_.done() )
         		{
-        			body_buffer_.erase( body_buffer_.begin(), body_buffer_.begin() + decoded_size );
         			// this consumes and decreases bytes_transferred
 					current_request_.reset( new http::request_header(
-							boost::asio::const_buffers_1( &body_buffer_[0], bytes_transferred ), bytes_transferred ) );
+							boost::asio::const_buffers_1( body_data, bytes_transferred ), bytes_transferred ) );
 
-					body_read_cb_t read_call_back;
-                    body_read_call_back_.swap( read_call_back );
-
-                    if ( !read_call_back.empty() )
-                        read_call_back( error, 0, 0 );
+					body_read_completed();
         		}
         	}
         	// or reading a header
@@ -654,18 +1089,18 @@ namespace server
                 }
 
                 // handle_request_header() can switch to body decoding mode
-                if ( body_read_call_back_.empty() )
+                if ( !reading_body() )
                 {
 					// this consumes and decreases bytes_transferred
 					current_request_.reset( new http::request_header( *current_request_, bytes_transferred,
-							http::request_header::copy_trailing_buffer ) );
+							http::request_header::share_trailing_buffer ) );
                 }
                 else
                 {
                 	const std::pair<char*, std::size_t> unparsed_read = current_request_->unparsed_buffer();
                 	bytes_transferred = unparsed_read.second;
-                	body_buffer_.resize( bytes_transferred );
-                	std::copy( unparsed_read.first, unparsed_read.first + unparsed_read.second, body_buffer_.begin() );
+                	body_buffer_.assign( unparsed_read.first, unparsed_read.first + unparsed_read.second );
+                	body_data = body_buffer_.empty() ? 0 : &body_buffer_[0];
                 }
             }
         	else
@@ -722,56 +1157,375 @@ namespace server
         return true;
     }
 
+    template < class Trait, class Connection, class Timer >
+    template < class ConstBufferSequence, class WriteHandler >
+    void connection< Trait, Connection, Timer >::block_write(
+        const ConstBufferSequence&  buffers,
+        WriteHandler                handler,
+        async_response&             sender)
+    {
+        typedef blocked_write<ConstBufferSequence, WriteHandler> write_t;
+
+        void* const storage = allocate_storage(sizeof(write_t));
+        blocked_write_base* write = 0;
+
+        try
+        {
+            write = new (storage) write_t(buffers, handler, sender);
+        }
+        catch (...)
+        {
+            release_storage(storage, sizeof(write_t));
+            throw;
+        }
+
+        *blocked_writes_tail_ = write;
+        blocked_writes_tail_  = &write->next_;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    typename connection< Trait, Connection, Timer >::blocked_write_base*
+        connection< Trait, Connection, Timer >::take_blocked_writes(async_response& sender)
+    {
+        blocked_write_base*     result = 0;
+        blocked_write_base**    result_tail = &result;
+        blocked_write_base**    write = &blocked_writes_;
+
+        while ( *write )
+        {
+            if ( (*write)->sender_ == &sender )
+            {
+                blocked_write_base* const taken = *write;
+                *write = taken->next_;
+
+                taken->next_ = 0;
+                *result_tail = taken;
+                result_tail  = &taken->next_;
+            }
+            else
+            {
+                write = &(*write)->next_;
+            }
+        }
+
+        // write now points to the link, that terminates the queue
+        blocked_writes_tail_ = write;
+
+        return result;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::write_blocked_writes(async_response& sender)
+    {
+        blocked_write_base* const writes = take_blocked_writes(sender);
+
+        if ( !writes )
+            return;
+
+        blocked_write_list_guard guard(*this, writes);
+
+        // a response completes after its last write was completed
+        assert( !writing_blocked_writes_ );
+
+        gathered_buffers_.clear();
+
+        for ( blocked_write_base* write = writes; write; write = write->next_ )
+            write->size_ = write->gather(gathered_buffers_);
+
+        try
+        {
+            server::async_write_with_to(
+                connection_,
+                gathered_buffers(gathered_buffers_),
+                boost::bind( &connection::blocked_writes_written,
+                             boost::static_pointer_cast< connection< Trait, Connection > >( this->shared_from_this() ),
+                             boost::asio::placeholders::error,
+                             boost::asio::placeholders::bytes_transferred ),
+                write_timer_,
+                trait_.timeout() );
+        }
+        catch (...)
+        {
+            // the handlers of the writes will not be called, so the sender will not be able to complete
+            assert( responses_.front() == &sender );
+            responses_.pop_front();
+            shutdown_close();
+
+            throw;
+        }
+
+        guard.dismiss();
+        writing_blocked_writes_      = writes;
+        current_response_is_sending_ = true;
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::blocked_writes_written(
+        const boost::system::error_code&    error,
+        std::size_t                         bytes_transferred)
+    {
+        blocked_write_base* const writes = writing_blocked_writes_;
+        writing_blocked_writes_ = 0;
+
+        blocked_write_list_guard guard(*this, writes);
+
+        // distribute the transferred bytes over the gathered writes
+        for ( blocked_write_base* write = writes; write; write = write->next_ )
+        {
+            const std::size_t written = std::min(write->size_, bytes_transferred);
+            bytes_transferred -= written;
+
+            write->complete(error, written);
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void* connection< Trait, Connection, Timer >::allocate_storage(std::size_t size)
+    {
+        if ( size > blocked_write_storage_size )
+            return ::operator new(size);
+
+        if ( free_blocked_write_storage_ )
+        {
+            free_storage* const result = free_blocked_write_storage_;
+            free_blocked_write_storage_ = result->next_;
+
+            return result;
+        }
+
+        return ::operator new(blocked_write_storage_size);
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::release_storage(void* storage, std::size_t storage_size)
+    {
+        if ( storage_size <= blocked_write_storage_size )
+        {
+            free_storage* const free = static_cast<free_storage*>(storage);
+            free->next_ = free_blocked_write_storage_;
+            free_blocked_write_storage_ = free;
+        }
+        else
+        {
+            ::operator delete(storage);
+        }
+    }
+
+    template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::release_blocked_writes(blocked_write_base* writes)
+    {
+        while ( writes )
+        {
+            blocked_write_base* const write        = writes;
+            const std::size_t         storage_size = write->storage_size_;
+            writes = write->next_;
+
+            write->~blocked_write_base();
+            release_storage(write, storage_size);
+        }
+    }
+
+    ////////////////////////////
+    // class blocked_write_base
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::blocked_write_base::blocked_write_base(
+        async_response& sender, std::size_t storage_size)
+        : next_(0)
+        , sender_(&sender)
+        , storage_size_(storage_size)
+        , size_(0)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::blocked_write_base::cancel()
+    {
+        complete(make_error_code(canceled_by_error), 0);
+    }
+
     ///////////////////////
     // class blocked_write
 	template < class Trait, class Connection, class Timer >
     template < class ConstBufferSequence, class WriteHandler >
     connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::blocked_write(
         const ConstBufferSequence&  buffers,
-        WriteHandler                handler)
-        : buffers_(buffers)
+        WriteHandler                handler,
+        async_response&             sender)
+        : blocked_write_base(sender, sizeof(blocked_write))
+        , buffers_(buffers)
         , handler_(handler)
     {
     }
 
 	template < class Trait, class Connection, class Timer >
     template < class ConstBufferSequence, class WriteHandler >
-    void connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::operator()(Connection& con)
+    std::size_t connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::gather(
+        std::vector<boost::asio::const_buffer>& buffers) const
     {
-        boost::asio::async_write(con, buffers_, handler_);
+        std::size_t size = 0;
+
+        for ( typename ConstBufferSequence::const_iterator b = buffers_.begin(); b != buffers_.end(); ++b )
+        {
+            const boost::asio::const_buffer buffer(*b);
+
+            buffers.push_back(buffer);
+            size += boost::asio::buffer_size(buffer);
+        }
+
+        return size;
     }
 
 	template < class Trait, class Connection, class Timer >
     template < class ConstBufferSequence, class WriteHandler >
-    void connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::cancel()
+    void connection< Trait, Connection, Timer >::blocked_write<ConstBufferSequence, WriteHandler>::complete(
+        const boost::system::error_code& error, std::size_t bytes_transferred)
+    {
+        handler_(error, bytes_transferred);
+    }
+
+    /////////////////////////
+    // class body_read_base
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::body_read_base::body_read_base(std::size_t storage_size)
+        : storage_size_(storage_size)
     {
-        handler_(make_error_code(canceled_by_error), 0);
     }
 
     ////////////////////////////
-    // class blocked_write_some
+    // class buffers_body_read
 	template < class Trait, class Connection, class Timer >
-    template < class ConstBufferSequence, class WriteHandler >
-    connection< Trait, Connection, Timer >::blocked_write_some<ConstBufferSequence, WriteHandler>::blocked_write_some(
-        const ConstBufferSequence&  buffers,
-        WriteHandler                handler)
-        : buffers_(buffers)
+    template < class MutableBufferSequence, class ReadHandler >
+    connection< Trait, Connection, Timer >::buffers_body_read<MutableBufferSequence, ReadHandler>::buffers_body_read(
+        const MutableBufferSequence& buffers, ReadHandler handler)
+        : body_read_base(sizeof(buffers_body_read))
+        , buffers_(buffers)
+        , current_()
+        , offset_(0)
+        , size_(0)
         , handler_(handler)
     {
+        current_ = buffers_.begin();
     }
 
 	template < class Trait, class Connection, class Timer >
-    template < class ConstBufferSequence, class WriteHandler >
-    void connection< Trait, Connection, Timer >::blocked_write_some<ConstBufferSequence, WriteHandler>::operator()(Connection& con)
+    template < class MutableBufferSequence, class ReadHandler >
+    boost::asio::mutable_buffer
+        connection< Trait, Connection, Timer >::buffers_body_read<MutableBufferSequence, ReadHandler>::prepare(
+            std::size_t size)
     {
-        con.async_write_some(buffers_, handler_);
+        for ( ; current_ != buffers_.end(); ++current_, offset_ = 0 )
+        {
+            const boost::asio::mutable_buffer buffer(*current_);
+
+            if ( offset_ != boost::asio::buffer_size(buffer) )
+                return boost::asio::buffer(buffer + offset_, size);
+        }
+
+        return boost::asio::mutable_buffer();
     }
 
 	template < class Trait, class Connection, class Timer >
-    template < class ConstBufferSequence, class WriteHandler >
-    void connection< Trait, Connection, Timer >::blocked_write_some<ConstBufferSequence, WriteHandler>::cancel()
+    template < class MutableBufferSequence, class ReadHandler >
+    void connection< Trait, Connection, Timer >::buffers_body_read<MutableBufferSequence, ReadHandler>::commit(
+        std::size_t size)
+    {
+        offset_ += size;
+        size_   += size;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class MutableBufferSequence, class ReadHandler >
+    void connection< Trait, Connection, Timer >::buffers_body_read<MutableBufferSequence, ReadHandler>::complete(
+        const boost::system::error_code& error)
+    {
+        handler_(error, size_);
+    }
+
+    ///////////////////////////
+    // class vector_body_read
+	template < class Trait, class Connection, class Timer >
+    template < class ReadHandler >
+    connection< Trait, Connection, Timer >::vector_body_read<ReadHandler>::vector_body_read(
+        std::vector<char>& body, ReadHandler handler)
+        : body_read_base(sizeof(vector_body_read))
+        , body_(body)
+        , start_size_(body.size())
+        , size_(body.size())
+        , handler_(handler)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ReadHandler >
+    boost::asio::mutable_buffer connection< Trait, Connection, Timer >::vector_body_read<ReadHandler>::prepare(
+        std::size_t size)
+    {
+        // the vector grows with the body, the size of the vector is adjusted, when the body is complete
+        if ( body_.size() - size_ < size )
+            body_.resize(size_ + size);
+
+        return boost::asio::buffer(&body_[size_], size);
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ReadHandler >
+    void connection< Trait, Connection, Timer >::vector_body_read<ReadHandler>::commit(std::size_t size)
+    {
+        size_ += size;
+    }
+
+	template < class Trait, class Connection, class Timer >
+    template < class ReadHandler >
+    void connection< Trait, Connection, Timer >::vector_body_read<ReadHandler>::complete(
+        const boost::system::error_code& error)
+    {
+        body_.resize(size_);
+        handler_(error, size_ - start_size_);
+    }
+
+    ///////////////////////////
+    // class gathered_buffers
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::gathered_buffers::gathered_buffers(
+        const std::vector<boost::asio::const_buffer>& buffers)
+        : buffers_(&buffers)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    typename connection< Trait, Connection, Timer >::gathered_buffers::const_iterator
+        connection< Trait, Connection, Timer >::gathered_buffers::begin() const
+    {
+        return buffers_->begin();
+    }
+
+	template < class Trait, class Connection, class Timer >
+    typename connection< Trait, Connection, Timer >::gathered_buffers::const_iterator
+        connection< Trait, Connection, Timer >::gathered_buffers::end() const
+    {
+        return buffers_->end();
+    }
+
+    ////////////////////////////////////
+    // class blocked_write_list_guard
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::blocked_write_list_guard::blocked_write_list_guard(
+        connection& con, blocked_write_base* writes)
+        : connection_(con)
+        , writes_(writes)
+    {
+    }
+
+	template < class Trait, class Connection, class Timer >
+    connection< Trait, Connection, Timer >::blocked_write_list_guard::~blocked_write_list_guard()
+    {
+        connection_.release_blocked_writes(writes_);
+    }
+
+	template < class Trait, class Connection, class Timer >
+    void connection< Trait, Connection, Timer >::blocked_write_list_guard::dismiss()
     {
-        handler_(make_error_code(canceled_by_error), 0);
+        writes_ = 0;
     }
 
     template < class Connection, class Trait >
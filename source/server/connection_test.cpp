@@ -401,3 +401,41 @@ BOOST_AUTO_TEST_CASE( no_timeout_applies_when_client_doesnt_block )
     // no outstanding reference to the connection object, so no read is pending on the connection to the client
     BOOST_CHECK( connection.expired() );
 }
+
+/**
+ * @test a connection, that waits for the next request, gives up its request header and body buffers
+ */
+BOOST_AUTO_TEST_CASE( idle_connection_releases_its_buffers )
+{
+    using server::test::read;
+    using server::test::disconnect_read;
+
+    boost::asio::io_service     queue;
+    read_plan                   reads;
+    reads << read( begin( simple_get_11 ), end( simple_get_11 ) )
+          << delay( boost::posix_time::seconds( 1 ) )
+          << disconnect_read();
+
+    traits<>::connection_type   socket(queue, reads);
+    traits<>                    trait;
+
+    boost::shared_ptr< server::connection< traits<>, traits<>::connection_type > > connection(
+        server::create_connection( socket, trait ) );
+
+    BOOST_CHECK_LT( connection->memory_usage(), 1024u );
+
+    // read and answer the first request
+    while ( trait.requests().empty() )
+        queue.run_one();
+
+    queue.poll();
+
+    BOOST_CHECK_EQUAL( "Hello", socket.output() );
+    BOOST_CHECK_LT( connection->memory_usage(), 1024u );
+    BOOST_CHECK_LT( connection->memory_usage(), 4 * 1024u );
+
+    queue.run();
+
+    trait.reset_responses();
+    connection.reset();
+}
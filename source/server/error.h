@@ -6,8 +6,8 @@
 #define SOURCE_SIOUX_SERVER_ERROR_H
 
 #include "http/http.h"
+#include "http/response_head.h"
 #include "server/response.h"
-#include "tools/asstring.h"
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/bind.hpp>
@@ -20,6 +20,8 @@ namespace server
 
     /**
      * @brief response with the given http code and with an empty body
+     *
+     * The response head is rendered into a pooled buffer, when the response is started.
      */
     template <class Connection>
     class error_response : public async_response, 
@@ -35,7 +37,8 @@ namespace server
             const boost::system::error_code&    error,
             std::size_t                         bytes_transferred);
 
-        std::string                     buffer_;
+        http::response_head             head_;
+        const http::http_error_code     code_;
         boost::shared_ptr<Connection>   connection_;
     };
 
@@ -62,10 +65,8 @@ namespace server
     // implementation
     template < class Connection >
     error_response< Connection >::error_response( const boost::shared_ptr<Connection>& con, http::http_error_code ec )
-        : buffer_( "HTTP/1.1 "
-            + tools::as_string( static_cast< int >( ec ) ) + " "
-            + http::reason_phrase( ec )
-            + "\r\nContent-Length:0\r\n\r\n" )
+        : head_()
+        , code_( ec )
         , connection_( con )
     {
     }
@@ -73,8 +74,10 @@ namespace server
     template < class Connection >
     void error_response< Connection >::start()
     {
+        head_.status( code_ ).date().content_length( 0 ).finish();
+
         connection_->async_write(
-            boost::asio::buffer( buffer_ ),
+            head_.buffer(),
             boost::bind(
                 &error_response::handle_written, 
                 this->shared_from_this(),
@@ -204,7 +204,8 @@ namespace server
         {
             boost::mutex::scoped_lock lock(mutex_);
             log_ << "error_request_parse_error: " << request.state() << std::endl;
-            tools::hex_dump( log_, request.text().begin(), request.text().end() );
+            const std::string text = request.text();
+            tools::hex_dump( log_, text.begin(), text.end() );
             log_ << std::endl;
         }
 
@@ -21,11 +21,22 @@
 #include "server/test_tools.h"
 #include "server/test_timer.h"
 #include "server/traits.h"
+#include "tools/asstring.h"
 #include "tools/io_service.h"
 #include "tools/iterators.h"
 
 namespace
 {
+	/*
+	 * the different overloads of connection::async_read_body()
+	 */
+	enum read_mode
+	{
+	    read_by_call_back,
+	    read_into_vector,
+	    read_into_buffer
+	};
+
 	/*
 	 * response implementation, that just reads the body
 	 */
@@ -33,11 +44,14 @@ namespace
 	class read_body : public server::async_response, public boost::enable_shared_from_this< read_body< Connection > >
 	{
 	public:
-		read_body( const http::request_header& request, const boost::shared_ptr< Connection >& connection )
+		read_body( const http::request_header& request, const boost::shared_ptr< Connection >& connection,
+		    read_mode mode = read_by_call_back, std::size_t buffer_size = 0 )
 			: connection_( connection )
 			, body_read_( false )
 			, has_body_( request.body_expected() )
+			, body_( mode == read_into_buffer ? buffer_size : 0 )
 		    , has_error_( false )
+		    , mode_( mode )
 		{
 		}
 
@@ -97,6 +111,18 @@ namespace
 			}
 		}
 
+		void body_read_into( const boost::system::error_code& error, std::size_t bytes_read_and_decoded )
+		{
+		    assert( !body_read_ );
+
+		    if ( mode_ == read_into_buffer && !error )
+		        body_.resize( bytes_read_and_decoded );
+
+		    has_error_ = static_cast< bool >( error );
+		    body_read_ = !error;
+		    connection_->response_completed( *this );
+		}
+
 		bool body_completed() const
 		{
 			return body_read_;
@@ -122,6 +148,16 @@ namespace
         	{
         		connection_->response_completed( *this );
         	}
+        	else if ( mode_ == read_into_vector )
+        	{
+        		connection_->async_read_body( body_,
+        				boost::bind( &read_body::body_read_into, this->shared_from_this(), _1, _2 ) );
+        	}
+        	else if ( mode_ == read_into_buffer )
+        	{
+        		connection_->async_read_body( boost::asio::buffer( body_ ),
+        				boost::bind( &read_body::body_read_into, this->shared_from_this(), _1, _2 ) );
+        	}
         	else
         	{
         		connection_->async_read_body(
@@ -134,6 +170,7 @@ namespace
         bool							has_body_;
         std::vector< char > 			body_;
         bool							has_error_;
+        const read_mode                 mode_;
 	};
 
 	typedef std::vector< boost::shared_ptr< server::async_response > > response_list_t;
@@ -145,12 +182,16 @@ namespace
 	{
 	    response_factory()
 	    	: error_count_( 0 )
+	    	, mode_( read_by_call_back )
+	    	, buffer_size_( 0 )
 	    {
 	    }
 
 	    template < class T >
 	    explicit response_factory( const T& )
 			: error_count_( 0 )
+	    	, mode_( read_by_call_back )
+	    	, buffer_size_( 0 )
 		{
 		}
 
@@ -161,7 +202,8 @@ namespace
 	    {
 	    	if ( header->state() == http::message::ok )
 	    	{
-				const boost::shared_ptr< read_body< Connection > > new_response(new read_body< Connection >( *header, connection ) );
+				const boost::shared_ptr< read_body< Connection > > new_response(
+				    new read_body< Connection >( *header, connection, mode_, buffer_size_ ) );
 				read_bodies_.push_back( new_response );
 
 				return boost::shared_ptr< server::async_response >( new_response );
@@ -182,6 +224,8 @@ namespace
 
 	    response_list_t		read_bodies_;
 	    int 				error_count_;
+	    read_mode           mode_;
+	    std::size_t         buffer_size_;
 	};
 
 	typedef server::test::socket<const char*>                       socket_t;
@@ -267,28 +311,92 @@ BOOST_AUTO_TEST_CASE( post_with_small_content_length_message_body )
 /**
  * @class server::connection
  * @test chunked encoded message body to be received and decoded
- * @todo implement
  */
 BOOST_AUTO_TEST_CASE( post_with_small_chunked_encoded_message_body )
 {
-/*
     boost::minstd_rand      random;
     const char body[] = "Es war einmal ein Baer der schwamm so weit im Meer.";
 
     const std::vector< char > message = build_randomly_chunked_post_request(
-    		random, tools::begin( body ), tools::end( body ), 7u );
+    		random, tools::begin( body ), tools::end( body ) - 1, 7u );
 
 	trait_t					trait;
 	boost::asio::io_service	queue;
-	socket_t				socket( queue, &message[0], &message[message.size()] );
+	socket_t				socket( queue, &message[0], &message[0] + message.size() );
 
 	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
 	connection->start();
 
 	tools::run( queue );
-	BOOST_CHECK_EQUAL( trait.read_bodies_.size(), 1u );
+	BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), 1u );
 	BOOST_CHECK( get_body( trait.read_bodies_.front() ).equal( body ) );
-	*/
+}
+
+/**
+ * @class server::connection
+ * @test multiple chunked encoded message bodies, read in small pieces, that split the chunk framing
+ */
+BOOST_AUTO_TEST_CASE( post_with_multiple_chunked_encoded_message_bodies_read_in_small_chunks )
+{
+	static const std::size_t	number_of_bodies = 20;
+
+    boost::minstd_rand      random;
+    const char body[] = "Es war einmal ein Baer der schwamm so weit im Meer.";
+
+    std::vector< char > messages;
+	for ( std::size_t i = 0; i != number_of_bodies; ++i )
+	{
+	    const std::vector< char > message = build_randomly_chunked_post_request(
+	    		random, tools::begin( body ), tools::end( body ) - 1, 7u );
+
+	    messages.insert( messages.end(), message.begin(), message.end() );
+	}
+
+	trait_t					trait;
+	boost::asio::io_service	queue;
+	socket_t				socket( queue, &messages[0], &messages[0] + messages.size(), 3u );
+
+	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+	connection->start();
+
+	tools::run( queue );
+	BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), number_of_bodies );
+
+	for ( response_list_t::const_iterator response = trait.read_bodies_.begin();
+			response != trait.read_bodies_.end(); ++response )
+	{
+		BOOST_REQUIRE( get_body( *response ).equal( body ) );
+	}
+}
+
+/**
+ * @class server::connection
+ * @test a transfer coding, that is not supported, must result in an error being passed to the read body handler
+ */
+BOOST_AUTO_TEST_CASE( unsupported_transfer_coding_is_flagged_as_error )
+{
+    const char post_with_gzip_transfer_coding[] =
+        "POST / HTTP/1.1\r\n"
+        "Host: web-sniffer.net\r\n"
+        "Transfer-Encoding: gzip, chunked\r\n"
+        "\r\n"
+        "5\r\n"
+        "12345\r\n"
+        "0\r\n"
+        "\r\n";
+
+	trait_t					trait;
+	boost::asio::io_service	queue;
+	socket_t				socket( queue, tools::begin( post_with_gzip_transfer_coding ),
+								tools::end( post_with_gzip_transfer_coding ) -1 );
+
+	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+	connection->start();
+
+	tools::run( queue );
+	BOOST_REQUIRE_EQUAL( 1u, trait.read_bodies_.size() );
+	BOOST_CHECK( get_body( trait.read_bodies_.front() ).has_error() );
+	BOOST_CHECK_EQUAL( 0, get_body( trait.read_bodies_.front() ).body_size() );
 }
 
 /**
@@ -557,3 +665,110 @@ BOOST_AUTO_TEST_CASE( missing_body_should_be_flagged_as_error )
     BOOST_CHECK( get_body( trait.read_bodies_.front() ).has_error() );
     BOOST_CHECK_EQUAL( 0, get_body( trait.read_bodies_.front() ).body_size() );
 }
+
+/**
+ * @class server::connection
+ * @test pipelined request bodies, read directly into a std::vector of the response
+ */
+BOOST_AUTO_TEST_CASE( read_content_length_encoded_bodies_into_a_vector )
+{
+	static const std::size_t	number_of_bodies = 50;
+
+	for ( std::size_t chunk_size = 0; chunk_size < 20; chunk_size += 7 )
+	{
+        trait_t					trait;
+        trait.mode_ = read_into_vector;
+
+        boost::asio::io_service	queue;
+        socket_t				socket( queue, tools::begin( http::test::simple_post ),
+                                        tools::end( http::test::simple_post ) -1, chunk_size, number_of_bodies );
+
+        boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+        connection->start();
+
+        tools::run( queue );
+        BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), number_of_bodies );
+
+        for ( response_list_t::const_iterator response = trait.read_bodies_.begin();
+                response != trait.read_bodies_.end(); ++response )
+        {
+            BOOST_REQUIRE( get_body( *response ).equal(
+                "url=http%3A%2F%2Fasdasdasd&submit=Submit&http=1.1&gzip=yes&type=GET&uak=0" ) );
+        }
+	}
+}
+
+/**
+ * @class server::connection
+ * @test chunked encoded bodies of random size, read into a std::vector and into a buffer of the response
+ */
+BOOST_AUTO_TEST_CASE( read_chunked_encoded_bodies_into_response_buffers )
+{
+	static const std::size_t	number_of_bodies = 20;
+	static const std::size_t	max_body_size    = 20 * 1024;
+
+	const read_mode modes[] = { read_into_vector, read_into_buffer };
+
+	for ( const read_mode* mode = tools::begin( modes ); mode != tools::end( modes ); ++mode )
+	{
+        boost::minstd_rand                  random;
+        std::vector< char >                 messages;
+        std::vector< std::vector< char > >  bodies;
+
+        for ( std::size_t i = 0; i != number_of_bodies; ++i )
+        {
+            typedef boost::uniform_int<std::size_t> distribution_type;
+            typedef boost::variate_generator<boost::minstd_rand&, distribution_type> gen_type;
+
+            distribution_type distribution( 1, max_body_size );
+            gen_type die_gen(random, distribution);
+
+            bodies.push_back( server::test::random_body( random, die_gen() ) );
+
+            const std::vector< char > message = build_randomly_chunked_post_request(
+                random, bodies.back().begin(), bodies.back().end(), 3000u );
+
+            messages.insert( messages.end(), message.begin(), message.end() );
+        }
+
+        trait_t					trait;
+        trait.mode_        = *mode;
+        trait.buffer_size_ = max_body_size;
+
+        boost::asio::io_service	queue;
+        socket_t				socket( queue, &messages[0], &messages[0] + messages.size(),
+                                        random, 1, 2 * max_body_size );
+
+        boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+        connection->start();
+
+        tools::run( queue );
+        BOOST_REQUIRE_EQUAL( trait.read_bodies_.size(), number_of_bodies );
+
+        for ( std::size_t i = 0; i != number_of_bodies; ++i )
+            BOOST_REQUIRE( get_body( trait.read_bodies_[ i ] ).equal( bodies[ i ] ) );
+	}
+}
+
+/**
+ * @class server::connection
+ * @test a body, that does not fit into the buffer of the response, results in an error
+ */
+BOOST_AUTO_TEST_CASE( body_does_not_fit_into_response_buffer )
+{
+	trait_t					trait;
+	trait.mode_        = read_into_buffer;
+	trait.buffer_size_ = 10;
+
+	boost::asio::io_service	queue;
+	socket_t				socket( queue, tools::begin( http::test::simple_post ),
+								tools::end( http::test::simple_post ) -1 );
+
+	boost::shared_ptr< connection_t > connection( new connection_t( socket, trait ) );
+	connection->start();
+
+	tools::run( queue );
+	BOOST_REQUIRE_EQUAL( 1u, trait.read_bodies_.size() );
+	BOOST_CHECK( get_body( trait.read_bodies_.front() ).has_error() );
+	BOOST_CHECK( !get_body( trait.read_bodies_.front() ).body_completed() );
+}
@@ -8,6 +8,7 @@
 #include "http/http.h"
 #include "http/request.h"
 #include "server/error.h"
+#include "server/route_tree.h"
 #include "tools/substring.h"
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
@@ -26,6 +27,10 @@ namespace server
 
     /**
      * @brief a predefined response factory able to create user action responses and proxy responses
+     *
+     * Actions are registered under routes. If more than one route matches a request, the action with the longest
+     * route is called. Routes can be restricted to a request method and can be required to match the URI exactly.
+     * @sa route_tree
      */
     template < class Socket >
     class response_factory : public boost::noncopyable
@@ -44,8 +49,18 @@ namespace server
         template <class Connection>
         boost::shared_ptr<async_response> error_response(const boost::shared_ptr<Connection>& con, http::http_error_code ec) const;
 
+        /**
+         * @brief adds an action, that will be called for requests with any method, whos URI matches the route
+         */
         template < class Action >
-        void add_action( const std::string& route, const Action& action );
+        void add_action( const std::string& route, const Action& action, route_match match = prefix_match );
+
+        /**
+         * @brief adds an action, that will be called only for requests with the given method
+         */
+        template < class Action >
+        void add_action( http::http_method_code method, const std::string& route, const Action& action,
+            route_match match = prefix_match );
 
         void shutdown();
     private:
@@ -84,30 +99,9 @@ namespace server
             }
         };
 
-        typedef std::vector< std::pair< std::string, boost::shared_ptr< action_holder_base > > > action_list_t;
-
-        action_list_t actions_;
-
-        struct fitting_uri
-        {
-            explicit fitting_uri( const tools::substring& s ) : uri_( s ) {}
-
-            template < class P >
-            bool operator()( const P& pair ) const
-            {
-                const std::size_t s = std::min( uri_.size(), pair.first.size() );
-
-                if ( s != pair.first.size() )
-                    return false;
-
-                const tools::substring a( uri_.begin(), uri_.begin() + s );
-                const tools::substring b( pair.first.c_str(), pair.first.c_str() + s );
+        typedef route_tree< boost::shared_ptr< action_holder_base > > action_tree_t;
 
-                return a == b;
-            }
-
-            const tools::substring  uri_;
-        };
+        action_tree_t actions_;
     };
 
 
@@ -134,11 +128,10 @@ namespace server
         if ( header->state() != http::message::ok )
             return error_response( connection, http::http_bad_request );
 
-        const typename action_list_t::const_iterator action =
-            std::find_if( actions_.begin(), actions_.end(), fitting_uri( header->uri() ) );
+        const boost::shared_ptr< action_holder_base >* const action = actions_.find( header->uri(), header->method() );
 
-        if ( action != actions_.end() )
-            return (*action->second)( connection, header );
+        if ( action )
+            return (**action)( connection, header );
 
         return error_response( connection, http::http_not_found );
     }
@@ -153,12 +146,24 @@ namespace server
 
     template < class Socket >
     template < class Action >
-    void response_factory< Socket >::add_action( const std::string& route, const Action& action )
+    void response_factory< Socket >::add_action( const std::string& route, const Action& action, route_match match )
+    {
+        actions_.insert(
+            route,
+            boost::shared_ptr< action_holder_base >( new action_holder< Action >( action) ),
+            match );
+    }
+
+    template < class Socket >
+    template < class Action >
+    void response_factory< Socket >::add_action( http::http_method_code method, const std::string& route,
+        const Action& action, route_match match )
     {
-        actions_.push_back(
-            std::make_pair(
-                route,
-                boost::shared_ptr< action_holder_base >( new action_holder< Action >( action) ) ) );
+        actions_.insert(
+            method,
+            route,
+            boost::shared_ptr< action_holder_base >( new action_holder< Action >( action) ),
+            match );
     }
 
     template < class Socket >
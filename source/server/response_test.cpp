@@ -180,10 +180,10 @@ BOOST_AUTO_TEST_CASE(non_fatal_error_while_responding)
     const std::string       output = socket.output();
     std::size_t             size = output.size();
     http::response_header   first(output.c_str());
-    http::response_header   second(first, size, http::response_header::copy_trailing_buffer);
+    http::response_header   second(first, size, http::response_header::share_trailing_buffer);
     assert(size);
     second.parse(size);
-    http::response_header   third(second, size, http::response_header::copy_trailing_buffer);
+    http::response_header   third(second, size, http::response_header::share_trailing_buffer);
     assert(size);
     third.parse(size);
 
@@ -210,3 +210,120 @@ BOOST_AUTO_TEST_CASE(fatal_error_while_responding)
 {
     /// @todo implement
 }   
+
+namespace {
+
+    // writes "Hallo," and " wie " in two writes, without waiting for the first write to complete
+    template < class Connection >
+    class two_writes_response :
+        public server::async_response,
+        public boost::enable_shared_from_this< two_writes_response< Connection > >
+    {
+    public:
+        explicit two_writes_response(const boost::shared_ptr<Connection>& connection)
+            : connection_(connection)
+            , first_("Hallo,")
+            , second_(" wie ")
+            , outstanding_writes_(0)
+        {
+        }
+
+    private:
+        void start()
+        {
+            write(first_);
+            write(second_);
+        }
+
+        void write(const std::string& text)
+        {
+            ++outstanding_writes_;
+            connection_->async_write(
+                boost::asio::buffer(text),
+                boost::bind(&two_writes_response::handler,
+                        this->shared_from_this(),
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::bytes_transferred),
+                *this);
+        }
+
+        void handler(const boost::system::error_code& error, std::size_t)
+        {
+            if ( error )
+            {
+                connection_->response_not_possible(*this);
+            }
+            else if ( --outstanding_writes_ == 0 )
+            {
+                connection_->response_completed(*this);
+            }
+        }
+
+        const boost::shared_ptr<Connection> connection_;
+        const std::string                   first_;
+        const std::string                   second_;
+        int                                 outstanding_writes_;
+    };
+
+    // the first response waits for simulate_incomming_data(), the others write in two writes
+    struct blocked_writes_response_factory
+    {
+        static int context;
+
+        template < class Trait, class Connection >
+        static boost::shared_ptr<server::async_response> create_response(
+            const boost::shared_ptr<Connection>&                    connection,
+            const boost::shared_ptr<const http::request_header>&    header,
+                  Trait&)
+        {
+            if ( context++ % 2 == 0 )
+                return boost::shared_ptr<server::async_response>(
+                    new response<Connection>(connection, header, "gehts?", manuel_response));
+
+            return boost::shared_ptr<server::async_response>(new two_writes_response<Connection>(connection));
+        }
+    };
+
+    int blocked_writes_response_factory::context = 0;
+
+    void count_writes(int& writes, const boost::asio::const_buffer&)
+    {
+        ++writes;
+    }
+}
+
+/**
+ * @test all writes of a response, that where blocked by a previous response, are written with a single gather write
+ *       once the previous response is completed.
+ */
+BOOST_AUTO_TEST_CASE(blocked_writes_are_gathered_into_a_single_write)
+{
+    typedef server::test::socket<>                          socket_t;
+    typedef traits< blocked_writes_response_factory >       trait_t;
+    typedef server::connection< trait_t >                   connection_t;
+
+    boost::asio::io_service queue;
+    socket_t                socket(queue, begin(simple_get_11), end(simple_get_11), 0, 2);
+    trait_t                 trait;
+    int                     writes = 0;
+
+    socket.write_callback(boost::bind(count_writes, boost::ref(writes), _1));
+    boost::shared_ptr<connection_t> connection = server::create_connection(socket, trait);
+
+    tools::run(queue);
+
+    std::vector<boost::shared_ptr<server::async_response> > resp = trait.responses();
+    BOOST_REQUIRE_EQUAL(2u, resp.size());
+    trait.reset_responses();
+
+    // the second response is blocked by the first one
+    BOOST_CHECK_EQUAL(0, writes);
+
+    simulate_incomming_data(resp[0]);
+    resp.clear();
+
+    tools::run(queue);
+
+    BOOST_CHECK_EQUAL("gehts?Hallo, wie ", socket.output());
+    BOOST_CHECK_EQUAL(2, writes);
+}
@@ -0,0 +1,232 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SERVER_ROUTE_TREE_H_
+#define SIOUX_SERVER_ROUTE_TREE_H_
+
+#include "http/http.h"
+#include "tools/substring.h"
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace server
+{
+    /**
+     * @brief defines how a route has to match a request URI
+     */
+    enum route_match
+    {
+        /** the route matches every URI that starts with the route */
+        prefix_match,
+        /** the route matches only the very same URI, optional followed by a query */
+        exact_match
+    };
+
+    /**
+     * @brief maps routes to values and looks up the best matching route for a request URI
+     *
+     * The routes are stored in a compressed radix tree (every edge is labeled with a string, not just a single
+     * character), so a lookup is linear in the length of the URI, independent of the number of routes.
+     *
+     * If more than one route matches a URI, the longest route wins, regardless of the order the routes where
+     * added. For routes of equal length, an exact match is preferred over a prefix match and a route for the
+     * request method is preferred over a route for any method.
+     */
+    template < class Value >
+    class route_tree
+    {
+    public:
+        route_tree();
+
+        /**
+         * @brief adds a route, that matches requests with any method
+         *
+         * If there is already a value for the very same route, match and method, the value is replaced.
+         */
+        void insert( const std::string& route, const Value& value, route_match match = prefix_match );
+
+        /**
+         * @brief adds a route, that matches only requests with the given method
+         */
+        void insert( http::http_method_code method, const std::string& route, const Value& value,
+            route_match match = prefix_match );
+
+        /**
+         * @brief returns the value of the best matching route, or null, if no route matches
+         */
+        const Value* find( const tools::substring& uri, http::http_method_code method ) const;
+
+        /**
+         * @brief removes all routes
+         */
+        void clear();
+
+        /**
+         * @brief returns true, if no route was added
+         */
+        bool empty() const;
+
+    private:
+        // index 0 is for routes with any method, all other for method code + 1
+        static const std::size_t number_of_slots = http::http_connect + 2;
+
+        struct node
+        {
+            std::string                                 label;
+            std::vector< boost::shared_ptr< node > >    children;
+            boost::optional< Value >                    prefix_values[ number_of_slots ];
+            boost::optional< Value >                    exact_values[ number_of_slots ];
+        };
+
+        void insert( std::size_t slot, const std::string& route, const Value& value, route_match match );
+
+        static const Value* candidate( const node& n, http::http_method_code method, bool complete );
+
+        node    root_;
+        bool    empty_;
+    };
+
+    // implementation
+    template < class Value >
+    route_tree< Value >::route_tree()
+        : root_()
+        , empty_( true )
+    {
+    }
+
+    template < class Value >
+    void route_tree< Value >::insert( const std::string& route, const Value& value, route_match match )
+    {
+        insert( 0, route, value, match );
+    }
+
+    template < class Value >
+    void route_tree< Value >::insert( http::http_method_code method, const std::string& route, const Value& value,
+        route_match match )
+    {
+        insert( method + 1, route, value, match );
+    }
+
+    template < class Value >
+    void route_tree< Value >::insert( std::size_t slot, const std::string& route, const Value& value, route_match match )
+    {
+        node*                       current = &root_;
+        std::string::const_iterator key     = route.begin();
+
+        while ( key != route.end() )
+        {
+            typename std::vector< boost::shared_ptr< node > >::iterator child = current->children.begin();
+
+            for ( ; child != current->children.end() && ( *child )->label[ 0 ] != *key; ++child )
+                ;
+
+            if ( child == current->children.end() )
+            {
+                const boost::shared_ptr< node > leaf( new node );
+                leaf->label.assign( key, route.end() );
+                current->children.push_back( leaf );
+
+                current = leaf.get();
+                key     = route.end();
+            }
+            else
+            {
+                const std::string&  label  = ( *child )->label;
+                const std::size_t   common = std::mismatch( label.begin(),
+                    label.begin() + std::min< std::size_t >( label.size(), route.end() - key ), key ).first - label.begin();
+
+                // split the edge at the first difference
+                if ( common != label.size() )
+                {
+                    const boost::shared_ptr< node > middle( new node );
+                    middle->label = label.substr( 0, common );
+                    ( *child )->label.erase( 0, common );
+                    middle->children.push_back( *child );
+                    *child = middle;
+                }
+
+                current = child->get();
+                key    += common;
+            }
+        }
+
+        ( match == exact_match ? current->exact_values : current->prefix_values )[ slot ] = value;
+        empty_ = false;
+    }
+
+    template < class Value >
+    const Value* route_tree< Value >::find( const tools::substring& uri, http::http_method_code method ) const
+    {
+        const node*         current = &root_;
+        const char*         pos     = uri.begin();
+        const Value*        result  = candidate( root_, method, pos == uri.end() || *pos == '?' );
+
+        while ( pos != uri.end() )
+        {
+            typename std::vector< boost::shared_ptr< node > >::const_iterator child = current->children.begin();
+
+            for ( ; child != current->children.end() && ( *child )->label[ 0 ] != *pos; ++child )
+                ;
+
+            if ( child == current->children.end() )
+                break;
+
+            const std::string& label = ( *child )->label;
+
+            if ( static_cast< std::size_t >( uri.end() - pos ) < label.size()
+              || !std::equal( label.begin(), label.end(), pos ) )
+                break;
+
+            current = child->get();
+            pos    += label.size();
+
+            if ( const Value* const found = candidate( *current, method, pos == uri.end() || *pos == '?' ) )
+                result = found;
+        }
+
+        return result;
+    }
+
+    template < class Value >
+    const Value* route_tree< Value >::candidate( const node& n, http::http_method_code method, bool complete )
+    {
+        const std::size_t slots[] = { static_cast< std::size_t >( method + 1 ), 0 };
+
+        if ( complete )
+        {
+            for ( const std::size_t* slot = slots; slot != slots + 2; ++slot )
+            {
+                if ( n.exact_values[ *slot ] )
+                    return n.exact_values[ *slot ].get_ptr();
+            }
+        }
+
+        for ( const std::size_t* slot = slots; slot != slots + 2; ++slot )
+        {
+            if ( n.prefix_values[ *slot ] )
+                return n.prefix_values[ *slot ].get_ptr();
+        }
+
+        return 0;
+    }
+
+    template < class Value >
+    void route_tree< Value >::clear()
+    {
+        root_  = node();
+        empty_ = true;
+    }
+
+    template < class Value >
+    bool route_tree< Value >::empty() const
+    {
+        return empty_;
+    }
+
+} // namespace server
+
+#endif /* SIOUX_SERVER_ROUTE_TREE_H_ */
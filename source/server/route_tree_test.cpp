@@ -0,0 +1,108 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/route_tree.h"
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+
+namespace
+{
+    // returns the value found for the uri or -1, if nothing was found
+    int lookup( const server::route_tree< int >& tree, const char* uri, http::http_method_code method = http::http_get )
+    {
+        const int* const result = tree.find( tools::substring( uri, uri + std::strlen( uri ) ), method );
+
+        return result ? *result : -1;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( empty_route_tree_finds_nothing )
+{
+    server::route_tree< int > tree;
+
+    BOOST_CHECK( tree.empty() );
+    BOOST_CHECK_EQUAL( lookup( tree, "/" ), -1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "" ), -1 );
+}
+
+/**
+ * @test the longest matching route wins, independent from the order in which the routes where added
+ */
+BOOST_AUTO_TEST_CASE( longest_prefix_wins )
+{
+    server::route_tree< int > tree;
+    tree.insert( "/", 1 );
+    tree.insert( "/bayeux/tenant1", 3 );
+    tree.insert( "/bayeux", 2 );
+    tree.insert( "/bayeux/tenant2", 4 );
+
+    BOOST_CHECK( !tree.empty() );
+    BOOST_CHECK_EQUAL( lookup( tree, "/" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/index.html" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeu" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/tenant" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/tenant1" ), 3 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/tenant1/handshake" ), 3 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/tenant2?x=1" ), 4 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/bayeux/tenant3" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "" ), -1 );
+}
+
+BOOST_AUTO_TEST_CASE( exact_routes_match_only_the_very_same_uri )
+{
+    server::route_tree< int > tree;
+    tree.insert( "/ping", 1, server::exact_match );
+    tree.insert( "/", 2, server::exact_match );
+
+    BOOST_CHECK_EQUAL( lookup( tree, "/ping" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/ping?t=12" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/pingpong" ), -1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/pin" ), -1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/?a=b" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/x" ), -1 );
+
+    // a prefix route on the same node is used for all other URIs
+    tree.insert( "/ping", 3 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/ping" ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/pingpong" ), 3 );
+}
+
+BOOST_AUTO_TEST_CASE( method_specific_routes )
+{
+    server::route_tree< int > tree;
+    tree.insert( "/", 1 );
+    tree.insert( http::http_post, "/upload", 2 );
+    tree.insert( "/api", 3 );
+    tree.insert( http::http_get, "/api", 4 );
+
+    BOOST_CHECK_EQUAL( lookup( tree, "/upload", http::http_post ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/upload", http::http_get ), 1 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/api/x", http::http_get ), 4 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/api/x", http::http_put ), 3 );
+}
+
+/**
+ * @test adding routes, that split existing edges, must not change the existing routes
+ */
+BOOST_AUTO_TEST_CASE( splitting_edges )
+{
+    server::route_tree< int > tree;
+    tree.insert( "/abcdef", 1 );
+    tree.insert( "/abcxyz", 2 );
+    tree.insert( "/ab", 3 );
+    tree.insert( "/abcdef", 5 );
+
+    BOOST_CHECK_EQUAL( lookup( tree, "/abcdefg" ), 5 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/abcxyz" ), 2 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/abc" ), 3 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/abcx" ), 3 );
+    BOOST_CHECK_EQUAL( lookup( tree, "/a" ), -1 );
+
+    tree.clear();
+    BOOST_CHECK( tree.empty() );
+    BOOST_CHECK_EQUAL( lookup( tree, "/abcdef" ), -1 );
+}
@@ -15,10 +15,19 @@
 #include <boost/utility.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits/is_same.hpp>
+#include <stdexcept>
 
 namespace server {
 
 
+#if defined( SO_REUSEPORT )
+    /**
+     * @brief socket option to allow more than one socket to listen on the same port, with the kernel distributing
+     *        incomming connections
+     */
+    typedef boost::asio::detail::socket_option::boolean< SOL_SOCKET, SO_REUSEPORT > reuse_port;
+#endif
+
     /**
      * @brief accepts incoming connection and creates connection objects from that
      */
@@ -26,13 +35,32 @@ namespace server {
     class acceptator : public boost::enable_shared_from_this< acceptator< Trait, Connection > >
     {
     public:
-        acceptator(boost::asio::io_service& s, Trait& trait, const boost::asio::ip::tcp::endpoint& ep)
+        /**
+         * @param share_port if true, the listen socket is opened with SO_REUSEPORT, so that other acceptators
+         *        can listen on the very same endpoint
+         * @exception std::runtime_error if share_port is true and SO_REUSEPORT is not supported
+         */
+        acceptator(boost::asio::io_service& s, Trait& trait, const boost::asio::ip::tcp::endpoint& ep, bool share_port = false)
             : end_point_(ep)
-            , acceptor_(s, ep)
+            , acceptor_(s)
             , queue_(s)
             , trait_(trait)
             , timer_( queue_ )
         {
+            acceptor_.open( ep.protocol() );
+            acceptor_.set_option( boost::asio::ip::tcp::acceptor::reuse_address( true ) );
+
+            if ( share_port )
+            {
+#if defined( SO_REUSEPORT )
+                acceptor_.set_option( reuse_port( true ) );
+#else
+                throw std::runtime_error( "acceptator: SO_REUSEPORT is not supported" );
+#endif
+            }
+
+            acceptor_.bind( ep );
+            acceptor_.listen();
         }
 
         void start()
@@ -91,7 +119,7 @@ namespace server {
         boost::asio::ip::tcp::acceptor  acceptor_;
         boost::asio::io_service&        queue_;
         Trait&                          trait_;
-        boost::asio::deadline_timer     timer_;
+        wheel_timer                     timer_;
     };
 
     /**
@@ -132,8 +160,16 @@ namespace server {
 
         /**
          * @brief adds a new route for a user defined action
+         *
+         * If more than one route matches a request, the action with the longest route is called.
          */
-        void add_action( const char* route, const action_t& action );
+        void add_action( const char* route, const action_t& action, route_match match = prefix_match );
+
+        /**
+         * @brief adds a new route for a user defined action, that is called only for requests with the given method
+         */
+        void add_action( http::http_method_code method, const char* route, const action_t& action,
+            route_match match = prefix_match );
 
         /**
          * @brief stops accepting incomming connections, close all listen ports
@@ -256,10 +292,18 @@ namespace server {
 
 
     template < class Trait >
-    void basic_server<Trait>::add_action( const char* route, const action_t& action )
+    void basic_server<Trait>::add_action( const char* route, const action_t& action, route_match match )
+    {
+        assert( !shutting_down_ );
+        trait_.add_action( route, action, match );
+    }
+
+    template < class Trait >
+    void basic_server<Trait>::add_action( http::http_method_code method, const char* route, const action_t& action,
+        route_match match )
     {
         assert( !shutting_down_ );
-        trait_.add_action( route, action );
+        trait_.add_action( method, route, action, match );
     }
 
     template <class Trait>
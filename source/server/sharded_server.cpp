@@ -0,0 +1,28 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/sharded_server.h"
+
+#if defined( __linux__ )
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+namespace server {
+
+    bool pin_current_thread( unsigned cpu )
+    {
+#if defined( __linux__ )
+        cpu_set_t cpus;
+        CPU_ZERO( &cpus );
+        CPU_SET( cpu % CPU_SETSIZE, &cpus );
+
+        return pthread_setaffinity_np( pthread_self(), sizeof cpus, &cpus ) == 0;
+#else
+        static_cast< void >( cpu );
+        return false;
+#endif
+    }
+
+} // namespace server
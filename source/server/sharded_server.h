@@ -0,0 +1,265 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SERVER_SHARDED_SERVER_H_
+#define SIOUX_SERVER_SHARDED_SERVER_H_
+
+#include "server/server.h"
+#include <boost/asio/io_service.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace server {
+
+    /**
+     * @brief binds the calling thread to the given CPU
+     *
+     * @return false, if binding threads to CPUs is not supported or failed
+     */
+    bool pin_current_thread( unsigned cpu );
+
+    /**
+     * @brief a http server, that runs one io_service with exactly one thread per shard
+     *
+     * Where basic_server runs all threads on a single io_service, this server creates one io_service and one
+     * thread per shard (typical one shard per CPU core). Every listen endpoint gets one acceptator per shard,
+     * that listens with SO_REUSEPORT on its own socket, so the kernel distributes the incomming connections
+     * over the shards. A connection is handled completely by the shard that accepted it, so no connection state
+     * has to be shared between threads and the threads do not contend on a shared reactor.
+     *
+     * All shards share the same trait and thus the same response factory, so actions added to the server are
+     * called from all shards and have to be thread safe, as with a multi threaded basic_server.
+     */
+    template < class Trait >
+    class basic_sharded_server : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief constructs a new server and starts one thread per shard
+         *
+         * @param number_of_shards the number of shards, 0 to use one shard per CPU core
+         * @param pin_threads if true, the thread of shard n is bound to CPU n
+         */
+        explicit basic_sharded_server( unsigned number_of_shards, bool pin_threads = false );
+
+        template < class TraitParameters >
+        basic_sharded_server( unsigned number_of_shards, bool pin_threads, const TraitParameters& param );
+
+        /**
+         * @brief shuts the server down, stops all shards and joins all threads
+         */
+        ~basic_sharded_server();
+
+        /**
+         * @brief adds a new tcp::endpoint where all shards will listen for incomming connections
+         * @exception std::runtime_error if SO_REUSEPORT is not supported
+         */
+        void add_listener( const boost::asio::ip::tcp::endpoint& );
+
+        typedef typename basic_server< Trait >::action_t action_t;
+
+        /**
+         * @brief adds a new route for a user defined action
+         */
+        void add_action( const char* route, const action_t& action, route_match match = prefix_match );
+
+        /**
+         * @brief adds a new route for a user defined action, that is called only for requests with the given method
+         */
+        void add_action( http::http_method_code method, const char* route, const action_t& action,
+            route_match match = prefix_match );
+
+        /**
+         * @brief stops accepting incomming connections, closes all listen ports
+         *
+         * The threads keep running until all remaining connections are closed.
+         */
+        void shut_down();
+
+        /**
+         * @brief joins all threads
+         */
+        void join();
+
+        /**
+         * @brief the number of shards
+         */
+        unsigned shards() const;
+
+        /**
+         * @brief the io_service of the given shard
+         */
+        boost::asio::io_service& queue( unsigned shard );
+
+        typedef Trait                           trait_t;
+        trait_t& trait();
+
+        typedef connection< Trait >             connection_t;
+    private:
+        struct shard
+        {
+            boost::asio::io_service                             queue;
+            boost::scoped_ptr< boost::asio::io_service::work >  work;
+        };
+
+        void start_shards( unsigned number_of_shards );
+        void run_shard( unsigned index );
+
+        typedef boost::asio::ip::tcp::socket    socket_t;
+        typedef acceptator< trait_t, socket_t > acceptor_t;
+        typedef std::vector< boost::shared_ptr< acceptor_t > >  acceptor_list_t;
+
+        trait_t                                     trait_;
+        const bool                                  pin_threads_;
+        std::vector< boost::shared_ptr< shard > >   shards_;
+        boost::thread_group                         threads_;
+
+        acceptor_list_t                             acceptors_;
+        bool                                        shutting_down_;
+    };
+
+    typedef basic_sharded_server<
+        connection_traits<
+            boost::asio::ip::tcp::socket,
+            boost::asio::deadline_timer,
+            response_factory< boost::asio::ip::tcp::socket > > > sharded_http_server;
+
+    ///////////////////////
+    // implementation
+    template < class Trait >
+    basic_sharded_server< Trait >::basic_sharded_server( unsigned number_of_shards, bool pin_threads )
+        : trait_()
+        , pin_threads_( pin_threads )
+        , shards_()
+        , threads_()
+        , acceptors_()
+        , shutting_down_( false )
+    {
+        start_shards( number_of_shards );
+    }
+
+    template < class Trait >
+    template < class TraitParameters >
+    basic_sharded_server< Trait >::basic_sharded_server( unsigned number_of_shards, bool pin_threads,
+        const TraitParameters& param )
+        : trait_( param )
+        , pin_threads_( pin_threads )
+        , shards_()
+        , threads_()
+        , acceptors_()
+        , shutting_down_( false )
+    {
+        start_shards( number_of_shards );
+    }
+
+    template < class Trait >
+    basic_sharded_server< Trait >::~basic_sharded_server()
+    {
+        if ( !shutting_down_ )
+            shut_down();
+
+        for ( typename std::vector< boost::shared_ptr< shard > >::const_iterator s = shards_.begin(); s != shards_.end(); ++s )
+            ( *s )->queue.stop();
+
+        threads_.join_all();
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::start_shards( unsigned number_of_shards )
+    {
+        if ( number_of_shards == 0 )
+            number_of_shards = std::max( boost::thread::hardware_concurrency(), 1u );
+
+        for ( unsigned index = 0; index != number_of_shards; ++index )
+        {
+            const boost::shared_ptr< shard > new_shard( new shard );
+            new_shard->work.reset( new boost::asio::io_service::work( new_shard->queue ) );
+            shards_.push_back( new_shard );
+        }
+
+        for ( unsigned index = 0; index != number_of_shards; ++index )
+            threads_.create_thread( boost::bind( &basic_sharded_server::run_shard, this, index ) );
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::run_shard( unsigned index )
+    {
+        if ( pin_threads_ )
+            pin_current_thread( index );
+
+        shards_[ index ]->queue.run();
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::add_listener( const boost::asio::ip::tcp::endpoint& ep )
+    {
+        assert( !shutting_down_ );
+
+        for ( typename std::vector< boost::shared_ptr< shard > >::const_iterator s = shards_.begin(); s != shards_.end(); ++s )
+        {
+            boost::shared_ptr< acceptor_t > accept( new acceptor_t( ( *s )->queue, trait_, ep, true ) );
+            acceptors_.push_back( accept );
+            accept->start();
+        }
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::add_action( const char* route, const action_t& action, route_match match )
+    {
+        assert( !shutting_down_ );
+        trait_.add_action( route, action, match );
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::add_action( http::http_method_code method, const char* route,
+        const action_t& action, route_match match )
+    {
+        assert( !shutting_down_ );
+        trait_.add_action( method, route, action, match );
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::shut_down()
+    {
+        shutting_down_ = true;
+
+        for ( typename acceptor_list_t::iterator acc = acceptors_.begin(); acc != acceptors_.end(); ++acc )
+            ( *acc )->shut_down();
+
+        trait_.shutdown();
+
+        for ( typename std::vector< boost::shared_ptr< shard > >::const_iterator s = shards_.begin(); s != shards_.end(); ++s )
+            ( *s )->work.reset();
+    }
+
+    template < class Trait >
+    void basic_sharded_server< Trait >::join()
+    {
+        threads_.join_all();
+    }
+
+    template < class Trait >
+    unsigned basic_sharded_server< Trait >::shards() const
+    {
+        return static_cast< unsigned >( shards_.size() );
+    }
+
+    template < class Trait >
+    boost::asio::io_service& basic_sharded_server< Trait >::queue( unsigned shard )
+    {
+        return shards_[ shard ]->queue;
+    }
+
+    template < class Trait >
+    typename basic_sharded_server< Trait >::trait_t& basic_sharded_server< Trait >::trait()
+    {
+        return trait_;
+    }
+
+} // namespace server
+
+#endif /* SIOUX_SERVER_SHARDED_SERVER_H_ */
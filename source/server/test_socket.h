@@ -290,6 +290,11 @@ private:
         template <typename ConnectHandler>
         void async_connect(const boost::asio::ip::tcp::endpoint& peer_endpoint, ConnectHandler handler);
 
+        // copies planned data into the buffers; data that doesn't fit, is delivered with the next read, like a
+        // real socket would do
+        template <typename MutableBufferSequence>
+        std::size_t planned_read(const std::string& data, const MutableBufferSequence& buffers);
+
         void close();
 
         void shutdown(boost::asio::ip::tcp::socket::shutdown_type what);
@@ -345,6 +350,7 @@ private:
 
         server::test::read_plan                     read_plan_;
         server::test::write_plan                    write_plan_;
+        std::string                                 unread_;
     };
 
     boost::shared_ptr<impl>  pimpl_;
@@ -757,7 +763,7 @@ namespace {
             }
             else
             {   
-                handler(error, copy_read(data, buffer));
+                handler(error, socket->planned_read(data, buffer));
             }
         }
 
@@ -904,6 +910,18 @@ void socket<Iterator, Timer, Trait>::impl::undelayed_async_read_some(
     }
 }
 
+template <class Iterator, class Timer, class Trait>
+template <typename MutableBufferSequence>
+std::size_t socket<Iterator, Timer, Trait>::impl::planned_read(
+        const std::string& data,
+        const MutableBufferSequence& buffers)
+{
+    const std::size_t size = copy_read(data, buffers);
+    unread_.assign(data, size, std::string::npos);
+
+    return size;
+}
+
 template <class Iterator, class Timer, class Trait>
 template <typename MutableBufferSequence, class ReadHandler>
 void socket<Iterator, Timer, Trait>::impl::async_read_some(
@@ -916,7 +934,15 @@ void socket<Iterator, Timer, Trait>::impl::async_read_some(
         return;
     }
 
-    if ( !read_plan_.empty() )
+    if ( !unread_.empty() )
+    {
+        std::string data;
+        data.swap(unread_);
+
+        const std::size_t size = planned_read(data, buffers);
+        io_service_.post(boost::bind<void>(handler, boost::system::error_code(), size));
+    }
+    else if ( !read_plan_.empty() )
     {
         const read_plan::item plan = read_plan_.next_read();
 
@@ -928,7 +954,7 @@ void socket<Iterator, Timer, Trait>::impl::async_read_some(
         }
         else
         {
-        	const std::size_t size = copy_read(plan.first, buffers);
+        	const std::size_t size = planned_read(plan.first, buffers);
             io_service_.post(boost::bind<void>(handler, boost::system::error_code(), size));
         }
     }
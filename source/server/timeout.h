@@ -14,16 +14,19 @@ namespace server
 {
     /**
      * @brief function, that implements read with timeout
+     *
+     * Timer can be a boost::asio::deadline_timer or any timer with a compatible interface, like server::wheel_timer.
      */
     template<
         typename AsyncReadStream,
         typename MutableBufferSequence,
-        typename ReadHandler>
+        typename ReadHandler,
+        typename Timer>
     void async_read_some_with_to(
         AsyncReadStream&                        stream,
         const MutableBufferSequence&            buffers,
         ReadHandler                             handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out);
 
     /**
@@ -32,12 +35,13 @@ namespace server
     template<
         typename AsyncReadStream,
         typename ConstBufferSequence,
-        typename WriteHandler>
+        typename WriteHandler,
+        typename Timer>
     void async_write_some_with_to(
         AsyncReadStream&                        stream,
         const ConstBufferSequence&              buffers,
         WriteHandler                            handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out);
 
     /**
@@ -46,12 +50,13 @@ namespace server
     template<
         typename AsyncReadStream,
         typename ConstBufferSequence,
-        typename WriteHandler>
+        typename WriteHandler,
+        typename Timer>
     void async_write_with_to(
         AsyncReadStream&                        stream,
         const ConstBufferSequence&              buffers,
         WriteHandler                            handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out);
 
     // implementations
@@ -60,13 +65,14 @@ namespace server
         template<
             typename AsyncReadStream,
             typename MutableBufferSequence,
-            typename ReadHandler>
+            typename ReadHandler,
+            typename Timer>
         struct async_read_some_with_to_t
         {
             AsyncReadStream&                socket;
             MutableBufferSequence           buffers;   
             ReadHandler                     handler;
-            boost::asio::deadline_timer&    timer;
+            Timer&                          timer;
 
             void operator()(const boost::system::error_code& error)
             {
@@ -97,13 +103,14 @@ namespace server
         template<
             typename AsyncWriteStream,
             typename ConstBufferSequence,
-            typename WriteHandler>
+            typename WriteHandler,
+            typename Timer>
         struct async_write_some_with_to_t
         {
             AsyncWriteStream&               socket;
             ConstBufferSequence             buffers;   
             WriteHandler                    handler;
-            boost::asio::deadline_timer&    timer;
+            Timer&                          timer;
 
             void operator()(const boost::system::error_code& error)
             {
@@ -134,15 +141,16 @@ namespace server
     template<
         typename AsyncReadStream,
         typename MutableBufferSequence,
-        typename ReadHandler>
+        typename ReadHandler,
+        typename Timer>
     void async_read_some_with_to(
         AsyncReadStream&                        stream,
         const MutableBufferSequence&            buffers,
         ReadHandler                             handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out)
     {
-        details::async_read_some_with_to_t<AsyncReadStream, MutableBufferSequence, ReadHandler> timeout_handler = 
+        details::async_read_some_with_to_t<AsyncReadStream, MutableBufferSequence, ReadHandler, Timer> timeout_handler = 
             {stream, buffers, handler, timer};
 
         timer.expires_from_now(time_out);
@@ -154,16 +162,17 @@ namespace server
     template<
         typename AsyncReadStream,
         typename ConstBufferSequence,
-        typename WriteHandler>
+        typename WriteHandler,
+        typename Timer>
     void async_write_some_with_to(
         AsyncReadStream&                        stream,
         const ConstBufferSequence&              buffers,
         WriteHandler                            handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out)
     
     {
-        details::async_write_some_with_to_t<AsyncReadStream, ConstBufferSequence, WriteHandler> timeout_handler = 
+        details::async_write_some_with_to_t<AsyncReadStream, ConstBufferSequence, WriteHandler, Timer> timeout_handler = 
             {stream, buffers, handler, timer};
 
         timer.expires_from_now(time_out);
@@ -175,15 +184,16 @@ namespace server
     template<
         typename AsyncReadStream,
         typename ConstBufferSequence,
-        typename WriteHandler>
+        typename WriteHandler,
+        typename Timer>
     void async_write_with_to(
         AsyncReadStream&                        stream,
         const ConstBufferSequence&              buffers,
         WriteHandler                            handler,
-        boost::asio::deadline_timer&            timer,
+        Timer&                                  timer,
         const boost::posix_time::time_duration& time_out)
     {
-    	details::async_write_some_with_to_t< AsyncReadStream, ConstBufferSequence, WriteHandler > timeout_handler =
+    	details::async_write_some_with_to_t< AsyncReadStream, ConstBufferSequence, WriteHandler, Timer > timeout_handler =
     	{
     		stream, buffers, handler, timer
     	};
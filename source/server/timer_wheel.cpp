@@ -0,0 +1,273 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/timer_wheel.h"
+#include "tools/iterators.h"
+#include <boost/asio/error.hpp>
+#include <boost/bind.hpp>
+#include <cassert>
+#include <vector>
+
+namespace server
+{
+    namespace {
+        const long resolution_ms = 100;
+
+        // keeps the timer_wheel of an io_service and shuts the wheel down, when the io_service is destroyed
+        class timer_wheel_service : public boost::asio::io_service::service
+        {
+        public:
+            static boost::asio::io_service::id id;
+
+            explicit timer_wheel_service( boost::asio::io_service& queue )
+                : boost::asio::io_service::service( queue )
+                , wheel_( new timer_wheel( queue ) )
+            {
+            }
+
+            const boost::shared_ptr< timer_wheel >& wheel() const
+            {
+                return wheel_;
+            }
+
+        private:
+            virtual void shutdown_service()
+            {
+                wheel_->shutdown();
+            }
+
+            const boost::shared_ptr< timer_wheel > wheel_;
+        };
+
+        boost::asio::io_service::id timer_wheel_service::id;
+    }
+
+    /////////////////
+    // struct timer_wheel::entry
+    timer_wheel::entry::entry()
+        : rounds( 0 )
+        , expire( 0 )
+        , discard( 0 )
+        , storage()
+    {
+        next = previous = 0;
+    }
+
+    /////////////////
+    // class timer_wheel
+    boost::shared_ptr< timer_wheel > timer_wheel::get( boost::asio::io_service& queue )
+    {
+        return boost::asio::use_service< timer_wheel_service >( queue ).wheel();
+    }
+
+    timer_wheel::timer_wheel( boost::asio::io_service& queue )
+        : queue_( queue )
+        , mutex_()
+        , current_slot_( 0 )
+        , size_( 0 )
+        , ticking_( false )
+        , next_tick_()
+        , ticker_( new boost::asio::deadline_timer( queue ) )
+    {
+        for ( node* slot = tools::begin( slots_ ); slot != tools::end( slots_ ); ++slot )
+            slot->next = slot->previous = slot;
+    }
+
+    bool timer_wheel::link( entry& e, const boost::posix_time::time_duration& delay )
+    {
+        const long          ms    = delay.total_milliseconds();
+        // one additional step, as the next step of the wheel can be due at any time
+        const std::size_t   ticks = 1u + ( ms <= 0 ? 0u : static_cast< std::size_t >( ( ms + resolution_ms - 1 ) / resolution_ms ) );
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        // the io_service is shutting down
+        if ( !ticker_ )
+            return false;
+
+        node& slot = slots_[ ( current_slot_ + ticks ) % number_of_slots ];
+
+        e.rounds    = ( ticks - 1 ) / number_of_slots;
+        e.previous  = slot.previous;
+        e.next      = &slot;
+        slot.previous->next = &e;
+        slot.previous       = &e;
+
+        ++size_;
+
+        if ( !ticking_ )
+            start_ticking();
+
+        return true;
+    }
+
+    void timer_wheel::discard( entry& e )
+    {
+        void ( *const discard_handler )( entry& ) = e.discard;
+        e.discard = 0;
+
+        discard_handler( e );
+    }
+
+    std::size_t timer_wheel::cancel( entry& e )
+    {
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            if ( !e.next )
+                return 0;
+
+            unlink( e );
+        }
+
+        // outside the lock, as destroying the handler might destroy the owner of the entry and thus cancel() it
+        discard( e );
+
+        return 1;
+    }
+
+    boost::posix_time::time_duration timer_wheel::resolution()
+    {
+        return boost::posix_time::milliseconds( resolution_ms );
+    }
+
+    std::size_t timer_wheel::size() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        return size_;
+    }
+
+    void timer_wheel::shutdown()
+    {
+        std::vector< entry* > unlinked;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            for ( node* slot = tools::begin( slots_ ); slot != tools::end( slots_ ); ++slot )
+            {
+                while ( slot->next != slot )
+                {
+                    entry& e = static_cast< entry& >( *slot->next );
+                    unlink( e );
+                    unlinked.push_back( &e );
+                }
+            }
+
+            ticker_.reset();
+        }
+
+        // destroy all handlers, as they might keep the owners of the timers alive
+        for ( std::vector< entry* >::const_iterator e = unlinked.begin(); e != unlinked.end(); ++e )
+            discard( **e );
+    }
+
+    void timer_wheel::start_ticking()
+    {
+        ticking_   = true;
+        next_tick_ = boost::posix_time::microsec_clock::universal_time() + resolution();
+
+        ticker_->expires_at( next_tick_ );
+        ticker_->async_wait( boost::bind( &timer_wheel::tick, this, _1 ) );
+    }
+
+    void timer_wheel::tick( const boost::system::error_code& error )
+    {
+        if ( error )
+            return;
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+
+            const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+
+            // catch up, if the io_service was busy for more than one step
+            for ( ; next_tick_ <= now && size_ != 0; next_tick_ += resolution() )
+            {
+                current_slot_ = ( current_slot_ + 1 ) % number_of_slots;
+                node& slot    = slots_[ current_slot_ ];
+
+                for ( node* e = slot.next; e != &slot; )
+                {
+                    entry& current = static_cast< entry& >( *e );
+                    e = e->next;
+
+                    if ( current.rounds == 0 )
+                    {
+                        // posts a copy of the handler, the entry is free to be scheduled again
+                        unlink( current );
+                        current.discard = 0;
+                        current.expire( current, queue_ );
+                    }
+                    else
+                    {
+                        --current.rounds;
+                    }
+                }
+            }
+
+            if ( size_ == 0 )
+            {
+                ticking_ = false;
+            }
+            else
+            {
+                ticker_->expires_at( next_tick_ );
+                ticker_->async_wait( boost::bind( &timer_wheel::tick, this, _1 ) );
+            }
+        }
+    }
+
+    void timer_wheel::unlink( entry& e )
+    {
+        e.previous->next = e.next;
+        e.next->previous = e.previous;
+        e.next = e.previous = 0;
+
+        --size_;
+    }
+
+    /////////////////
+    // class wheel_timer
+    wheel_timer::wheel_timer( boost::asio::io_service& queue )
+        : queue_( queue )
+        , wheel_( timer_wheel::get( queue ) )
+        , entry_()
+        , expiry_time_()
+    {
+    }
+
+    wheel_timer::~wheel_timer()
+    {
+        wheel_->cancel( entry_ );
+    }
+
+    std::size_t wheel_timer::expires_from_now( const duration_type& expiry_time )
+    {
+        expiry_time_ = expiry_time;
+        return wheel_->cancel( entry_ );
+    }
+
+    std::size_t wheel_timer::expires_from_now( const duration_type& expiry_time, boost::system::error_code& ec )
+    {
+        ec = boost::system::error_code();
+        return expires_from_now( expiry_time );
+    }
+
+    std::size_t wheel_timer::cancel()
+    {
+        return wheel_->cancel( entry_ );
+    }
+
+    std::size_t wheel_timer::cancel( boost::system::error_code& ec )
+    {
+        ec = boost::system::error_code();
+        return cancel();
+    }
+
+    boost::asio::io_service& wheel_timer::get_io_service()
+    {
+        return queue_;
+    }
+}
@@ -0,0 +1,274 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SERVER_TIMER_WHEEL_H_
+#define SIOUX_SERVER_TIMER_WHEEL_H_
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <cassert>
+#include <new>
+
+namespace server
+{
+    /**
+     * @brief hashed timer wheel with coarse resolution, one per io_service
+     *
+     * Timeouts for reading, writing and keep alive are armed and canceled very often, but expire very rarely.
+     * Every entry is kept in a doubly linked list in one slot of a wheel, so arming and canceling is O(1) and
+     * does not touch the operating system. A single deadline_timer advances the wheel in steps of resolution()
+     * and only while there are entries in the wheel. Delays, longer than one rotation of the wheel, are handled
+     * by counting the number of remaining rotations per entry.
+     *
+     * Handlers are stored within the entries, so arming a timer does not allocate memory, as long as the handler
+     * fits into handler_storage_size bytes. Expiration handlers are never called from within the wheel, but posted
+     * to the io_service. Expiration can be delayed by up to one resolution step. The handler of a canceled entry is
+     * destroyed without being called, as the timeouts are canceled very often and the handlers of all users ignore
+     * boost::asio::error::operation_aborted anyway.
+     *
+     * Use wheel_timer to use the wheel. The wheel stays alive as long as there are timers using it, but stops
+     * to operate when the io_service is destroyed.
+     */
+    class timer_wheel : boost::noncopyable
+    {
+    public:
+        /**
+         * @brief returns the wheel of the given io_service. The wheel is created on the first call.
+         */
+        static boost::shared_ptr< timer_wheel > get( boost::asio::io_service& queue );
+
+        explicit timer_wheel( boost::asio::io_service& queue );
+
+        /**
+         * @brief handlers up to this size are stored within the entry, larger handlers are allocated on the heap
+         */
+        static const std::size_t handler_storage_size = 16 * sizeof( void* );
+
+        /**
+         * @brief element of the circular lists in the slots of the wheel
+         */
+        struct node
+        {
+            node*           next;
+            node*           previous;
+        };
+
+        /**
+         * @brief a timer entry in the wheel. Must not be destroyed while scheduled.
+         */
+        struct entry : node, boost::noncopyable
+        {
+            entry();
+
+            std::size_t     rounds;
+
+            // type erased handler; discard is null, if there is no handler stored
+            void ( *expire )( entry&, boost::asio::io_service& );
+            void ( *discard )( entry& );
+            boost::aligned_storage< handler_storage_size >::type storage;
+        };
+
+        /**
+         * @brief schedules the handler to be called with a success code, after the delay elapsed
+         * @pre the entry is not scheduled
+         */
+        template < class Handler >
+        void schedule( entry& e, const boost::posix_time::time_duration& delay, const Handler& handler );
+
+        /**
+         * @brief removes the entry from the wheel, if it is scheduled.
+         *
+         * The handler will be destroyed without being called.
+         * @return the number of canceled handlers (0 or 1)
+         */
+        std::size_t cancel( entry& e );
+
+        /**
+         * @brief the time between two steps of the wheel
+         */
+        static boost::posix_time::time_duration resolution();
+
+        /**
+         * @brief the number of currently scheduled entries
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief destroys all scheduled handlers without calling them and stops the wheel
+         *
+         * Called, when the io_service is destroyed.
+         */
+        void shutdown();
+
+    private:
+        template < class Handler, bool InPlace >
+        struct stored_handler;
+
+        template < class Handler >
+        struct handler_ops;
+
+        // links the entry into the wheel, returns false, if the wheel is shut down
+        bool link( entry& e, const boost::posix_time::time_duration& delay );
+        static void discard( entry& e );
+
+        void tick( const boost::system::error_code& error );
+        void start_ticking();
+        void unlink( entry& e );
+
+        // one rotation of the wheel covers 51.2 seconds
+        static const std::size_t number_of_slots = 512;
+
+        boost::asio::io_service&                            queue_;
+        mutable boost::mutex                                mutex_;
+        // every slot is the sentinel of a circular list
+        node                                                slots_[ number_of_slots ];
+        std::size_t                                         current_slot_;
+        std::size_t                                         size_;
+        bool                                                ticking_;
+        boost::posix_time::ptime                            next_tick_;
+        boost::scoped_ptr< boost::asio::deadline_timer >    ticker_;
+    };
+
+    /**
+     * @brief timer with an interface similar to boost::asio::deadline_timer, that uses the timer_wheel of
+     *        the io_service
+     *
+     * Contrary to a deadline_timer, there can be only one outstanding wait on a wheel_timer.
+     */
+    class wheel_timer : boost::noncopyable
+    {
+    public:
+        typedef boost::posix_time::time_duration duration_type;
+
+        explicit wheel_timer( boost::asio::io_service& queue );
+
+        /**
+         * @brief cancels an outstanding wait
+         */
+        ~wheel_timer();
+
+        /**
+         * @brief sets the timer's expire time relative to now and cancels an outstanding wait
+         *
+         * The handler of the canceled wait will be destroyed without being called.
+         * @return the number of canceled waits
+         */
+        std::size_t expires_from_now( const duration_type& expiry_time );
+        std::size_t expires_from_now( const duration_type& expiry_time, boost::system::error_code& ec );
+
+        /**
+         * @brief calls the handler, when the timer expires
+         * @pre there is no outstanding wait on this timer
+         */
+        template < typename WaitHandler >
+        void async_wait( WaitHandler handler );
+
+        /**
+         * @brief cancels an outstanding wait, the handler will be destroyed without being called
+         *
+         * Contrary to a deadline_timer, the handler is not called with operation_aborted.
+         */
+        std::size_t cancel();
+        std::size_t cancel( boost::system::error_code& ec );
+
+        boost::asio::io_service& get_io_service();
+
+    private:
+        boost::asio::io_service&                queue_;
+        const boost::shared_ptr< timer_wheel >  wheel_;
+        timer_wheel::entry          entry_;
+        duration_type               expiry_time_;
+    };
+
+    // implementation
+    template < class Handler >
+    struct timer_wheel::stored_handler< Handler, true >
+    {
+        static void store( entry& e, const Handler& handler )
+        {
+            new ( e.storage.address() ) Handler( handler );
+        }
+
+        static Handler& get( entry& e )
+        {
+            return *static_cast< Handler* >( e.storage.address() );
+        }
+
+        static void destroy( entry& e )
+        {
+            get( e ).~Handler();
+        }
+    };
+
+    template < class Handler >
+    struct timer_wheel::stored_handler< Handler, false >
+    {
+        static void store( entry& e, const Handler& handler )
+        {
+            *static_cast< Handler** >( e.storage.address() ) = new Handler( handler );
+        }
+
+        static Handler& get( entry& e )
+        {
+            return **static_cast< Handler** >( e.storage.address() );
+        }
+
+        static void destroy( entry& e )
+        {
+            delete &get( e );
+        }
+    };
+
+    template < class Handler >
+    struct timer_wheel::handler_ops : stored_handler< Handler,
+        sizeof( Handler ) <= handler_storage_size
+     && boost::alignment_of< Handler >::value <= boost::alignment_of< boost::aligned_storage< handler_storage_size >::type >::value >
+    {
+        static void expire( entry& e, boost::asio::io_service& queue )
+        {
+            // the entry can be scheduled again, before the posted handler is called
+            const Handler handler( handler_ops::get( e ) );
+            handler_ops::destroy( e );
+
+            queue.post( boost::bind< void >( handler, boost::system::error_code() ) );
+        }
+
+        static void discard( entry& e )
+        {
+            // the handler might keep the owner of the entry alive, so the last copy has to be destroyed on the stack
+            const Handler handler( handler_ops::get( e ) );
+            handler_ops::destroy( e );
+        }
+    };
+
+    template < class Handler >
+    void timer_wheel::schedule( entry& e, const boost::posix_time::time_duration& delay, const Handler& handler )
+    {
+        assert( !e.next && !e.previous && !e.discard );
+
+        handler_ops< Handler >::store( e, handler );
+        e.expire  = &handler_ops< Handler >::expire;
+        e.discard = &handler_ops< Handler >::discard;
+
+        // the io_service is shutting down
+        if ( !link( e, delay ) )
+            discard( e );
+    }
+
+    template < typename WaitHandler >
+    void wheel_timer::async_wait( WaitHandler handler )
+    {
+        wheel_->schedule( entry_, expiry_time_, handler );
+    }
+}
+
+#endif /* SIOUX_SERVER_TIMER_WHEEL_H_ */
@@ -0,0 +1,69 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+/*
+ * Allocation tests for the timer wheel. They are built into a test of their own, as the program replaces the
+ * global operator new with the counting one from tools/benchmark/allocation_counter.cpp.
+ */
+
+#define BOOST_TEST_MAIN
+
+#include "server/timer_wheel.h"
+#include "tools/benchmark/allocation_counter.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/static_assert.hpp>
+
+namespace
+{
+    // about the size of a handler, that owns its connection and is wrapped by async_read_some_with_to()
+    struct connection_handler
+    {
+        explicit connection_handler( const boost::shared_ptr< int >& c )
+            : calls( c )
+        {
+            for ( void** p = padding; p != padding + sizeof padding / sizeof padding[ 0 ]; ++p )
+                *p = 0;
+        }
+
+        void operator()( const boost::system::error_code& )
+        {
+            ++*calls;
+        }
+
+        boost::shared_ptr< int >    calls;
+        void*                       padding[ 8 ];
+    };
+}
+
+/**
+ * @test arming and canceling a timer does not allocate memory, if the handler fits into the entry
+ */
+BOOST_AUTO_TEST_CASE( arming_wheel_timer_does_not_allocate )
+{
+    BOOST_STATIC_ASSERT( sizeof( connection_handler ) <= server::timer_wheel::handler_storage_size );
+
+    boost::asio::io_service         queue;
+    server::wheel_timer             timer( queue );
+    const boost::shared_ptr< int >  calls( new int( 0 ) );
+
+    // the first arm starts the ticker of the wheel
+    timer.expires_from_now( boost::posix_time::seconds( 20 ) );
+    timer.async_wait( connection_handler( calls ) );
+
+    const unsigned long allocations_before = tools::benchmark::allocations();
+
+    for ( int i = 0; i != 1000; ++i )
+    {
+        timer.expires_from_now( boost::posix_time::seconds( 20 + i % 10 ) );
+        timer.async_wait( connection_handler( calls ) );
+    }
+
+    timer.cancel();
+
+    BOOST_CHECK_EQUAL( tools::benchmark::allocations() - allocations_before, 0u );
+    BOOST_CHECK_EQUAL( *calls, 0 );
+    BOOST_CHECK_EQUAL( calls.use_count(), 1 );
+}
@@ -0,0 +1,227 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/timer_wheel.h"
+#include "tools/io_service.h"
+#include "tools/iterators.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    struct expiration
+    {
+        expiration() : calls( 0 ), error(), time() {}
+
+        void operator()( const boost::system::error_code& ec )
+        {
+            ++calls;
+            error = ec;
+            time  = boost::posix_time::microsec_clock::universal_time();
+        }
+
+        int                         calls;
+        boost::system::error_code   error;
+        boost::posix_time::ptime    time;
+    };
+
+    boost::posix_time::ptime now()
+    {
+        return boost::posix_time::microsec_clock::universal_time();
+    }
+
+    // about the size of a handler, that owns its connection and is wrapped by async_read_some_with_to()
+    struct connection_handler
+    {
+        explicit connection_handler( const boost::shared_ptr< expiration >& r )
+            : result( r )
+        {
+            std::fill( tools::begin( padding ), tools::end( padding ), static_cast< void* >( 0 ) );
+        }
+
+        void operator()( const boost::system::error_code& ec )
+        {
+            ( *result )( ec );
+        }
+
+        boost::shared_ptr< expiration > result;
+        void*                           padding[ 8 ];
+    };
+
+    // too large to be stored within a timer entry
+    struct large_handler : connection_handler
+    {
+        explicit large_handler( const boost::shared_ptr< expiration >& r ) : connection_handler( r ) {}
+
+        char more[ server::timer_wheel::handler_storage_size ];
+    };
+}
+
+/**
+ * @test a timer expires after the given delay, but not later than one resolution step after the delay
+ */
+BOOST_AUTO_TEST_CASE( wheel_timer_expires )
+{
+    boost::asio::io_service queue;
+    server::wheel_timer     timer( queue );
+    expiration              result;
+
+    const boost::posix_time::ptime start = now();
+    timer.expires_from_now( boost::posix_time::millisec( 300 ) );
+    timer.async_wait( boost::ref( result ) );
+
+    tools::run( queue );
+
+    BOOST_CHECK_EQUAL( result.calls, 1 );
+    BOOST_CHECK( !result.error );
+    BOOST_CHECK_GE( result.time - start, boost::posix_time::millisec( 300 ) );
+    BOOST_CHECK_LE( result.time - start,
+        boost::posix_time::millisec( 300 ) + server::timer_wheel::resolution() * 2 );
+}
+
+BOOST_AUTO_TEST_CASE( canceled_wheel_timer )
+{
+    boost::asio::io_service queue;
+    server::wheel_timer     timer( queue );
+    expiration              result;
+
+    timer.expires_from_now( boost::posix_time::seconds( 20 ) );
+    timer.async_wait( boost::ref( result ) );
+
+    BOOST_CHECK_EQUAL( server::timer_wheel::get( queue )->size(), 1u );
+    BOOST_CHECK_EQUAL( timer.cancel(), 1u );
+    BOOST_CHECK_EQUAL( timer.cancel(), 0u );
+    BOOST_CHECK_EQUAL( server::timer_wheel::get( queue )->size(), 0u );
+
+    tools::run( queue );
+
+    // the handler of a canceled wait is not called
+    BOOST_CHECK_EQUAL( result.calls, 0 );
+}
+
+/**
+ * @test the handler of a canceled wait is destroyed by cancel()
+ */
+BOOST_AUTO_TEST_CASE( canceled_wheel_timer_releases_handler )
+{
+    boost::asio::io_service             queue;
+    server::wheel_timer                 timer( queue );
+    const boost::shared_ptr< expiration > result( new expiration );
+
+    timer.expires_from_now( boost::posix_time::seconds( 20 ) );
+    timer.async_wait( connection_handler( result ) );
+    BOOST_CHECK_EQUAL( result.use_count(), 2 );
+
+    timer.cancel();
+    BOOST_CHECK_EQUAL( result.use_count(), 1 );
+}
+
+/**
+ * @test handlers, that do not fit into an entry, are stored on the heap
+ */
+BOOST_AUTO_TEST_CASE( large_handlers_expire )
+{
+    boost::asio::io_service             queue;
+    server::wheel_timer                 first( queue ), second( queue );
+    const boost::shared_ptr< expiration > result( new expiration );
+
+    first.expires_from_now( boost::posix_time::millisec( 100 ) );
+    first.async_wait( large_handler( result ) );
+    second.expires_from_now( boost::posix_time::seconds( 20 ) );
+    second.async_wait( large_handler( result ) );
+    second.cancel();
+
+    tools::run( queue );
+
+    BOOST_CHECK_EQUAL( result->calls, 1 );
+    BOOST_CHECK( !result->error );
+    BOOST_CHECK_EQUAL( result.use_count(), 1 );
+}
+
+/**
+ * @test setting a new expiration time cancels an outstanding wait
+ */
+BOOST_AUTO_TEST_CASE( rearming_wheel_timer )
+{
+    boost::asio::io_service queue;
+    server::wheel_timer     timer( queue );
+    expiration              first, second;
+
+    timer.expires_from_now( boost::posix_time::seconds( 60 ) );
+    timer.async_wait( boost::ref( first ) );
+
+    BOOST_CHECK_EQUAL( timer.expires_from_now( boost::posix_time::millisec( 100 ) ), 1u );
+    timer.async_wait( boost::ref( second ) );
+
+    tools::run( queue );
+
+    BOOST_CHECK_EQUAL( first.calls, 0 );
+    BOOST_CHECK_EQUAL( second.calls, 1 );
+    BOOST_CHECK( !second.error );
+}
+
+/**
+ * @test many timers with different delays expire in order
+ */
+BOOST_AUTO_TEST_CASE( many_wheel_timers )
+{
+    boost::asio::io_service                                 queue;
+    std::vector< boost::shared_ptr< server::wheel_timer > > timers;
+    std::vector< expiration >                               results( 100 );
+
+    for ( std::size_t i = 0; i != results.size(); ++i )
+    {
+        timers.push_back( boost::shared_ptr< server::wheel_timer >( new server::wheel_timer( queue ) ) );
+        timers.back()->expires_from_now( boost::posix_time::millisec( ( i % 5 ) * 100 ) );
+        timers.back()->async_wait( boost::ref( results[ i ] ) );
+    }
+
+    // cancel every second timer
+    for ( std::size_t i = 1; i < timers.size(); i += 2 )
+        timers[ i ]->cancel();
+
+    tools::run( queue );
+
+    for ( std::size_t i = 0; i != results.size(); ++i )
+    {
+        BOOST_CHECK_EQUAL( results[ i ].calls, i % 2 == 0 ? 1 : 0 );
+        BOOST_CHECK( !results[ i ].error );
+
+        // compare with the previous, not canceled timer with a shorter delay
+        if ( i % 2 == 0 && i >= 2 && ( i - 2 ) % 5 < i % 5 )
+            BOOST_CHECK( results[ i - 2 ].time <= results[ i ].time );
+    }
+}
+
+/**
+ * @test delays, longer than a rotation of the wheel, do not expire within the first steps of the wheel
+ */
+BOOST_AUTO_TEST_CASE( long_delays_do_not_expire_early )
+{
+    boost::asio::io_service queue;
+    server::wheel_timer     long_timer( queue ), short_timer( queue );
+    expiration              long_result, short_result;
+
+    long_timer.expires_from_now( boost::posix_time::hours( 1 ) );
+    long_timer.async_wait( boost::ref( long_result ) );
+
+    short_timer.expires_from_now( boost::posix_time::millisec( 200 ) );
+    short_timer.async_wait( boost::ref( short_result ) );
+
+    while ( short_result.calls == 0 )
+        queue.run_one();
+
+    BOOST_CHECK_EQUAL( long_result.calls, 0 );
+    BOOST_CHECK_EQUAL( server::timer_wheel::get( queue )->size(), 1u );
+
+    BOOST_CHECK_EQUAL( long_timer.cancel(), 1u );
+    tools::run( queue );
+
+    BOOST_CHECK_EQUAL( long_result.calls, 0 );
+}
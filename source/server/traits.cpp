@@ -21,5 +21,10 @@ namespace server
         return boost::posix_time::seconds( 1 );
     }
 
+    std::size_t connection_config::max_body_size() const
+    {
+        return 10 * 1024 * 1024;
+    }
+
 } // namespace server 
 
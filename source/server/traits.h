@@ -143,6 +143,13 @@ namespace server
          *        is not made before this timeout have been reached.
          */
         boost::posix_time::time_duration reaccept_timeout() const;
+
+        /**
+         * @brief returns the maximum size of a request body of 10MB
+         *
+         * Larger bodies are not read from the connection.
+         */
+        std::size_t max_body_size() const;
     };
 
     /**
@@ -0,0 +1,137 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "server/sharded_server.h"
+#include "server/error.h"
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <istream>
+#include <string>
+#include <vector>
+
+/*
+ * Measures the number of requests per second, a sharded_http_server answers with 1, 2, 4, ... shards.
+ *
+ * usage: sharded_benchmark [max_shards [clients [seconds]]]
+ *
+ * The clients run on the same machine and compete with the server for the CPU cores, so the numbers are only
+ * useful to compare the different shard counts with each other.
+ */
+namespace
+{
+    typedef server::sharded_http_server     server_t;
+    typedef server_t::connection_t          connection_t;
+
+    boost::shared_ptr< server::async_response > on_request(
+                const boost::shared_ptr< connection_t >&                connection,
+                const boost::shared_ptr< const http::request_header >&     )
+    {
+        return boost::shared_ptr< server::async_response >(
+                new server::error_response< connection_t >( connection, http::http_ok ) );
+    }
+
+    const char request_text[] =
+        "GET /bench HTTP/1.1\r\n"
+        "Host: 127.0.0.1\r\n"
+        "\r\n";
+
+    // sends requests over a persistent connection, until the deadline is reached
+    void client( const boost::asio::ip::tcp::endpoint& server, const boost::posix_time::ptime& deadline,
+        unsigned long& responses )
+    {
+        try
+        {
+            boost::asio::io_service         queue;
+            boost::asio::ip::tcp::socket    socket( queue );
+            boost::asio::streambuf          input;
+
+            socket.connect( server );
+
+            while ( boost::posix_time::microsec_clock::universal_time() < deadline )
+            {
+                boost::asio::write( socket, boost::asio::buffer( request_text, sizeof request_text - 1 ) );
+
+                const std::size_t header_size = boost::asio::read_until( socket, input, "\r\n\r\n" );
+                const std::string header( boost::asio::buffers_begin( input.data() ),
+                    boost::asio::buffers_begin( input.data() ) + header_size );
+                input.consume( header_size );
+
+                const std::string::size_type length_pos = header.find( "Content-Length: " );
+                const std::size_t body_size = length_pos == std::string::npos
+                    ? 0
+                    : std::strtoul( header.c_str() + length_pos + 16, 0, 10 );
+
+                if ( input.size() < body_size )
+                    boost::asio::read( socket, input, boost::asio::transfer_exactly( body_size - input.size() ) );
+
+                input.consume( body_size );
+                ++responses;
+            }
+        }
+        catch ( const std::exception& e )
+        {
+            std::cerr << "client error: " << e.what() << std::endl;
+        }
+    }
+
+    double requests_per_second( unsigned shards, unsigned clients, unsigned seconds, unsigned short port )
+    {
+        server_t server( shards, true );
+        server.add_action( "/bench", on_request );
+
+        using namespace boost::asio::ip;
+        const tcp::endpoint endpoint( address_v4::loopback(), port );
+        server.add_listener( endpoint );
+
+        const boost::posix_time::ptime  deadline =
+            boost::posix_time::microsec_clock::universal_time() + boost::posix_time::seconds( seconds );
+        std::vector< unsigned long >    responses( clients, 0 );
+        boost::thread_group             client_threads;
+
+        for ( unsigned c = 0; c != clients; ++c )
+            client_threads.create_thread( boost::bind( &client, endpoint, deadline, boost::ref( responses[ c ] ) ) );
+
+        client_threads.join_all();
+
+        unsigned long total = 0;
+        for ( std::vector< unsigned long >::const_iterator r = responses.begin(); r != responses.end(); ++r )
+            total += *r;
+
+        return static_cast< double >( total ) / seconds;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    const unsigned cores      = std::max( boost::thread::hardware_concurrency(), 1u );
+    const unsigned max_shards = argc > 1 ? std::atoi( argv[ 1 ] ) : cores;
+    const unsigned clients    = argc > 2 ? std::atoi( argv[ 2 ] ) : 4 * cores;
+    const unsigned seconds    = argc > 3 ? std::atoi( argv[ 3 ] ) : 5;
+
+    std::cout << "cores: " << cores << " clients: " << clients << " duration: " << seconds << "s" << std::endl;
+
+    unsigned short port = 8090;
+    double         single_shard = 0;
+
+    for ( unsigned shards = 1; shards <= max_shards; shards *= 2, ++port )
+    {
+        const double rate = requests_per_second( shards, clients, seconds, port );
+
+        if ( shards == 1 )
+            single_shard = rate;
+
+        std::cout << "shards: " << shards << "\trequests/s: " << static_cast< unsigned long >( rate )
+                  << "\tspeedup: " << ( single_shard > 0 ? rate / single_shard : 0 ) << std::endl;
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "tools/benchmark/allocation_counter.h"
+#include <boost/atomic.hpp>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    boost::atomic< unsigned long >  allocation_count( 0 );
+    boost::atomic< std::size_t >    allocated_bytes( 0 );
+
+    // every allocation is prefixed with its size, keeping the returned memory aligned
+    const std::size_t allocation_header = 16;
+}
+
+void* operator new( std::size_t size )
+{
+    allocation_count.fetch_add( 1, boost::memory_order_relaxed );
+    allocated_bytes.fetch_add( size, boost::memory_order_relaxed );
+
+    if ( char* const result = static_cast< char* >( std::malloc( size + allocation_header ) ) )
+    {
+        *reinterpret_cast< std::size_t* >( result ) = size;
+        return result + allocation_header;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* p ) throw()
+{
+    if ( p )
+    {
+        char* const block = static_cast< char* >( p ) - allocation_header;
+        allocated_bytes.fetch_sub( *reinterpret_cast< std::size_t* >( block ), boost::memory_order_relaxed );
+        std::free( block );
+    }
+}
+
+void operator delete[]( void* p ) throw()
+{
+    operator delete( p );
+}
+
+namespace tools
+{
+    namespace benchmark
+    {
+        unsigned long allocations()
+        {
+            return allocation_count.load( boost::memory_order_relaxed );
+        }
+
+        std::size_t bytes_in_use()
+        {
+            return allocated_bytes.load( boost::memory_order_relaxed );
+        }
+    }
+}
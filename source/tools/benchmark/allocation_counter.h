@@ -0,0 +1,33 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_TOOLS_BENCHMARK_ALLOCATION_COUNTER_H
+#define SIOUX_SOURCE_TOOLS_BENCHMARK_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+/*
+ * Counting replacement of the global operator new and operator delete for micro benchmarks and tests, that
+ * check the number of allocations.
+ *
+ * The replacement is defined in tools/benchmark/allocation_counter.cpp, which is not part of the tools library.
+ * A program opts in by adding that file to its sources; it replaces the allocator of the whole program.
+ */
+namespace tools
+{
+    namespace benchmark
+    {
+        /**
+         * @brief number of calls to the global operator new since program start
+         */
+        unsigned long allocations();
+
+        /**
+         * @brief number of bytes allocated by the global operator new and not released yet
+         */
+        std::size_t bytes_in_use();
+    }
+}
+
+#endif // include guard
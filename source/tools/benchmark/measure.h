@@ -0,0 +1,86 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_TOOLS_BENCHMARK_MEASURE_H
+#define SIOUX_SOURCE_TOOLS_BENCHMARK_MEASURE_H
+
+#include "tools/benchmark/allocation_counter.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace tools
+{
+    namespace benchmark
+    {
+        /**
+         * @brief the result of measure()
+         */
+        struct measurement
+        {
+            double          seconds;
+            // number of calls to the measured step
+            std::size_t     calls;
+            // number of bytes of the corpus, that were processed
+            double          bytes;
+            unsigned long   allocations;
+        };
+
+        /**
+         * @brief calls step( index ) for every element of the corpus, iterations times and measures the elapsed time
+         *        and the number of allocations
+         *
+         * Every step returns a value depending on its result, to keep the optimizer honest. Requires the
+         * allocation counter from tools/benchmark/allocation_counter.cpp.
+         * @exception std::runtime_error if all steps returned 0
+         */
+        template < class Step >
+        measurement measure( const char* name, const std::vector< std::string >& corpus, unsigned iterations,
+            const Step& step )
+        {
+            std::size_t bytes = 0;
+
+            for ( std::vector< std::string >::const_iterator text = corpus.begin(); text != corpus.end(); ++text )
+                bytes += text->size();
+
+            std::size_t                     check              = 0;
+            const unsigned long             allocations_before = allocations();
+            const boost::posix_time::ptime  start              = boost::posix_time::microsec_clock::universal_time();
+
+            for ( unsigned i = 0; i != iterations; ++i )
+            {
+                for ( std::size_t index = 0; index != corpus.size(); ++index )
+                    check += step( index );
+            }
+
+            const measurement result = {
+                ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() / 1e6,
+                corpus.size() * static_cast< std::size_t >( iterations ),
+                bytes * static_cast< double >( iterations ),
+                allocations() - allocations_before };
+
+            if ( check == 0 )
+                throw std::runtime_error( std::string( name ) + ": no results" );
+
+            return result;
+        }
+
+        /**
+         * @brief prints the time per call, the throughput and the allocations per call of a measurement, followed
+         *        by a new line. unit names, what a single call processes.
+         */
+        inline void print( std::ostream& out, const measurement& m, const char* unit )
+        {
+            out << std::setw( 10 ) << m.seconds * 1e9 / m.calls << " ns/" << unit
+                << std::setw( 10 ) << m.bytes / m.seconds / ( 1024 * 1024 ) << " MB/s"
+                << std::setw( 8 ) << static_cast< double >( m.allocations ) / m.calls << " allocations/" << unit
+                << "\n";
+        }
+    }
+}
+
+#endif // include guard
@@ -0,0 +1,221 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "tools/buffer_pool.h"
+#include <boost/atomic.hpp>
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace tools
+{
+    namespace {
+        // the counters of a thread cache are only modified by the owning thread, so there is no need for an
+        // atomic read-modify-write; they are atomic, because the statistic functions read them from other threads
+        template < class T >
+        void increment( boost::atomic< T >& counter )
+        {
+            counter.store( counter.load( boost::memory_order_relaxed ) + 1, boost::memory_order_relaxed );
+        }
+
+        template < class T >
+        void decrement( boost::atomic< T >& counter )
+        {
+            counter.store( counter.load( boost::memory_order_relaxed ) - 1, boost::memory_order_relaxed );
+        }
+    }
+
+    ////////////////////////////////////
+    // class buffer_pool::thread_cache
+    class buffer_pool::thread_cache : boost::noncopyable
+    {
+    public:
+        explicit thread_cache( buffer_pool& owner )
+            : pool( &owner )
+            , free( 0 )
+            , free_blocks( 0 )
+            , blocks_in_use( 0 )
+            , next( 0 )
+        {
+        }
+
+        ~thread_cache()
+        {
+            release_free_blocks();
+        }
+
+        void release_free_blocks()
+        {
+            while ( free )
+            {
+                free_block* const block = free;
+                free = block->next;
+
+                ::operator delete( block );
+            }
+
+            free_blocks.store( 0, boost::memory_order_relaxed );
+        }
+
+        // null, if the pool was destroyed before the thread ended
+        buffer_pool*                    pool;
+        free_block*                     free;
+        boost::atomic< std::size_t >    free_blocks;
+        // negative, if this thread released more blocks, than it allocated
+        boost::atomic< long >           blocks_in_use;
+        thread_cache*                   next;
+    };
+
+    /////////////////////
+    // class buffer_pool
+    buffer_pool::buffer_pool( std::size_t block_size, std::size_t max_free_blocks )
+        : block_size_( std::max( block_size, sizeof( free_block ) ) )
+        , max_free_blocks_( max_free_blocks )
+        , caches_( &buffer_pool::thread_ended )
+        , mutex_()
+        , first_cache_( 0 )
+        , ended_blocks_in_use_( 0 )
+    {
+    }
+
+    buffer_pool::~buffer_pool()
+    {
+        assert( blocks_in_use() == 0 );
+
+        // the cache of this thread is deleted right now, the caches of other threads, when these threads end
+        caches_.reset();
+
+        boost::mutex::scoped_lock lock( mutex_ );
+
+        for ( thread_cache* cache = first_cache_; cache; cache = cache->next )
+        {
+            cache->pool = 0;
+            cache->release_free_blocks();
+        }
+    }
+
+    char* buffer_pool::allocate()
+    {
+        thread_cache& local = cache();
+        increment( local.blocks_in_use );
+
+        if ( free_block* const block = local.free )
+        {
+            local.free = block->next;
+            decrement( local.free_blocks );
+
+            return static_cast< char* >( static_cast< void* >( block ) );
+        }
+
+        try
+        {
+            return static_cast< char* >( ::operator new( block_size_ ) );
+        }
+        catch ( ... )
+        {
+            decrement( local.blocks_in_use );
+
+            throw;
+        }
+    }
+
+    void buffer_pool::release( char* block )
+    {
+        assert( block );
+
+        thread_cache& local = cache();
+        decrement( local.blocks_in_use );
+
+        if ( local.free_blocks.load( boost::memory_order_relaxed ) < max_free_blocks_ )
+        {
+            free_block* const free = static_cast< free_block* >( static_cast< void* >( block ) );
+            free->next = local.free;
+            local.free = free;
+            increment( local.free_blocks );
+
+            return;
+        }
+
+        ::operator delete( block );
+    }
+
+    std::size_t buffer_pool::block_size() const
+    {
+        return block_size_;
+    }
+
+    std::size_t buffer_pool::blocks_in_use() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        long result = ended_blocks_in_use_;
+
+        for ( const thread_cache* cache = first_cache_; cache; cache = cache->next )
+            result += cache->blocks_in_use.load( boost::memory_order_relaxed );
+
+        assert( result >= 0 );
+        return static_cast< std::size_t >( result );
+    }
+
+    std::size_t buffer_pool::free_blocks() const
+    {
+        boost::mutex::scoped_lock lock( mutex_ );
+        std::size_t result = 0;
+
+        for ( const thread_cache* cache = first_cache_; cache; cache = cache->next )
+            result += cache->free_blocks.load( boost::memory_order_relaxed );
+
+        return result;
+    }
+
+    buffer_pool::thread_cache& buffer_pool::cache()
+    {
+        thread_cache* result = caches_.get();
+
+        // a cache, that is left over from a destroyed pool at the same address, is replaced
+        if ( result && result->pool == this )
+            return *result;
+
+        result = new thread_cache( *this );
+
+        {
+            boost::mutex::scoped_lock lock( mutex_ );
+            result->next = first_cache_;
+            first_cache_ = result;
+        }
+
+        caches_.reset( result );
+
+        return *result;
+    }
+
+    void buffer_pool::thread_ended( thread_cache* cache )
+    {
+        if ( buffer_pool* const pool = cache->pool )
+        {
+            boost::mutex::scoped_lock lock( pool->mutex_ );
+
+            thread_cache** link = &pool->first_cache_;
+            for ( ; *link != cache; link = &( *link )->next )
+                ;
+
+            *link = cache->next;
+            pool->ended_blocks_in_use_ += cache->blocks_in_use.load( boost::memory_order_relaxed );
+        }
+
+        delete cache;
+    }
+
+    ///////////////////////
+    // class pooled_buffer
+    pooled_buffer::pooled_buffer( buffer_pool& pool )
+        : pool_( pool )
+        , block_( pool.allocate() )
+    {
+    }
+
+    pooled_buffer::~pooled_buffer()
+    {
+        pool_.release( block_ );
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_TOOLS_BUFFER_POOL_H
+#define SIOUX_TOOLS_BUFFER_POOL_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <cstddef>
+
+namespace tools
+{
+    /**
+     * @brief thread safe pool of equally sized memory blocks
+     *
+     * Released blocks are kept in a free list and are handed out again by the next allocate(). To return memory
+     * to the system, the number of blocks in the free list is limited.
+     *
+     * Every thread has its own free list, so that allocate() and release() do not take a lock and threads, that
+     * serve different io_services, do not contend on the pool. A block can be released by an other thread than the
+     * one that allocated it; it is then kept in the free list of the releasing thread. The free list of a thread is
+     * returned to the system, when the thread ends.
+     */
+    class buffer_pool : boost::noncopyable
+    {
+    public:
+        /**
+         * @param block_size the size of the blocks handed out by allocate()
+         * @param max_free_blocks the maximum number of released blocks that are kept for reuse by every thread
+         */
+        buffer_pool( std::size_t block_size, std::size_t max_free_blocks );
+
+        /**
+         * @pre all allocated blocks are released and no other thread uses the pool
+         */
+        ~buffer_pool();
+
+        /**
+         * @brief returns a block of block_size() bytes
+         * @exception std::bad_alloc if no block is free and no new block can be allocated
+         */
+        char* allocate();
+
+        /**
+         * @brief returns a block, that was obtained from allocate() back to the pool
+         */
+        void release( char* block );
+
+        std::size_t block_size() const;
+
+        /**
+         * @brief the number of blocks, that are currently allocated and not released, by all threads
+         */
+        std::size_t blocks_in_use() const;
+
+        /**
+         * @brief the number of released blocks, that are kept for reuse, by all threads
+         */
+        std::size_t free_blocks() const;
+
+    private:
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        class thread_cache;
+
+        thread_cache& cache();
+        static void thread_ended( thread_cache* );
+
+        const std::size_t                           block_size_;
+        const std::size_t                           max_free_blocks_;
+        boost::thread_specific_ptr< thread_cache >  caches_;
+
+        // guards the list of all thread caches; only taken, when a thread uses the pool for the first time, when a
+        // thread ends and by the statistic functions
+        mutable boost::mutex                        mutex_;
+        thread_cache*                               first_cache_;
+        // blocks_in_use, accounted by threads that already ended
+        long                                        ended_blocks_in_use_;
+    };
+
+    /**
+     * @brief a block from a buffer_pool, that is released when the pooled_buffer is destroyed
+     */
+    class pooled_buffer : boost::noncopyable
+    {
+    public:
+        explicit pooled_buffer( buffer_pool& pool );
+
+        ~pooled_buffer();
+
+        char& operator[]( std::size_t index );
+        const char& operator[]( std::size_t index ) const;
+
+    private:
+        buffer_pool&    pool_;
+        char* const     block_;
+    };
+
+    // implementation
+    inline char& pooled_buffer::operator[]( std::size_t index )
+    {
+        return block_[ index ];
+    }
+
+    inline const char& pooled_buffer::operator[]( std::size_t index ) const
+    {
+        return block_[ index ];
+    }
+}
+
+#endif // include guard
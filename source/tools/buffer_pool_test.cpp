@@ -0,0 +1,119 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "tools/buffer_pool.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    void allocate_blocks( tools::buffer_pool& pool, std::vector< char* >& blocks, std::size_t count )
+    {
+        for ( ; count != 0; --count )
+            blocks.push_back( pool.allocate() );
+    }
+
+    void release_blocks( tools::buffer_pool& pool, std::vector< char* >& blocks )
+    {
+        for ( ; !blocks.empty(); blocks.pop_back() )
+            pool.release( blocks.back() );
+    }
+
+    void allocate_and_release_blocks( tools::buffer_pool& pool, std::size_t count )
+    {
+        std::vector< char* > blocks;
+        allocate_blocks( pool, blocks, count );
+        release_blocks( pool, blocks );
+    }
+}
+
+/**
+ * @test released blocks are handed out again
+ */
+BOOST_AUTO_TEST_CASE( released_blocks_are_reused )
+{
+    tools::buffer_pool pool( 1024, 10 );
+
+    char* const first = pool.allocate();
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 1u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 0u );
+
+    pool.release( first );
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 0u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 1u );
+
+    char* const second = pool.allocate();
+    BOOST_CHECK( first == second );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 0u );
+
+    pool.release( second );
+}
+
+/**
+ * @test not more than the configured number of free blocks are kept
+ */
+BOOST_AUTO_TEST_CASE( number_of_free_blocks_is_limited )
+{
+    tools::buffer_pool pool( 16, 2 );
+
+    char* const blocks[] = { pool.allocate(), pool.allocate(), pool.allocate() };
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 3u );
+
+    for ( char* const* b = blocks; b != blocks + 3; ++b )
+        pool.release( *b );
+
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 0u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 2u );
+}
+
+/**
+ * @test a pooled_buffer releases its block, when destroyed
+ */
+BOOST_AUTO_TEST_CASE( pooled_buffer_releases_its_block )
+{
+    tools::buffer_pool pool( 16, 2 );
+
+    {
+        tools::pooled_buffer buffer( pool );
+        buffer[ 0 ]  = 'a';
+        buffer[ 15 ] = 'b';
+
+        BOOST_CHECK_EQUAL( pool.blocks_in_use(), 1u );
+        BOOST_CHECK_EQUAL( buffer[ 0 ], 'a' );
+    }
+
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 0u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 1u );
+}
+
+/**
+ * @test every thread has its own free list and a block can be released by an other thread, than the one that
+ *       allocated it
+ */
+BOOST_AUTO_TEST_CASE( free_lists_are_per_thread )
+{
+    tools::buffer_pool      pool( 64, 10 );
+    std::vector< char* >    blocks;
+
+    boost::thread( boost::bind( &allocate_blocks, boost::ref( pool ), boost::ref( blocks ), 3u ) ).join();
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 3u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 0u );
+
+    // the blocks are kept in the free list of the releasing thread
+    const std::vector< char* > released = blocks;
+    release_blocks( pool, blocks );
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 0u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 3u );
+
+    char* const block = pool.allocate();
+    BOOST_CHECK( std::find( released.begin(), released.end(), block ) != released.end() );
+    pool.release( block );
+
+    // a thread, that ends, returns its free list to the system
+    boost::thread( boost::bind( &allocate_and_release_blocks, boost::ref( pool ), 2u ) ).join();
+    BOOST_CHECK_EQUAL( pool.blocks_in_use(), 0u );
+    BOOST_CHECK_EQUAL( pool.free_blocks(), 3u );
+}
@@ -0,0 +1,59 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include "tools/simd.h"
+#include <cassert>
+
+namespace tools
+{
+    simd_isa available_simd_isa()
+    {
+#   ifdef SIOUX_AVX2
+        // the function might be called during the initialization of static objects
+        __builtin_cpu_init();
+
+        if ( __builtin_cpu_supports( "avx2" ) )
+            return avx2_isa;
+#   endif
+
+#   ifdef SIOUX_SSE2
+        return sse2_isa;
+#   else
+        return scalar_isa;
+#   endif
+    }
+
+    const char* simd_isa_name( simd_isa isa )
+    {
+        static const char* const names[] = { "scalar", "sse2", "avx2" };
+
+        return names[ isa ];
+    }
+
+    ////////////////////////////
+    // class scanner_dispatch
+    scanner_dispatch::scanner_dispatch( scanner_t scalar, scanner_t sse2, scanner_t avx2 )
+        : selected_( 0 )
+    {
+        assert( scalar );
+
+        implementations_[ scalar_isa ] = scalar;
+        implementations_[ sse2_isa ]   = sse2 ? sse2 : scalar;
+        implementations_[ avx2_isa ]   = avx2 ? avx2 : implementations_[ sse2_isa ];
+
+        selected_ = get( available_simd_isa() );
+    }
+
+    scanner_t scanner_dispatch::get( simd_isa isa ) const
+    {
+        assert( isa <= available_simd_isa() );
+
+        return implementations_[ isa ];
+    }
+
+    void scanner_dispatch::select( simd_isa isa )
+    {
+        selected_ = get( isa );
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#ifndef SIOUX_SOURCE_TOOLS_SIMD_H
+#define SIOUX_SOURCE_TOOLS_SIMD_H
+
+/*
+ * SIOUX_SSE2 is defined, if the compiler generates SSE2 code. SIOUX_AVX2 is defined, if functions can be compiled
+ * for AVX2 with SIOUX_AVX2_FUNCTION, without making the rest of the program depend on AVX2. Such functions must
+ * only be called, if available_simd_isa() returns avx2_isa.
+ */
+#if defined( __SSE2__ )
+#   define SIOUX_SSE2
+#   define SIOUX_IF_SSE2( x ) x
+#   include <emmintrin.h>
+#else
+#   define SIOUX_IF_SSE2( x ) 0
+#endif
+
+#if defined( SIOUX_SSE2 ) && ( defined( __clang__ ) || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#   define SIOUX_AVX2
+#   define SIOUX_AVX2_FUNCTION __attribute__(( target( "avx2" ) ))
+#   define SIOUX_IF_AVX2( x ) x
+#   include <immintrin.h>
+#else
+#   define SIOUX_IF_AVX2( x ) 0
+#endif
+
+namespace tools
+{
+    /**
+     * @brief the instruction sets, scanners are implemented with
+     */
+    enum simd_isa
+    {
+        /** byte by byte */
+        scalar_isa,
+        /** 16 bytes at a time */
+        sse2_isa,
+        /** 32 bytes at a time */
+        avx2_isa
+    };
+
+    /**
+     * @brief the most capable instruction set, that is supported by the compiler and the CPU the program runs on
+     */
+    simd_isa available_simd_isa();
+
+    /**
+     * @brief "scalar", "sse2" or "avx2"
+     */
+    const char* simd_isa_name( simd_isa isa );
+
+    /**
+     * @brief function, that returns a pointer to the first character in [begin, end), it is looking for, or end
+     */
+    typedef const char* ( *scanner_t )( const char* begin, const char* end );
+
+    /**
+     * @brief the implementations of a scanner for every instruction set and the one in use
+     *
+     * Implementations, that are not compiled in, are passed as null, SIOUX_IF_SSE2() and SIOUX_IF_AVX2() do that.
+     * Initially, the implementation for available_simd_isa() is in use.
+     */
+    class scanner_dispatch
+    {
+    public:
+        scanner_dispatch( scanner_t scalar, scanner_t sse2, scanner_t avx2 );
+
+        /**
+         * @brief the implementation for the given instruction set
+         * @pre isa <= available_simd_isa()
+         */
+        scanner_t get( simd_isa isa ) const;
+
+        /**
+         * @brief chooses the implementation in use. Not thread safe.
+         * @pre isa <= available_simd_isa()
+         */
+        void select( simd_isa isa );
+
+        const char* operator()( const char* begin, const char* end ) const
+        {
+            return selected_( begin, end );
+        }
+
+    private:
+        scanner_t implementations_[ avx2_isa + 1 ];
+        scanner_t selected_;
+    };
+}
+
+#endif // include guard
@@ -0,0 +1,45 @@
+// Copyright (c) Torrox GmbH & Co KG. All rights reserved.
+// Please note that the content of this file is confidential or protected by law.
+// Any unauthorised copying or unauthorised distribution of the information contained herein is prohibited.
+
+#include <boost/test/unit_test.hpp>
+#include "tools/simd.h"
+#include <string>
+
+namespace
+{
+    const char* first( const char* begin, const char* ) { return begin; }
+    const char* last( const char*, const char* end ) { return end; }
+}
+
+/**
+ * @test implementations, that are not compiled in, fall back to the next less capable implementation
+ */
+BOOST_AUTO_TEST_CASE( scanner_dispatch_falls_back )
+{
+    const char text[] = "abc";
+    tools::scanner_dispatch dispatch( &first, 0, 0 );
+
+    for ( int isa = tools::scalar_isa; isa <= tools::available_simd_isa(); ++isa )
+        BOOST_CHECK( dispatch.get( static_cast< tools::simd_isa >( isa ) ) == &first );
+
+    BOOST_CHECK( dispatch( text, text + 3 ) == text );
+}
+
+/**
+ * @test the selected implementation is used by operator()
+ */
+BOOST_AUTO_TEST_CASE( scanner_dispatch_selects )
+{
+    const char text[] = "abc";
+    tools::scanner_dispatch dispatch( &first, &last, &last );
+
+    dispatch.select( tools::scalar_isa );
+    BOOST_CHECK( dispatch( text, text + 3 ) == text );
+
+    dispatch.select( tools::available_simd_isa() );
+    BOOST_CHECK( dispatch( text, text + 3 ) == ( tools::available_simd_isa() == tools::scalar_isa ? text : text + 3 ) );
+
+    BOOST_CHECK_EQUAL( std::string( tools::simd_isa_name( tools::scalar_isa ) ), "scalar" );
+    BOOST_CHECK_EQUAL( std::string( tools::simd_isa_name( tools::avx2_isa ) ), "avx2" );
+}